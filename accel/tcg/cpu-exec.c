@@ -190,7 +190,7 @@ static inline TranslationBlock *tb_lookup(CPUState *cpu, target_ulong pc,
                tb->cs_base == cs_base &&
                tb->flags == flags &&
                tb->trace_vcpu_dstate == *cpu->trace_dstate &&
-               tb_cflags(tb) == cflags)) {
+               (tb_cflags(tb) & CF_LOOKUP_MASK) == cflags)) {
         return tb;
     }
     tb = tb_htable_lookup(cpu, pc, cs_base, flags, cflags);
@@ -309,7 +309,7 @@ static bool check_for_breakpoints(CPUState *cpu, target_ulong pc,
  * If found, return the code pointer.  If not found, return
  * the tcg epilogue so that we return into cpu_tb_exec.
  */
-const void *HELPER(lookup_tb_ptr)(CPUArchState *env)
+static TranslationBlock *lookup_tb_next(CPUArchState *env)
 {
     CPUState *cpu = env_cpu(env);
     TranslationBlock *tb;
@@ -324,15 +324,105 @@ const void *HELPER(lookup_tb_ptr)(CPUArchState *env)
     }
 
     tb = tb_lookup(cpu, pc, cs_base, flags, cflags);
+    if (tb != NULL) {
+        log_cpu_exec(pc, cpu, tb);
+    }
+    return tb;
+}
+
+const void *HELPER(lookup_tb_ptr)(CPUArchState *env)
+{
+    TranslationBlock *tb = lookup_tb_next(env);
+
+    return tb ? tb->tc.ptr : tcg_code_gen_epilogue;
+}
+
+/*
+ * An inline cache hit only checks pc, so only remember TBs that were
+ * translated for the same state as the TB making the jump; the jump
+ * site guarantees that it does not change anything else.
+ */
+static bool tb_ic_compatible(const TranslationBlock *from,
+                             const TranslationBlock *to)
+{
+    return to->cs_base == from->cs_base &&
+           to->flags == from->flags &&
+           to->trace_vcpu_dstate == from->trace_vcpu_dstate &&
+           ((tb_cflags(to) ^ tb_cflags(from)) & CF_LOOKUP_MASK &
+            ~CF_INVALID) == 0;
+}
+
+static void tb_ic_fill(TBInlineCache *ic, TranslationBlock *tb,
+                       uint32_t epoch)
+{
+    /*
+     * Readers load @dest before @epoch, so hide the slot from every
+     * vCPU while @dest is replaced.
+     */
+    qatomic_set(&ic->epoch, 0);
+    smp_wmb();
+    qatomic_set(&ic->dest, tb);
+    smp_wmb();
+    qatomic_set(&ic->epoch, epoch);
+}
+
+/**
+ * helper_lookup_tb_ptr_ic: inline cache miss of an indirect jump
+ * @env: current cpu state
+ * @from: TB containing the jump
+ * @n: inline cache slot of the jump site
+ *
+ * As helper_lookup_tb_ptr, and record the TB found in @from's slot @n
+ * for the next execution of the jump by this vCPU.
+ */
+const void *HELPER(lookup_tb_ptr_ic)(CPUArchState *env, void *from,
+                                     uint32_t n)
+{
+    CPUState *cpu = env_cpu(env);
+    TranslationBlock *owner = from;
+    TBInlineCache *ic = &owner->ic[n];
+    uint32_t epoch = qatomic_read(&cpu->tb_ic_epoch);
+    TranslationBlock *tb = lookup_tb_next(env);
+
+    qatomic_set(&cpu->tb_ic_misses, cpu->tb_ic_misses + 1);
     if (tb == NULL) {
         return tcg_code_gen_epilogue;
     }
 
-    log_cpu_exec(pc, cpu, tb);
-
+    if (tb_ic_compatible(owner, tb)) {
+        tb_ic_fill(ic, tb, epoch);
+    }
     return tb->tc.ptr;
 }
 
+/**
+ * helper_lookup_tb_ptr_ras: return stack miss
+ * @env: current cpu state
+ * @slot: return inline cache of the calling TB, NULL if the return
+ *        address did not match the top of the return stack
+ *
+ * As helper_lookup_tb_ptr, and record the TB found in @slot.  The code
+ * checking the slot compares the state of the TB with that of the return,
+ * so any TB will do.
+ */
+const void *HELPER(lookup_tb_ptr_ras)(CPUArchState *env, void *slot)
+{
+    CPUState *cpu = env_cpu(env);
+    TBInlineCache *ic = slot;
+    uint32_t epoch = qatomic_read(&cpu->tb_ic_epoch);
+    TranslationBlock *tb = lookup_tb_next(env);
+
+    if (ic == NULL) {
+        qatomic_inc(&tb_ctx.ras_mispredict_count);
+    } else {
+        qatomic_set(&cpu->tb_ras_misses, cpu->tb_ras_misses + 1);
+        if (tb != NULL) {
+            tb_ic_fill(ic, tb, epoch);
+        }
+    }
+    return tb ? tb->tc.ptr : tcg_code_gen_epilogue;
+}
+
 /* Execute a TB, and fix up the CPU state afterwards if necessary */
 /*
  * Disable CFI checks.
@@ -433,6 +523,8 @@ void cpu_exec_step_atomic(CPUState *cpu)
         g_assert(cpu == current_cpu);
         g_assert(!cpu->running);
         cpu->running = true;
+        /* Keep region eviction from reclaiming the TB under our feet. */
+        rcu_read_lock();
 
         cpu_get_tb_cpu_state(env, &pc, &cs_base, &flags);
 
@@ -481,6 +573,7 @@ void cpu_exec_step_atomic(CPUState *cpu)
      * be in the region if we longjump out of either the codegen or
      * the execution.
      */
+    rcu_read_unlock();
     g_assert(cpu_in_exclusive_context(cpu));
     cpu->running = false;
     end_exclusive();
@@ -506,7 +599,7 @@ static bool tb_lookup_cmp(const void *p, const void *d)
         tb->cs_base == desc->cs_base &&
         tb->flags == desc->flags &&
         tb->trace_vcpu_dstate == desc->trace_vcpu_dstate &&
-        tb_cflags(tb) == desc->cflags) {
+        (tb_cflags(tb) & CF_LOOKUP_MASK) == desc->cflags) {
         /* check next page if needed */
         if (tb->page_addr[1] == -1) {
             return true;
@@ -641,6 +734,130 @@ static inline void cpu_handle_debug_exception(CPUState *cpu)
     }
 }
 
+#ifndef CONFIG_USER_ONLY
+/*
+ * Optimizing a hot CF_QUICK TB means translating it a second time, which
+ * would stall the vCPU right while the guest is busy.  Instead the TB is
+ * queued, and keeps running, until the vCPU halts; it is then translated
+ * in time the vCPU would have spent idle, and the optimized TB replaces
+ * it in the hash table.  The translation still needs this vCPU's state
+ * and TLB, so it cannot move to another thread.
+ */
+#define TB_TIER_UP_QUEUE_SIZE 16
+
+typedef struct TBTierUp {
+    target_ulong pc;
+    target_ulong cs_base;
+    uint32_t flags;
+    uint32_t cflags;
+    tb_page_addr_t page_addr[2];
+} TBTierUp;
+
+typedef struct TBTierUpQueue {
+    unsigned flush_count;
+    unsigned n;
+    TBTierUp e[TB_TIER_UP_QUEUE_SIZE];
+} TBTierUpQueue;
+
+/* Queue @tb for tb_tier_up_drain().  Returns false if the queue is full. */
+static bool tb_tier_up_defer(CPUState *cpu, TranslationBlock *tb)
+{
+    TBTierUpQueue *q = cpu->tb_tier_up;
+    unsigned flush_count = qatomic_read(&tb_ctx.tb_flush_count);
+    TBTierUp *e;
+    unsigned i;
+
+    if (!q) {
+        q = cpu->tb_tier_up = g_new0(TBTierUpQueue, 1);
+    }
+    if (q->flush_count != flush_count) {
+        q->flush_count = flush_count;
+        q->n = 0;
+    }
+    for (i = 0; i < q->n; i++) {
+        e = &q->e[i];
+        if (e->pc == tb->pc && e->cs_base == tb->cs_base &&
+            e->flags == tb->flags && e->page_addr[0] == tb->page_addr[0]) {
+            return true;
+        }
+    }
+    if (q->n == TB_TIER_UP_QUEUE_SIZE) {
+        return false;
+    }
+
+    e = &q->e[q->n++];
+    e->pc = tb->pc;
+    e->cs_base = tb->cs_base;
+    e->flags = tb->flags;
+    e->cflags = tb_cflags(tb);
+    e->page_addr[0] = tb->page_addr[0];
+    e->page_addr[1] = tb->page_addr[1];
+    return true;
+}
+
+/* Is the page of @addr still mapped at @page, checked without faulting? */
+static bool tb_tier_up_mapped(CPUArchState *env, target_ulong addr,
+                              tb_page_addr_t page)
+{
+    void *host;
+
+    addr &= TARGET_PAGE_MASK;
+    if (probe_access_flags(env, addr, MMU_INST_FETCH, cpu_mmu_index(env, true),
+                           true, &host, 0) & TLB_INVALID_MASK) {
+        return false;
+    }
+    return get_page_addr_code(env, addr) == page;
+}
+
+/*
+ * The vCPU is about to halt: optimize the queued TBs that were translated
+ * for its current state, and whose code is still mapped where it was so
+ * that translating it cannot fault.  Stop early if the vCPU has work.
+ * A tb_flush() from tb_gen_code() unwinds to cpu_exec() as usual.
+ */
+static void tb_tier_up_drain(CPUState *cpu)
+{
+    CPUArchState *env = cpu->env_ptr;
+    TBTierUpQueue *q = cpu->tb_tier_up;
+    target_ulong pc, cs_base;
+    uint32_t flags, cflags;
+
+    if (!q || !q->n) {
+        return;
+    }
+    if (q->flush_count != qatomic_read(&tb_ctx.tb_flush_count)) {
+        q->n = 0;
+        return;
+    }
+
+    cpu_get_tb_cpu_state(env, &pc, &cs_base, &flags);
+    cflags = curr_cflags(cpu);
+    while (q->n && !qatomic_read(&cpu->interrupt_request) &&
+           !qatomic_read(&cpu->exit_request)) {
+        TBTierUp e = q->e[--q->n];
+        TranslationBlock *tb;
+
+        if (e.cs_base != cs_base || e.flags != flags ||
+            (e.cflags & CF_LOOKUP_MASK) != cflags ||
+            !tb_tier_up_mapped(env, e.pc, e.page_addr[0]) ||
+            (e.page_addr[1] != -1 &&
+             !tb_tier_up_mapped(env, (e.pc & TARGET_PAGE_MASK) +
+                                TARGET_PAGE_SIZE, e.page_addr[1]))) {
+            continue;
+        }
+
+        mmap_lock();
+        tb = tb_htable_lookup(cpu, e.pc, e.cs_base, e.flags, cflags);
+        if (tb && (tb_cflags(tb) & CF_QUICK)) {
+            tb_phys_invalidate(tb, -1);
+            tb_gen_code(cpu, e.pc, e.cs_base, e.flags, e.cflags & ~CF_QUICK);
+            qatomic_inc(&tb_ctx.tier_up_count);
+        }
+        mmap_unlock();
+    }
+}
+#endif /* !CONFIG_USER_ONLY */
+
 static inline bool cpu_handle_exception(CPUState *cpu, int *ret)
 {
     if (cpu->exception_index < 0) {
@@ -661,6 +878,11 @@ static inline bool cpu_handle_exception(CPUState *cpu, int *ret)
             cpu_handle_debug_exception(cpu);
         }
         cpu->exception_index = -1;
+#ifndef CONFIG_USER_ONLY
+        if (*ret == EXCP_HLT) {
+            tb_tier_up_drain(cpu);
+        }
+#endif
         return true;
     } else {
 #if defined(CONFIG_USER_ONLY)
@@ -838,6 +1060,43 @@ static inline bool cpu_handle_interrupt(CPUState *cpu,
     return false;
 }
 
+/*
+ * This vCPU entered @tb hot_threshold times: replace it with an optimized
+ * TB if it was a quick one, or else with a superblock, which the next
+ * lookup of its pc finds instead.  Other vCPUs may get there too; the
+ * first one to take mmap_lock does the work, the others find the TB
+ * invalid.  Optimizing is left for the vCPU to do when it halts, unless
+ * too many TBs are already waiting for it.
+ */
+static void tb_retranslate_hot(CPUState *cpu, TranslationBlock *tb)
+{
+    uint32_t cflags;
+
+    cpu->tb_hot[tb_hot_slot(tb)] = 0;
+#ifndef CONFIG_USER_ONLY
+    if ((tb_cflags(tb) & CF_QUICK) && tb_tier_up_defer(cpu, tb)) {
+        return;
+    }
+#endif
+
+    mmap_lock();
+    cflags = tb_cflags(tb);
+    if (cflags & CF_INVALID) {
+        mmap_unlock();
+        return;
+    }
+    tb_phys_invalidate(tb, -1);
+    if (cflags & CF_QUICK) {
+        tb_gen_code(cpu, tb->pc, tb->cs_base, tb->flags, cflags & ~CF_QUICK);
+        qatomic_inc(&tb_ctx.tier_up_count);
+    } else {
+        tb_gen_code(cpu, tb->pc, tb->cs_base, tb->flags,
+                    cflags | CF_SUPERBLOCK);
+        qatomic_inc(&tb_ctx.superblock_count);
+    }
+    mmap_unlock();
+}
+
 static inline void cpu_loop_exec_tb(CPUState *cpu, TranslationBlock *tb,
                                     TranslationBlock **last_tb, int *tb_exit)
 {
@@ -851,6 +1110,11 @@ static inline void cpu_loop_exec_tb(CPUState *cpu, TranslationBlock *tb,
     }
 
     *last_tb = NULL;
+    if (unlikely(tb->hot_threshold &&
+                 cpu->tb_hot[tb_hot_slot(tb)] >= tb->hot_threshold)) {
+        tb_retranslate_hot(cpu, tb);
+        return;
+    }
     insns_left = qatomic_read(&cpu_neg(cpu)->icount_decr.u32);
     if (insns_left < 0) {
         /* Something asked us to stop executing chained TBs; just
@@ -977,6 +1241,10 @@ int cpu_exec(CPUState *cpu)
 
             tb = tb_lookup(cpu, pc, cs_base, flags, cflags);
             if (tb == NULL) {
+                /* Code seen for the first time is translated quickly. */
+                if (tcg_tier_up_threshold && !(cflags & CF_NO_HOT_MASK)) {
+                    cflags |= CF_QUICK;
+                }
                 mmap_lock();
                 tb = tb_gen_code(cpu, pc, cs_base, flags, cflags);
                 mmap_unlock();
@@ -1043,6 +1311,8 @@ void tcg_exec_unrealizefn(CPUState *cpu)
 
     qemu_plugin_vcpu_exit_hook(cpu);
     tlb_destroy(cpu);
+    g_free(cpu->tb_tier_up);
+    cpu->tb_tier_up = NULL;
 }
 
 #ifndef CONFIG_USER_ONLY
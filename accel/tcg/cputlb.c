@@ -113,6 +113,27 @@ static void tb_flush_jmp_cache(CPUState *cpu, target_ulong addr)
        overlap the flushed page.  */
     tb_jmp_cache_clear_page(cpu, addr - TARGET_PAGE_SIZE);
     tb_jmp_cache_clear_page(cpu, addr);
+    cpu_tb_ic_epoch_bump(cpu);
+}
+
+/*
+ * Conflict misses in the direct-mapped table grow with its size, and so
+ * does the number of victims worth keeping; the victim tlb is searched
+ * linearly on every miss though, so keep it at 1/64th of the table.
+ */
+static void tlb_vtlb_alloc(CPUTLBDesc *desc, size_t n_entries)
+{
+    size_t vtlb_size = MIN(MAX(n_entries >> 6, CPU_VTLB_MIN_SIZE),
+                           CPU_VTLB_MAX_SIZE);
+
+    if (vtlb_size == desc->vtlb_size) {
+        return;
+    }
+    g_free(desc->vtable);
+    g_free(desc->viotlb);
+    desc->vtlb_size = vtlb_size;
+    desc->vtable = g_new(CPUTLBEntry, vtlb_size);
+    desc->viotlb = g_new(CPUIOTLBEntry, vtlb_size);
 }
 
 /**
@@ -154,6 +175,8 @@ static void tb_flush_jmp_cache(CPUState *cpu, target_ulong addr)
  * is direct mapped, so we want the use rate to be low (or at least not too
  * high), since otherwise we are likely to have a significant amount of
  * conflict misses.
+ *
+ * The victim tlb is resized along with it, see tlb_vtlb_alloc().
  */
 static void tlb_mmu_resize_locked(CPUTLBDesc *desc, CPUTLBDescFast *fast,
                                   int64_t now)
@@ -228,16 +251,16 @@ static void tlb_mmu_resize_locked(CPUTLBDesc *desc, CPUTLBDescFast *fast,
         fast->table = g_try_new(CPUTLBEntry, new_size);
         desc->iotlb = g_try_new(CPUIOTLBEntry, new_size);
     }
+    tlb_vtlb_alloc(desc, new_size);
 }
 
 static void tlb_mmu_flush_locked(CPUTLBDesc *desc, CPUTLBDescFast *fast)
 {
     desc->n_used_entries = 0;
-    desc->large_page_addr = -1;
-    desc->large_page_mask = -1;
+    desc->n_large_pages = 0;
     desc->vindex = 0;
     memset(fast->table, -1, sizeof_tlb(fast));
-    memset(desc->vtable, -1, sizeof(desc->vtable));
+    memset(desc->vtable, -1, desc->vtlb_size * sizeof(desc->vtable[0]));
 }
 
 static void tlb_flush_one_mmuidx_locked(CPUArchState *env, int mmu_idx,
@@ -259,6 +282,10 @@ static void tlb_mmu_init(CPUTLBDesc *desc, CPUTLBDescFast *fast, int64_t now)
     fast->mask = (n_entries - 1) << CPU_TLB_ENTRY_BITS;
     fast->table = g_new(CPUTLBEntry, n_entries);
     desc->iotlb = g_new(CPUIOTLBEntry, n_entries);
+    desc->vtlb_size = 0;
+    desc->vtable = NULL;
+    desc->viotlb = NULL;
+    tlb_vtlb_alloc(desc, n_entries);
     tlb_mmu_flush_locked(desc, fast);
 }
 
@@ -272,6 +299,19 @@ static inline void tlb_n_used_entries_dec(CPUArchState *env, uintptr_t mmu_idx)
     env_tlb(env)->d[mmu_idx].n_used_entries--;
 }
 
+typedef struct {
+    target_ulong addr;
+    target_ulong len;
+    uint16_t idxmap;
+    uint16_t bits;
+} TLBFlushRangeData;
+
+/* A page or range flush queued for another vCPU, see tlb_inval_post */
+typedef struct TLBInvalidation {
+    QSLIST_ENTRY(TLBInvalidation) next;
+    TLBFlushRangeData d;
+} TLBInvalidation;
+
 void tlb_init(CPUState *cpu)
 {
     CPUArchState *env = cpu->env_ptr;
@@ -282,6 +322,8 @@ void tlb_init(CPUState *cpu)
 
     /* All tlbs are initialized flushed. */
     env_tlb(env)->c.dirty = 0;
+    QSLIST_INIT(&env_tlb(env)->c.inval_queue);
+    env_tlb(env)->c.inval_safe_pending = false;
 
     for (i = 0; i < NB_MMU_MODES; i++) {
         tlb_mmu_init(&env_tlb(env)->d[i], &env_tlb(env)->f[i], now);
@@ -294,12 +336,20 @@ void tlb_destroy(CPUState *cpu)
     int i;
 
     qemu_spin_destroy(&env_tlb(env)->c.lock);
+    while (!QSLIST_EMPTY(&env_tlb(env)->c.inval_queue)) {
+        TLBInvalidation *e = QSLIST_FIRST(&env_tlb(env)->c.inval_queue);
+
+        QSLIST_REMOVE_HEAD(&env_tlb(env)->c.inval_queue, next);
+        g_free(e);
+    }
     for (i = 0; i < NB_MMU_MODES; i++) {
         CPUTLBDesc *desc = &env_tlb(env)->d[i];
         CPUTLBDescFast *fast = &env_tlb(env)->f[i];
 
         g_free(fast->table);
         g_free(desc->iotlb);
+        g_free(desc->vtable);
+        g_free(desc->viotlb);
     }
 }
 
@@ -322,10 +372,11 @@ static void flush_all_helper(CPUState *src, run_on_cpu_func fn,
     }
 }
 
-void tlb_flush_counts(size_t *pfull, size_t *ppart, size_t *pelide)
+void tlb_flush_counts(size_t *pfull, size_t *ppart, size_t *pelide,
+                      size_t *pcoalesced)
 {
     CPUState *cpu;
-    size_t full = 0, part = 0, elide = 0;
+    size_t full = 0, part = 0, elide = 0, coalesced = 0;
 
     CPU_FOREACH(cpu) {
         CPUArchState *env = cpu->env_ptr;
@@ -333,10 +384,12 @@ void tlb_flush_counts(size_t *pfull, size_t *ppart, size_t *pelide)
         full += qatomic_read(&env_tlb(env)->c.full_flush_count);
         part += qatomic_read(&env_tlb(env)->c.part_flush_count);
         elide += qatomic_read(&env_tlb(env)->c.elide_flush_count);
+        coalesced += qatomic_read(&env_tlb(env)->c.coalesced_flush_count);
     }
     *pfull = full;
     *ppart = part;
     *pelide = elide;
+    *pcoalesced = coalesced;
 }
 
 static void tlb_flush_by_mmuidx_async_work(CPUState *cpu, run_on_cpu_data data)
@@ -480,7 +533,7 @@ static void tlb_flush_vtlb_page_mask_locked(CPUArchState *env, int mmu_idx,
     int k;
 
     assert_cpu_is_self(env_cpu(env));
-    for (k = 0; k < CPU_VTLB_SIZE; k++) {
+    for (k = 0; k < d->vtlb_size; k++) {
         if (tlb_flush_entry_mask_locked(&d->vtable[k], page, mask)) {
             tlb_n_used_entries_dec(env, mmu_idx);
         }
@@ -493,19 +546,62 @@ static inline void tlb_flush_vtlb_page_locked(CPUArchState *env, int mmu_idx,
     tlb_flush_vtlb_page_mask_locked(env, mmu_idx, page, -1);
 }
 
+/*
+ * Flush every entry within large-page region @i of @midx, and forget
+ * about the region.  Called with tlb_c.lock held.
+ */
+static void tlb_flush_large_page_locked(CPUArchState *env, int midx,
+                                        unsigned i)
+{
+    CPUTLBDesc *d = &env_tlb(env)->d[midx];
+    CPUTLBDescFast *f = &env_tlb(env)->f[midx];
+    target_ulong lp_addr = d->large_page[i].addr;
+    target_ulong lp_mask = d->large_page[i].mask;
+    target_ulong last_page = ~lp_mask >> TARGET_PAGE_BITS;
+    size_t n_entries = tlb_n_entries(f);
+
+    tlb_debug("flushing large page midx %d ("
+              TARGET_FMT_lx "/" TARGET_FMT_lx ")\n",
+              midx, lp_addr, lp_mask);
+
+    d->large_page[i] = d->large_page[--d->n_large_pages];
+
+    if (last_page >= n_entries - 1) {
+        /* The region maps onto the whole table: check every entry. */
+        for (size_t k = 0; k < n_entries; k++) {
+            if (tlb_flush_entry_mask_locked(&f->table[k], lp_addr, lp_mask)) {
+                tlb_n_used_entries_dec(env, midx);
+            }
+        }
+    } else {
+        for (target_ulong k = 0; k <= last_page; k++) {
+            target_ulong page = lp_addr + (k << TARGET_PAGE_BITS);
+
+            if (tlb_flush_entry_locked(tlb_entry(env, midx, page), page)) {
+                tlb_n_used_entries_dec(env, midx);
+            }
+        }
+    }
+    tlb_flush_vtlb_page_mask_locked(env, midx, lp_addr, lp_mask);
+}
+
 static void tlb_flush_page_locked(CPUArchState *env, int midx,
                                   target_ulong page)
 {
-    target_ulong lp_addr = env_tlb(env)->d[midx].large_page_addr;
-    target_ulong lp_mask = env_tlb(env)->d[midx].large_page_mask;
+    CPUTLBDesc *d = &env_tlb(env)->d[midx];
+    bool in_large_page = false;
+    unsigned i = 0;
 
     /* Check if we need to flush due to large pages.  */
-    if ((page & lp_mask) == lp_addr) {
-        tlb_debug("forcing full flush midx %d ("
-                  TARGET_FMT_lx "/" TARGET_FMT_lx ")\n",
-                  midx, lp_addr, lp_mask);
-        tlb_flush_one_mmuidx_locked(env, midx, get_clock_realtime());
-    } else {
+    while (i < d->n_large_pages) {
+        if ((page & d->large_page[i].mask) == d->large_page[i].addr) {
+            tlb_flush_large_page_locked(env, midx, i);
+            in_large_page = true;
+        } else {
+            i++;
+        }
+    }
+    if (!in_large_page) {
         if (tlb_flush_entry_locked(tlb_entry(env, midx, page), page)) {
             tlb_n_used_entries_dec(env, midx);
         }
@@ -513,6 +609,8 @@ static void tlb_flush_page_locked(CPUArchState *env, int midx,
     }
 }
 
+static void tlb_inval_post(CPUState *cpu, TLBFlushRangeData d, bool safe);
+
 /**
  * tlb_flush_page_by_mmuidx_async_0:
  * @cpu: cpu on which to flush
@@ -544,48 +642,15 @@ static void tlb_flush_page_by_mmuidx_async_0(CPUState *cpu,
     tb_flush_jmp_cache(cpu, addr);
 }
 
-/**
- * tlb_flush_page_by_mmuidx_async_1:
- * @cpu: cpu on which to flush
- * @data: encoded addr + idxmap
- *
- * Helper for tlb_flush_page_by_mmuidx and friends, called through
- * async_run_on_cpu.  The idxmap parameter is encoded in the page
- * offset of the target_ptr field.  This limits the set of mmu_idx
- * that can be passed via this method.
- */
-static void tlb_flush_page_by_mmuidx_async_1(CPUState *cpu,
-                                             run_on_cpu_data data)
-{
-    target_ulong addr_and_idxmap = (target_ulong) data.target_ptr;
-    target_ulong addr = addr_and_idxmap & TARGET_PAGE_MASK;
-    uint16_t idxmap = addr_and_idxmap & ~TARGET_PAGE_MASK;
-
-    tlb_flush_page_by_mmuidx_async_0(cpu, addr, idxmap);
-}
-
-typedef struct {
-    target_ulong addr;
-    uint16_t idxmap;
-} TLBFlushPageByMMUIdxData;
-
-/**
- * tlb_flush_page_by_mmuidx_async_2:
- * @cpu: cpu on which to flush
- * @data: allocated addr + idxmap
- *
- * Helper for tlb_flush_page_by_mmuidx and friends, called through
- * async_run_on_cpu.  The addr+idxmap parameters are stored in a
- * TLBFlushPageByMMUIdxData structure that has been allocated
- * specifically for this helper.  Free the structure when done.
- */
-static void tlb_flush_page_by_mmuidx_async_2(CPUState *cpu,
-                                             run_on_cpu_data data)
+static TLBFlushRangeData tlb_flush_page_data(target_ulong addr,
+                                             uint16_t idxmap)
 {
-    TLBFlushPageByMMUIdxData *d = data.host_ptr;
-
-    tlb_flush_page_by_mmuidx_async_0(cpu, d->addr, d->idxmap);
-    g_free(d);
+    return (TLBFlushRangeData) {
+        .addr = addr,
+        .len = TARGET_PAGE_SIZE,
+        .idxmap = idxmap,
+        .bits = TARGET_LONG_BITS,
+    };
 }
 
 void tlb_flush_page_by_mmuidx(CPUState *cpu, target_ulong addr, uint16_t idxmap)
@@ -597,22 +662,8 @@ void tlb_flush_page_by_mmuidx(CPUState *cpu, target_ulong addr, uint16_t idxmap)
 
     if (qemu_cpu_is_self(cpu)) {
         tlb_flush_page_by_mmuidx_async_0(cpu, addr, idxmap);
-    } else if (idxmap < TARGET_PAGE_SIZE) {
-        /*
-         * Most targets have only a few mmu_idx.  In the case where
-         * we can stuff idxmap into the low TARGET_PAGE_BITS, avoid
-         * allocating memory for this operation.
-         */
-        async_run_on_cpu(cpu, tlb_flush_page_by_mmuidx_async_1,
-                         RUN_ON_CPU_TARGET_PTR(addr | idxmap));
     } else {
-        TLBFlushPageByMMUIdxData *d = g_new(TLBFlushPageByMMUIdxData, 1);
-
-        /* Otherwise allocate a structure, freed by the worker.  */
-        d->addr = addr;
-        d->idxmap = idxmap;
-        async_run_on_cpu(cpu, tlb_flush_page_by_mmuidx_async_2,
-                         RUN_ON_CPU_HOST_PTR(d));
+        tlb_inval_post(cpu, tlb_flush_page_data(addr, idxmap), false);
     }
 }
 
@@ -624,32 +675,16 @@ void tlb_flush_page(CPUState *cpu, target_ulong addr)
 void tlb_flush_page_by_mmuidx_all_cpus(CPUState *src_cpu, target_ulong addr,
                                        uint16_t idxmap)
 {
+    CPUState *dst_cpu;
+
     tlb_debug("addr: "TARGET_FMT_lx" mmu_idx:%"PRIx16"\n", addr, idxmap);
 
     /* This should already be page aligned */
     addr &= TARGET_PAGE_MASK;
 
-    /*
-     * Allocate memory to hold addr+idxmap only when needed.
-     * See tlb_flush_page_by_mmuidx for details.
-     */
-    if (idxmap < TARGET_PAGE_SIZE) {
-        flush_all_helper(src_cpu, tlb_flush_page_by_mmuidx_async_1,
-                         RUN_ON_CPU_TARGET_PTR(addr | idxmap));
-    } else {
-        CPUState *dst_cpu;
-
-        /* Allocate a separate data block for each destination cpu.  */
-        CPU_FOREACH(dst_cpu) {
-            if (dst_cpu != src_cpu) {
-                TLBFlushPageByMMUIdxData *d
-                    = g_new(TLBFlushPageByMMUIdxData, 1);
-
-                d->addr = addr;
-                d->idxmap = idxmap;
-                async_run_on_cpu(dst_cpu, tlb_flush_page_by_mmuidx_async_2,
-                                 RUN_ON_CPU_HOST_PTR(d));
-            }
+    CPU_FOREACH(dst_cpu) {
+        if (dst_cpu != src_cpu) {
+            tlb_inval_post(dst_cpu, tlb_flush_page_data(addr, idxmap), false);
         }
     }
 
@@ -665,41 +700,20 @@ void tlb_flush_page_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
                                               target_ulong addr,
                                               uint16_t idxmap)
 {
+    CPUState *dst_cpu;
+
     tlb_debug("addr: "TARGET_FMT_lx" mmu_idx:%"PRIx16"\n", addr, idxmap);
 
     /* This should already be page aligned */
     addr &= TARGET_PAGE_MASK;
 
-    /*
-     * Allocate memory to hold addr+idxmap only when needed.
-     * See tlb_flush_page_by_mmuidx for details.
-     */
-    if (idxmap < TARGET_PAGE_SIZE) {
-        flush_all_helper(src_cpu, tlb_flush_page_by_mmuidx_async_1,
-                         RUN_ON_CPU_TARGET_PTR(addr | idxmap));
-        async_safe_run_on_cpu(src_cpu, tlb_flush_page_by_mmuidx_async_1,
-                              RUN_ON_CPU_TARGET_PTR(addr | idxmap));
-    } else {
-        CPUState *dst_cpu;
-        TLBFlushPageByMMUIdxData *d;
-
-        /* Allocate a separate data block for each destination cpu.  */
-        CPU_FOREACH(dst_cpu) {
-            if (dst_cpu != src_cpu) {
-                d = g_new(TLBFlushPageByMMUIdxData, 1);
-                d->addr = addr;
-                d->idxmap = idxmap;
-                async_run_on_cpu(dst_cpu, tlb_flush_page_by_mmuidx_async_2,
-                                 RUN_ON_CPU_HOST_PTR(d));
-            }
+    CPU_FOREACH(dst_cpu) {
+        if (dst_cpu != src_cpu) {
+            tlb_inval_post(dst_cpu, tlb_flush_page_data(addr, idxmap), false);
         }
-
-        d = g_new(TLBFlushPageByMMUIdxData, 1);
-        d->addr = addr;
-        d->idxmap = idxmap;
-        async_safe_run_on_cpu(src_cpu, tlb_flush_page_by_mmuidx_async_2,
-                              RUN_ON_CPU_HOST_PTR(d));
     }
+
+    tlb_inval_post(src_cpu, tlb_flush_page_data(addr, idxmap), true);
 }
 
 void tlb_flush_page_all_cpus_synced(CPUState *src, target_ulong addr)
@@ -733,17 +747,16 @@ static void tlb_flush_range_locked(CPUArchState *env, int midx,
         return;
     }
 
-    /*
-     * Check if we need to flush due to large pages.
-     * Because large_page_mask contains all 1's from the msb,
-     * we only need to test the end of the range.
-     */
-    if (((addr + len - 1) & d->large_page_mask) == d->large_page_addr) {
-        tlb_debug("forcing full flush midx %d ("
-                  TARGET_FMT_lx "/" TARGET_FMT_lx ")\n",
-                  midx, d->large_page_addr, d->large_page_mask);
-        tlb_flush_one_mmuidx_locked(env, midx, get_clock_realtime());
-        return;
+    /* Flush the large-page regions that overlap the range.  */
+    for (unsigned i = 0; i < d->n_large_pages; ) {
+        target_ulong lp_addr = d->large_page[i].addr;
+        target_ulong lp_last = lp_addr | ~d->large_page[i].mask;
+
+        if (addr <= lp_last && addr + len - 1 >= lp_addr) {
+            tlb_flush_large_page_locked(env, midx, i);
+        } else {
+            i++;
+        }
     }
 
     for (target_ulong i = 0; i < len; i += TARGET_PAGE_SIZE) {
@@ -757,13 +770,6 @@ static void tlb_flush_range_locked(CPUArchState *env, int midx,
     }
 }
 
-typedef struct {
-    target_ulong addr;
-    target_ulong len;
-    uint16_t idxmap;
-    uint16_t bits;
-} TLBFlushRangeData;
-
 static void tlb_flush_range_by_mmuidx_async_0(CPUState *cpu,
                                               TLBFlushRangeData d)
 {
@@ -797,12 +803,122 @@ static void tlb_flush_range_by_mmuidx_async_0(CPUState *cpu,
     }
 }
 
-static void tlb_flush_range_by_mmuidx_async_1(CPUState *cpu,
-                                              run_on_cpu_data data)
+/*
+ * Page and range flushes of another vCPU's TLB go through a lock-free
+ * queue.  Only the request that finds the queue empty schedules work
+ * on the vCPU; any request posted before that work runs, at the vCPU's
+ * next TB boundary, rides along with it.  The queue is then drained in
+ * one go, merging overlapping and adjacent requests before touching the
+ * TLB, so a guest invalidating hundreds of pages in a row costs the
+ * other vCPUs one exit each instead of hundreds.
+ */
+static int tlb_inval_cmp(const void *a, const void *b)
+{
+    const TLBFlushRangeData *x = a;
+    const TLBFlushRangeData *y = b;
+
+    if (x->idxmap != y->idxmap) {
+        return x->idxmap < y->idxmap ? -1 : 1;
+    }
+    if (x->bits != y->bits) {
+        return x->bits < y->bits ? -1 : 1;
+    }
+    if (x->addr != y->addr) {
+        return x->addr < y->addr ? -1 : 1;
+    }
+    return 0;
+}
+
+static void tlb_inval_drain(CPUState *cpu)
+{
+    CPUArchState *env = cpu->env_ptr;
+    QSLIST_HEAD(, TLBInvalidation) list;
+    TLBInvalidation *e, *next;
+    TLBFlushRangeData *r;
+    size_t i, n = 0, out = 0;
+
+    QSLIST_MOVE_ATOMIC(&list, &env_tlb(env)->c.inval_queue);
+    QSLIST_FOREACH(e, &list, next) {
+        n++;
+    }
+    if (n == 0) {
+        return;
+    }
+
+    r = g_new(TLBFlushRangeData, n);
+    QSLIST_FOREACH_SAFE(e, &list, next, next) {
+        r[out++] = e->d;
+        g_free(e);
+    }
+    qsort(r, n, sizeof(*r), tlb_inval_cmp);
+
+    for (i = 1, out = 1; i < n; i++) {
+        TLBFlushRangeData *prev = &r[out - 1];
+
+        if (r[i].idxmap == prev->idxmap && r[i].bits == prev->bits &&
+            r[i].addr - prev->addr <= prev->len) {
+            prev->len = MAX(prev->len, r[i].addr - prev->addr + r[i].len);
+        } else {
+            r[out++] = r[i];
+        }
+    }
+
+    for (i = 0; i < out; i++) {
+        if (r[i].bits >= TARGET_LONG_BITS && r[i].len <= TARGET_PAGE_SIZE) {
+            tlb_flush_page_by_mmuidx_async_0(cpu, r[i].addr, r[i].idxmap);
+        } else {
+            tlb_flush_range_by_mmuidx_async_0(cpu, r[i]);
+        }
+    }
+    g_free(r);
+
+    if (out != n) {
+        qatomic_set(&env_tlb(env)->c.coalesced_flush_count,
+                    env_tlb(env)->c.coalesced_flush_count + n - out);
+    }
+}
+
+static void tlb_inval_drain_async(CPUState *cpu, run_on_cpu_data data)
+{
+    tlb_inval_drain(cpu);
+}
+
+static void tlb_inval_drain_safe(CPUState *cpu, run_on_cpu_data data)
+{
+    CPUArchState *env = cpu->env_ptr;
+
+    qatomic_xchg(&env_tlb(env)->c.inval_safe_pending, false);
+    tlb_inval_drain(cpu);
+}
+
+/*
+ * Queue the flush @d on @cpu.  If @safe, make sure that it is carried
+ * out as safe work, as needed by the _synced variants for the source cpu.
+ */
+static void tlb_inval_post(CPUState *cpu, TLBFlushRangeData d, bool safe)
 {
-    TLBFlushRangeData *d = data.host_ptr;
-    tlb_flush_range_by_mmuidx_async_0(cpu, *d);
-    g_free(d);
+    CPUArchState *env = cpu->env_ptr;
+    CPUTLBCommon *c = &env_tlb(env)->c;
+    TLBInvalidation *e = g_new(TLBInvalidation, 1);
+    TLBInvalidation *head;
+
+    /*
+     * As QSLIST_INSERT_HEAD_ATOMIC, but remember the old head: @e may
+     * be drained and freed as soon as it is visible.
+     */
+    e->d = d;
+    do {
+        head = qatomic_read(&c->inval_queue.slh_first);
+        e->next.sle_next = head;
+    } while (qatomic_cmpxchg(&c->inval_queue.slh_first, head, e) != head);
+
+    if (safe) {
+        if (!qatomic_xchg(&c->inval_safe_pending, true)) {
+            async_safe_run_on_cpu(cpu, tlb_inval_drain_safe, RUN_ON_CPU_NULL);
+        }
+    } else if (head == NULL) {
+        async_run_on_cpu(cpu, tlb_inval_drain_async, RUN_ON_CPU_NULL);
+    }
 }
 
 void tlb_flush_range_by_mmuidx(CPUState *cpu, target_ulong addr,
@@ -834,10 +950,7 @@ void tlb_flush_range_by_mmuidx(CPUState *cpu, target_ulong addr,
     if (qemu_cpu_is_self(cpu)) {
         tlb_flush_range_by_mmuidx_async_0(cpu, d);
     } else {
-        /* Otherwise allocate a structure, freed by the worker.  */
-        TLBFlushRangeData *p = g_memdup(&d, sizeof(d));
-        async_run_on_cpu(cpu, tlb_flush_range_by_mmuidx_async_1,
-                         RUN_ON_CPU_HOST_PTR(p));
+        tlb_inval_post(cpu, d, false);
     }
 }
 
@@ -874,13 +987,9 @@ void tlb_flush_range_by_mmuidx_all_cpus(CPUState *src_cpu,
     d.idxmap = idxmap;
     d.bits = bits;
 
-    /* Allocate a separate data block for each destination cpu.  */
     CPU_FOREACH(dst_cpu) {
         if (dst_cpu != src_cpu) {
-            TLBFlushRangeData *p = g_memdup(&d, sizeof(d));
-            async_run_on_cpu(dst_cpu,
-                             tlb_flush_range_by_mmuidx_async_1,
-                             RUN_ON_CPU_HOST_PTR(p));
+            tlb_inval_post(dst_cpu, d, false);
         }
     }
 
@@ -901,7 +1010,7 @@ void tlb_flush_range_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
                                                uint16_t idxmap,
                                                unsigned bits)
 {
-    TLBFlushRangeData d, *p;
+    TLBFlushRangeData d;
     CPUState *dst_cpu;
 
     /*
@@ -924,18 +1033,13 @@ void tlb_flush_range_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
     d.idxmap = idxmap;
     d.bits = bits;
 
-    /* Allocate a separate data block for each destination cpu.  */
     CPU_FOREACH(dst_cpu) {
         if (dst_cpu != src_cpu) {
-            p = g_memdup(&d, sizeof(d));
-            async_run_on_cpu(dst_cpu, tlb_flush_range_by_mmuidx_async_1,
-                             RUN_ON_CPU_HOST_PTR(p));
+            tlb_inval_post(dst_cpu, d, false);
         }
     }
 
-    p = g_memdup(&d, sizeof(d));
-    async_safe_run_on_cpu(src_cpu, tlb_flush_range_by_mmuidx_async_1,
-                          RUN_ON_CPU_HOST_PTR(p));
+    tlb_inval_post(src_cpu, d, true);
 }
 
 void tlb_flush_page_bits_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
@@ -1030,7 +1134,7 @@ void tlb_reset_dirty(CPUState *cpu, ram_addr_t start1, ram_addr_t length)
                                          start1, length);
         }
 
-        for (i = 0; i < CPU_VTLB_SIZE; i++) {
+        for (i = 0; i < env_tlb(env)->d[mmu_idx].vtlb_size; i++) {
             tlb_reset_dirty_range_locked(&env_tlb(env)->d[mmu_idx].vtable[i],
                                          start1, length);
         }
@@ -1064,35 +1168,56 @@ void tlb_set_dirty(CPUState *cpu, target_ulong vaddr)
 
     for (mmu_idx = 0; mmu_idx < NB_MMU_MODES; mmu_idx++) {
         int k;
-        for (k = 0; k < CPU_VTLB_SIZE; k++) {
+        for (k = 0; k < env_tlb(env)->d[mmu_idx].vtlb_size; k++) {
             tlb_set_dirty1_locked(&env_tlb(env)->d[mmu_idx].vtable[k], vaddr);
         }
     }
     qemu_spin_unlock(&env_tlb(env)->c.lock);
 }
 
-/* Our TLB does not support large pages, so remember the area covered by
-   large pages and trigger a full TLB flush if these are invalidated.  */
+/* Our TLB does not support large pages, so remember the areas covered by
+   large pages and flush all of an area if a page within it is invalidated.
+   Up to CPU_TLB_LARGE_PAGES areas are tracked separately.  */
 static void tlb_add_large_page(CPUArchState *env, int mmu_idx,
                                target_ulong vaddr, target_ulong size)
 {
-    target_ulong lp_addr = env_tlb(env)->d[mmu_idx].large_page_addr;
+    CPUTLBDesc *d = &env_tlb(env)->d[mmu_idx];
     target_ulong lp_mask = ~(size - 1);
+    CPUTLBLargePage *lp;
+    unsigned i;
+
+    for (i = 0; i < d->n_large_pages; i++) {
+        lp = &d->large_page[i];
+        if ((vaddr & lp->mask) == lp->addr && lp->mask <= lp_mask) {
+            /* Already covered.  */
+            return;
+        }
+    }
 
-    if (lp_addr == (target_ulong)-1) {
-        /* No previous large page.  */
-        lp_addr = vaddr;
+    if (d->n_large_pages < CPU_TLB_LARGE_PAGES) {
+        lp = &d->large_page[d->n_large_pages++];
     } else {
-        /* Extend the existing region to include the new page.
+        /* Extend the region that grows the least to include the new page.
            This is a compromise between unnecessary flushes and
            the cost of maintaining a full variable size TLB.  */
-        lp_mask &= env_tlb(env)->d[mmu_idx].large_page_mask;
-        while (((lp_addr ^ vaddr) & lp_mask) != 0) {
-            lp_mask <<= 1;
+        target_ulong best_mask = 0;
+
+        lp = &d->large_page[0];
+        for (i = 0; i < d->n_large_pages; i++) {
+            target_ulong mask = lp_mask & d->large_page[i].mask;
+
+            while (((d->large_page[i].addr ^ vaddr) & mask) != 0) {
+                mask <<= 1;
+            }
+            if (mask > best_mask) {
+                best_mask = mask;
+                lp = &d->large_page[i];
+            }
         }
+        lp_mask = best_mask;
     }
-    env_tlb(env)->d[mmu_idx].large_page_addr = lp_addr & lp_mask;
-    env_tlb(env)->d[mmu_idx].large_page_mask = lp_mask;
+    lp->addr = vaddr & lp_mask;
+    lp->mask = lp_mask;
 }
 
 /* Add a new TLB entry. At most one entry for a given virtual address
@@ -1214,7 +1339,7 @@ void tlb_set_page_with_attrs(CPUState *cpu, target_ulong vaddr,
      * different page; otherwise just overwrite the stale data.
      */
     if (!tlb_hit_page_anyprot(te, vaddr_page) && !tlb_entry_is_empty(te)) {
-        unsigned vidx = desc->vindex++ % CPU_VTLB_SIZE;
+        unsigned vidx = desc->vindex++ % desc->vtlb_size;
         CPUTLBEntry *tv = &desc->vtable[vidx];
 
         /* Evict the old entry into the victim tlb.  */
@@ -1361,7 +1486,7 @@ static uint64_t io_readx(CPUArchState *env, CPUIOTLBEntry *iotlbentry,
         cpu_io_recompile(cpu, retaddr);
     }
 
-    if (!qemu_mutex_iothread_locked()) {
+    if (mr->global_locking && !qemu_mutex_iothread_locked()) {
         qemu_mutex_lock_iothread();
         locked = true;
     }
@@ -1422,7 +1547,7 @@ static void io_writex(CPUArchState *env, CPUIOTLBEntry *iotlbentry,
      */
     save_iotlb_data(cpu, iotlbentry->addr, section, mr_offset);
 
-    if (!qemu_mutex_iothread_locked()) {
+    if (mr->global_locking && !qemu_mutex_iothread_locked()) {
         qemu_mutex_lock_iothread();
         locked = true;
     }
@@ -1459,7 +1584,7 @@ static bool victim_tlb_hit(CPUArchState *env, size_t mmu_idx, size_t index,
     size_t vidx;
 
     assert_cpu_is_self(env_cpu(env));
-    for (vidx = 0; vidx < CPU_VTLB_SIZE; ++vidx) {
+    for (vidx = 0; vidx < env_tlb(env)->d[mmu_idx].vtlb_size; ++vidx) {
         CPUTLBEntry *vtlb = &env_tlb(env)->d[mmu_idx].vtable[vidx];
         target_ulong cmp;
 
@@ -16,6 +16,13 @@ TranslationBlock *tb_gen_code(CPUState *cpu, target_ulong pc,
                               int cflags);
 
 void QEMU_NORETURN cpu_io_recompile(CPUState *cpu, uintptr_t retaddr);
+
+/* Entries before a TB becomes a superblock, 0 if disabled. */
+extern unsigned tcg_superblock_threshold;
+/* Entries before a CF_QUICK TB is optimized, 0 if TBs start optimized. */
+extern unsigned tcg_tier_up_threshold;
+/* Placeholder destination of empty TB inline cache slots. */
+extern TranslationBlock tb_ic_empty;
 void page_init(void);
 void tb_htable_init(void);
 
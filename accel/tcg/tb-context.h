@@ -22,6 +22,7 @@
 
 #include "qemu/thread.h"
 #include "qemu/qht.h"
+#include "qemu/stats64.h"
 
 #define CODE_GEN_HTABLE_BITS     15
 #define CODE_GEN_HTABLE_SIZE     (1 << CODE_GEN_HTABLE_BITS)
@@ -35,6 +36,16 @@ struct TBContext {
     /* statistics */
     unsigned tb_flush_count;
     unsigned tb_phys_invalidate_count;
+    unsigned superblock_count;
+    unsigned tier_up_count;
+    unsigned ras_mispredict_count;
+    unsigned region_evict_count;
+    /* time spent with the vCPUs stopped for tb_flush, in ns */
+    Stat64 flush_time;
+    Stat64 flush_time_max;
+    /* time a vCPU spent invalidating an evicted region, in ns */
+    Stat64 evict_time;
+    Stat64 evict_time_max;
 };
 
 extern TBContext tb_ctx;
@@ -44,6 +44,8 @@ struct TCGState {
     bool mttcg_enabled;
     int splitwx_enabled;
     unsigned long tb_size;
+    uint32_t superblock_threshold;
+    uint32_t tier_up_threshold;
 };
 typedef struct TCGState TCGState;
 
@@ -109,6 +111,8 @@ static void tcg_accel_instance_init(Object *obj)
 }
 
 bool mttcg_enabled;
+unsigned tcg_superblock_threshold;
+unsigned tcg_tier_up_threshold;
 
 static int tcg_init_machine(MachineState *ms)
 {
@@ -121,6 +125,8 @@ static int tcg_init_machine(MachineState *ms)
 
     tcg_allowed = true;
     mttcg_enabled = s->mttcg_enabled;
+    tcg_superblock_threshold = s->superblock_threshold;
+    tcg_tier_up_threshold = s->tier_up_threshold;
 
     page_init();
     tb_htable_init();
@@ -196,6 +202,63 @@ static void tcg_set_tb_size(Object *obj, Visitor *v,
     s->tb_size = value;
 }
 
+static void tcg_get_superblock_threshold(Object *obj, Visitor *v,
+                                         const char *name, void *opaque,
+                                         Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value = s->superblock_threshold;
+
+    visit_type_uint32(v, name, &value, errp);
+}
+
+static void tcg_set_superblock_threshold(Object *obj, Visitor *v,
+                                         const char *name, void *opaque,
+                                         Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value;
+
+    if (!visit_type_uint32(v, name, &value, errp)) {
+        return;
+    }
+    if (value > INT32_MAX) {
+        error_setg(errp, "superblock-threshold must be at most %d",
+                   INT32_MAX);
+        return;
+    }
+
+    s->superblock_threshold = value;
+}
+
+static void tcg_get_tier_up_threshold(Object *obj, Visitor *v,
+                                      const char *name, void *opaque,
+                                      Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value = s->tier_up_threshold;
+
+    visit_type_uint32(v, name, &value, errp);
+}
+
+static void tcg_set_tier_up_threshold(Object *obj, Visitor *v,
+                                      const char *name, void *opaque,
+                                      Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value;
+
+    if (!visit_type_uint32(v, name, &value, errp)) {
+        return;
+    }
+    if (value > INT32_MAX) {
+        error_setg(errp, "tier-up-threshold must be at most %d", INT32_MAX);
+        return;
+    }
+
+    s->tier_up_threshold = value;
+}
+
 static bool tcg_get_splitwx(Object *obj, Error **errp)
 {
     TCGState *s = TCG_STATE(obj);
@@ -229,6 +292,20 @@ static void tcg_accel_class_init(ObjectClass *oc, void *data)
         tcg_get_splitwx, tcg_set_splitwx);
     object_class_property_set_description(oc, "split-wx",
         "Map jit pages into separate RW and RX regions");
+
+    object_class_property_add(oc, "superblock-threshold", "int",
+        tcg_get_superblock_threshold, tcg_set_superblock_threshold,
+        NULL, NULL);
+    object_class_property_set_description(oc, "superblock-threshold",
+        "Entries after which a TB is retranslated as a superblock "
+        "(0 disables)");
+
+    object_class_property_add(oc, "tier-up-threshold", "int",
+        tcg_get_tier_up_threshold, tcg_set_tier_up_threshold,
+        NULL, NULL);
+    object_class_property_set_description(oc, "tier-up-threshold",
+        "Entries after which a TB translated without optimization is "
+        "translated again with it (0 always optimizes)");
 }
 
 static const TypeInfo tcg_accel_type = {
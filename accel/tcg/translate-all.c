@@ -221,6 +221,11 @@ static void *l1_map[V_L1_MAX_SIZE];
 
 TBContext tb_ctx;
 
+/* Target of every empty TBInlineCache slot; never matches a lookup. */
+TranslationBlock tb_ic_empty = {
+    .cflags = CF_INVALID,
+};
+
 static void page_table_config_init(void)
 {
     uint32_t v_l1_bits;
@@ -894,7 +899,8 @@ static bool tb_cmp(const void *ap, const void *bp)
     return a->pc == b->pc &&
         a->cs_base == b->cs_base &&
         a->flags == b->flags &&
-        (tb_cflags(a) & ~CF_INVALID) == (tb_cflags(b) & ~CF_INVALID) &&
+        (tb_cflags(a) & ~CF_INVALID & CF_LOOKUP_MASK) ==
+        (tb_cflags(b) & ~CF_INVALID & CF_LOOKUP_MASK) &&
         a->trace_vcpu_dstate == b->trace_vcpu_dstate &&
         a->page_addr[0] == b->page_addr[0] &&
         a->page_addr[1] == b->page_addr[1];
@@ -902,7 +908,7 @@ static bool tb_cmp(const void *ap, const void *bp)
 
 void tb_htable_init(void)
 {
-    unsigned int mode = QHT_MODE_AUTO_RESIZE;
+    unsigned int mode = QHT_MODE_AUTO_RESIZE | QHT_MODE_INCREMENTAL_RESIZE;
 
     qht_init(&tb_ctx.htable, tb_cmp, CODE_GEN_HTABLE_SIZE, mode);
 }
@@ -966,6 +972,7 @@ static gboolean tb_host_size_iter(gpointer key, gpointer value, gpointer data)
 static void do_tb_flush(CPUState *cpu, run_on_cpu_data tb_flush_count)
 {
     bool did_flush = false;
+    int64_t start;
 
     mmap_lock();
     /* If it is already been done on request of another CPU,
@@ -975,6 +982,7 @@ static void do_tb_flush(CPUState *cpu, run_on_cpu_data tb_flush_count)
         goto done;
     }
     did_flush = true;
+    start = get_clock();
 
     if (DEBUG_TB_FLUSH_GATE) {
         size_t nb_tbs = tcg_nb_tbs();
@@ -997,6 +1005,10 @@ static void do_tb_flush(CPUState *cpu, run_on_cpu_data tb_flush_count)
        expensive */
     qatomic_mb_set(&tb_ctx.tb_flush_count, tb_ctx.tb_flush_count + 1);
 
+    start = get_clock() - start;
+    stat64_add(&tb_ctx.flush_time, start);
+    stat64_max(&tb_ctx.flush_time_max, start);
+
 done:
     mmap_unlock();
     if (did_flush) {
@@ -1004,6 +1016,89 @@ done:
     }
 }
 
+#ifdef CONFIG_SOFTMMU
+typedef struct TBEviction {
+    struct rcu_head rcu;
+    size_t region;
+    uint64_t reset_count;
+} TBEviction;
+
+/*
+ * Called once no vCPU can be executing, or about to execute, a TB of the
+ * evicted region.  Drop the references that lookups made in the meantime
+ * and hand the region back for reuse.
+ */
+static void tb_evict_region_reclaim(struct rcu_head *head)
+{
+    TBEviction *ev = container_of(head, TBEviction, rcu);
+    const void *start, *end;
+    CPUState *cpu;
+    unsigned int i;
+
+    tcg_region_range(ev->region, &start, &end);
+    CPU_FOREACH(cpu) {
+        for (i = 0; i < TB_JMP_CACHE_SIZE; i++) {
+            TranslationBlock *tb = qatomic_read(&cpu->tb_jmp_cache[i]);
+
+            if (tb && tb->tc.ptr >= start && tb->tc.ptr < end) {
+                qatomic_cmpxchg(&cpu->tb_jmp_cache[i], tb, NULL);
+            }
+        }
+        /* Inline caches and return stacks may still point into it. */
+        cpu_tb_ic_epoch_bump(cpu);
+    }
+
+    if (tcg_region_evict_end(ev->region, ev->reset_count)) {
+        qatomic_inc(&tb_ctx.region_evict_count);
+    }
+    g_free(ev);
+}
+
+/*
+ * Retire the oldest region of the code buffer, so that it can be reused
+ * before the buffer fills up and everything has to be flushed.  Only the
+ * jumps into the region are unlinked; the other vCPUs keep running.
+ */
+static void tb_evict_region(void)
+{
+    TBEviction *ev;
+    GPtrArray *tbs;
+    uint64_t reset_count;
+    ssize_t victim;
+    int64_t start;
+    guint i;
+
+    victim = tcg_region_evict_begin(&reset_count);
+    if (victim < 0) {
+        return;
+    }
+
+    start = get_clock();
+    tbs = tcg_region_tbs(victim);
+    for (i = 0; i < tbs->len; i++) {
+        TranslationBlock *tb = g_ptr_array_index(tbs, i);
+
+        if (!(qatomic_read(&tb->cflags) & CF_INVALID)) {
+            tb_phys_invalidate(tb, -1);
+        }
+    }
+    g_ptr_array_free(tbs, true);
+
+    ev = g_new(TBEviction, 1);
+    ev->region = victim;
+    ev->reset_count = reset_count;
+    call_rcu(ev, tb_evict_region_reclaim, rcu);
+
+    start = get_clock() - start;
+    stat64_add(&tb_ctx.evict_time, start);
+    stat64_max(&tb_ctx.evict_time_max, start);
+}
+#else
+static inline void tb_evict_region(void)
+{
+}
+#endif
+
 void tb_flush(CPUState *cpu)
 {
     if (tcg_enabled()) {
@@ -1187,7 +1282,7 @@ static void do_tb_phys_invalidate(TranslationBlock *tb, bool rm_from_page_list)
 
     /* remove the TB from the hash list */
     phys_pc = tb->page_addr[0] + (tb->pc & ~TARGET_PAGE_MASK);
-    h = tb_hash_func(phys_pc, tb->pc, tb->flags, orig_cflags,
+    h = tb_hash_func(phys_pc, tb->pc, tb->flags, orig_cflags & CF_LOOKUP_MASK,
                      tb->trace_vcpu_dstate);
     if (!qht_remove(&tb_ctx.htable, tb, h)) {
         return;
@@ -1350,7 +1445,7 @@ tb_link_page(TranslationBlock *tb, tb_page_addr_t phys_pc,
     }
 
     /* add in the hash table */
-    h = tb_hash_func(phys_pc, tb->pc, tb->flags, tb->cflags,
+    h = tb_hash_func(phys_pc, tb->pc, tb->flags, tb->cflags & CF_LOOKUP_MASK,
                      tb->trace_vcpu_dstate);
     qht_insert(&tb_ctx.htable, tb, h, &existing_tb);
 
@@ -1388,7 +1483,7 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     tb_page_addr_t phys_pc, phys_page2;
     target_ulong virt_page2;
     tcg_insn_unit *gen_code_buf;
-    int gen_code_size, search_size, max_insns;
+    int gen_code_size, search_size, max_insns, i;
 #ifdef CONFIG_PROFILER
     TCGProfile *prof = &tcg_ctx->prof;
     int64_t ti;
@@ -1410,6 +1505,10 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     }
     QEMU_BUILD_BUG_ON(CF_COUNT_MASK + 1 != TCG_MAX_INSNS);
 
+    if (unlikely(tcg_region_evict_wanted())) {
+        tb_evict_region();
+    }
+
  buffer_overflow:
     tb = tcg_tb_alloc(tcg_ctx);
     if (unlikely(!tb)) {
@@ -1428,6 +1527,11 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     tb->flags = flags;
     tb->cflags = cflags;
     tb->trace_vcpu_dstate = *cpu->trace_dstate;
+    tb->hot_threshold = 0;
+    for (i = 0; i < TB_IC_SLOTS; i++) {
+        tb->ic[i] = (TBInlineCache) { .dest = &tb_ic_empty };
+    }
+    tb->ret_ic = (TBInlineCache) { .dest = &tb_ic_empty };
     tcg_ctx->tb_cflags = cflags;
  tb_overflow:
 
@@ -2041,6 +2145,12 @@ struct tb_tree_stats {
     size_t direct_jmp_count;
     size_t direct_jmp2_count;
     size_t cross_page;
+    size_t superblocks;
+    size_t quick;
+    size_t ic_hits;
+    size_t ic_misses;
+    size_t ras_hits;
+    size_t ras_misses;
 };
 
 static gboolean tb_tree_stats_iter(gpointer key, gpointer value, gpointer data)
@@ -2057,6 +2167,12 @@ static gboolean tb_tree_stats_iter(gpointer key, gpointer value, gpointer data)
     if (tb->page_addr[1] != -1) {
         tst->cross_page++;
     }
+    if (tb_cflags(tb) & CF_SUPERBLOCK) {
+        tst->superblocks++;
+    }
+    if (tb_cflags(tb) & CF_QUICK) {
+        tst->quick++;
+    }
     if (tb->jmp_reset_offset[0] != TB_JMP_RESET_OFFSET_INVALID) {
         tst->direct_jmp_count++;
         if (tb->jmp_reset_offset[1] != TB_JMP_RESET_OFFSET_INVALID) {
@@ -2070,9 +2186,16 @@ void dump_exec_info(GString *buf)
 {
     struct tb_tree_stats tst = {};
     struct qht_stats hst;
-    size_t nb_tbs, flush_full, flush_part, flush_elide;
+    size_t nb_tbs, flush_full, flush_part, flush_elide, flush_coalesced;
+    CPUState *cpu;
 
     tcg_tb_foreach(tb_tree_stats_iter, &tst);
+    CPU_FOREACH(cpu) {
+        tst.ic_hits += qatomic_read(&cpu->tb_ic_hits);
+        tst.ic_misses += qatomic_read(&cpu->tb_ic_misses);
+        tst.ras_hits += qatomic_read(&cpu->tb_ras_hits);
+        tst.ras_misses += qatomic_read(&cpu->tb_ras_misses);
+    }
     nb_tbs = tst.nb_tbs;
     /* XXX: avoid using doubles ? */
     g_string_append_printf(buf, "Translation buffer state:\n");
@@ -2101,6 +2224,36 @@ void dump_exec_info(GString *buf)
                            nb_tbs ? (tst.direct_jmp_count * 100) / nb_tbs : 0,
                            tst.direct_jmp2_count,
                            nb_tbs ? (tst.direct_jmp2_count * 100) / nb_tbs : 0);
+    g_string_append_printf(buf, "inline cache hits   %zu (%zu%%) "
+                           "(misses=%zu)\n",
+                           tst.ic_hits,
+                           tst.ic_hits + tst.ic_misses ?
+                           (tst.ic_hits * 100) /
+                           (tst.ic_hits + tst.ic_misses) : 0,
+                           tst.ic_misses);
+    g_string_append_printf(buf, "return stack hits   %zu (%zu%%) "
+                           "(misses=%zu)\n",
+                           tst.ras_hits,
+                           tst.ras_hits + tst.ras_misses ?
+                           (tst.ras_hits * 100) /
+                           (tst.ras_hits + tst.ras_misses) : 0,
+                           tst.ras_misses);
+    if (tcg_superblock_threshold) {
+        g_string_append_printf(buf, "superblock count    %zu (%zu%%) "
+                               "(threshold=%u)\n",
+                               tst.superblocks,
+                               nb_tbs ? (tst.superblocks * 100) / nb_tbs : 0,
+                               tcg_superblock_threshold);
+    } else {
+        g_string_append_printf(buf, "superblock count    disabled\n");
+    }
+    if (tcg_tier_up_threshold) {
+        g_string_append_printf(buf, "unoptimized count   %zu (%zu%%) "
+                               "(threshold=%u)\n",
+                               tst.quick,
+                               nb_tbs ? (tst.quick * 100) / nb_tbs : 0,
+                               tcg_tier_up_threshold);
+    }
 
     qht_statistics_init(&tb_ctx.htable, &hst);
     print_qht_statistics(hst, buf);
@@ -2109,13 +2262,34 @@ void dump_exec_info(GString *buf)
     g_string_append_printf(buf, "\nStatistics:\n");
     g_string_append_printf(buf, "TB flush count      %u\n",
                            qatomic_read(&tb_ctx.tb_flush_count));
+    g_string_append_printf(buf, "TB flush time       avg=%" PRIu64
+                           " max=%" PRIu64 " us\n",
+                           tb_ctx.tb_flush_count ?
+                           stat64_get(&tb_ctx.flush_time) / 1000 /
+                           tb_ctx.tb_flush_count : 0,
+                           stat64_get(&tb_ctx.flush_time_max) / 1000);
+    g_string_append_printf(buf, "TB region evictions %u (avg=%" PRIu64
+                           " max=%" PRIu64 " us)\n",
+                           qatomic_read(&tb_ctx.region_evict_count),
+                           tb_ctx.region_evict_count ?
+                           stat64_get(&tb_ctx.evict_time) / 1000 /
+                           tb_ctx.region_evict_count : 0,
+                           stat64_get(&tb_ctx.evict_time_max) / 1000);
     g_string_append_printf(buf, "TB invalidate count %u\n",
                            qatomic_read(&tb_ctx.tb_phys_invalidate_count));
-
-    tlb_flush_counts(&flush_full, &flush_part, &flush_elide);
+    g_string_append_printf(buf, "superblocks formed  %u\n",
+                           qatomic_read(&tb_ctx.superblock_count));
+    g_string_append_printf(buf, "TBs optimized late  %u\n",
+                           qatomic_read(&tb_ctx.tier_up_count));
+    g_string_append_printf(buf, "return mispredicts  %u\n",
+                           qatomic_read(&tb_ctx.ras_mispredict_count));
+
+    tlb_flush_counts(&flush_full, &flush_part, &flush_elide, &flush_coalesced);
     g_string_append_printf(buf, "TLB full flushes    %zu\n", flush_full);
     g_string_append_printf(buf, "TLB partial flushes %zu\n", flush_part);
     g_string_append_printf(buf, "TLB elided flushes  %zu\n", flush_elide);
+    g_string_append_printf(buf, "TLB coalesced flushes %zu\n",
+                           flush_coalesced);
     tcg_dump_info(buf);
 }
 
@@ -17,6 +17,7 @@
 #include "exec/translator.h"
 #include "exec/plugin-gen.h"
 #include "sysemu/replay.h"
+#include "internal.h"
 
 /* Pairs with tcg_clear_temp_count.
    To be called by #TranslatorOps.{translate_insn,tb_stop} if
@@ -51,6 +52,280 @@ static inline void translator_page_protect(DisasContextBase *dcbase,
 #endif
 }
 
+bool translator_follow_jump(DisasContextBase *db, target_ulong next,
+                            target_ulong dest)
+{
+    if (!(tb_cflags(db->tb) & CF_SUPERBLOCK) || dest < next) {
+        return false;
+    }
+    return translator_use_goto_tb(db, dest);
+}
+
+/* Offset of a CPUState field from cpu_env. */
+#define CPU_OFFSET(field) \
+    (offsetof(ArchCPU, parent_obj.field) - offsetof(ArchCPU, env))
+
+void translator_lookup_and_goto_ptr(DisasContextBase *db, TCGv pc)
+{
+    TranslationBlock *tb = (TranslationBlock *)db->tb;
+    TCGLabel *miss;
+    TCGv_ptr slot, dest, code;
+    TCGv_i32 epoch, cur, cflags;
+    TCGv dest_pc, t;
+    int n = db->num_ic;
+
+    if ((tb_cflags(tb) & CF_NO_GOTO_PTR) || n == TB_IC_SLOTS) {
+        tcg_gen_lookup_and_goto_ptr();
+        return;
+    }
+    db->num_ic++;
+
+    plugin_gen_disable_mem_helpers();
+    miss = gen_new_label();
+    slot = tcg_const_ptr(&tb->ic[n]);
+    dest = tcg_temp_new_ptr();
+    code = tcg_temp_local_new_ptr();
+    epoch = tcg_temp_new_i32();
+    cur = tcg_temp_new_i32();
+    cflags = tcg_temp_new_i32();
+    dest_pc = tcg_temp_new();
+    t = tcg_temp_new();
+
+    /*
+     * The slot always points to some TB; whether it is the right one is
+     * decided by a single branch so that nothing but @code needs to
+     * survive it.  Pairs with the barriers in helper_lookup_tb_ptr_ic.
+     */
+    tcg_gen_ld_ptr(dest, slot, offsetof(TBInlineCache, dest));
+    tcg_gen_mb(TCG_MO_LD_LD | TCG_BAR_SC);
+    tcg_gen_ld_i32(epoch, slot, offsetof(TBInlineCache, epoch));
+    tcg_gen_ld_i32(cur, cpu_env, CPU_OFFSET(tb_ic_epoch));
+    tcg_gen_ld_tl(dest_pc, dest, offsetof(TranslationBlock, pc));
+    tcg_gen_ld_i32(cflags, dest, offsetof(TranslationBlock, cflags));
+    tcg_gen_ld_ptr(code, dest, offsetof(TranslationBlock, tc.ptr));
+
+    tcg_gen_setcond_i32(TCG_COND_NE, epoch, epoch, cur);
+    tcg_gen_andi_i32(cflags, cflags, CF_INVALID);
+    tcg_gen_or_i32(epoch, epoch, cflags);
+    tcg_gen_extu_i32_tl(t, epoch);
+    tcg_gen_setcond_tl(TCG_COND_NE, dest_pc, dest_pc, pc);
+    tcg_gen_or_tl(t, t, dest_pc);
+    tcg_gen_brcondi_tl(TCG_COND_NE, t, 0, miss);
+
+    tcg_temp_free(t);
+    tcg_temp_free(dest_pc);
+    tcg_temp_free_i32(cflags);
+    tcg_temp_free_i32(cur);
+    tcg_temp_free_i32(epoch);
+    tcg_temp_free_ptr(dest);
+    tcg_temp_free_ptr(slot);
+
+    /*
+     * Hit: count it and go.  The count lives in CPUState so that a hit
+     * never writes the TB, which all vCPUs running it share.
+     */
+    dest = tcg_temp_new_ptr();
+    tcg_gen_ld_ptr(dest, cpu_env, CPU_OFFSET(tb_ic_hits));
+    tcg_gen_addi_ptr(dest, dest, 1);
+    tcg_gen_st_ptr(dest, cpu_env, CPU_OFFSET(tb_ic_hits));
+    tcg_gen_op1i(INDEX_op_goto_ptr, tcgv_ptr_arg(code));
+    tcg_temp_free_ptr(dest);
+    tcg_temp_free_ptr(code);
+
+    /* Miss: look the TB up and refill the slot. */
+    gen_set_label(miss);
+    slot = tcg_const_ptr(tb);
+    dest = tcg_temp_new_ptr();
+    gen_helper_lookup_tb_ptr_ic(dest, cpu_env, slot, tcg_constant_i32(n));
+    tcg_gen_op1i(INDEX_op_goto_ptr, tcgv_ptr_arg(dest));
+    tcg_temp_free_ptr(dest);
+    tcg_temp_free_ptr(slot);
+}
+
+void translator_ras_push(const DisasContextBase *db, target_ulong ret_pc)
+{
+    TranslationBlock *tb = (TranslationBlock *)db->tb;
+    TCGv_i32 top, off, epoch;
+    TCGv_ptr entry, slot;
+
+    if (tb_cflags(tb) & CF_NO_GOTO_PTR) {
+        return;
+    }
+
+    top = tcg_temp_new_i32();
+    off = tcg_temp_new_i32();
+    epoch = tcg_temp_new_i32();
+    entry = tcg_temp_new_ptr();
+    slot = tcg_const_ptr(&tb->ret_ic);
+
+    tcg_gen_ld_i32(top, cpu_env, CPU_OFFSET(tb_ras.top));
+    tcg_gen_muli_i32(off, top, sizeof(CPUReturnEntry));
+    tcg_gen_ext_i32_ptr(entry, off);
+    tcg_gen_add_ptr(entry, entry, cpu_env);
+    tcg_gen_st_tl(tcg_constant_tl(ret_pc), entry,
+                  CPU_OFFSET(tb_ras.entry[0].pc));
+    tcg_gen_st_ptr(slot, entry, CPU_OFFSET(tb_ras.entry[0].slot));
+    tcg_gen_ld_i32(epoch, cpu_env, CPU_OFFSET(tb_ic_epoch));
+    tcg_gen_st_i32(epoch, entry, CPU_OFFSET(tb_ras.entry[0].epoch));
+    tcg_gen_addi_i32(top, top, 1);
+    tcg_gen_andi_i32(top, top, TB_RAS_SIZE - 1);
+    tcg_gen_st_i32(top, cpu_env, CPU_OFFSET(tb_ras.top));
+
+    tcg_temp_free_ptr(slot);
+    tcg_temp_free_ptr(entry);
+    tcg_temp_free_i32(epoch);
+    tcg_temp_free_i32(off);
+    tcg_temp_free_i32(top);
+}
+
+void translator_ras_return(const DisasContextBase *db, TCGv pc,
+                           TCGv cs_base, uint32_t flags)
+{
+    TranslationBlock *tb = (TranslationBlock *)db->tb;
+    TCGLabel *mispredict, *miss;
+    TCGv_ptr entry, slot, dest, code;
+    TCGv_i32 top, epoch, cur, t32;
+    TCGv lpc, lcs_base, t, t2;
+
+    if (tb_cflags(tb) & CF_NO_GOTO_PTR) {
+        tcg_gen_lookup_and_goto_ptr();
+        return;
+    }
+
+    plugin_gen_disable_mem_helpers();
+    mispredict = gen_new_label();
+    miss = gen_new_label();
+    lpc = tcg_temp_local_new();
+    lcs_base = tcg_temp_local_new();
+    slot = tcg_temp_local_new_ptr();
+    code = tcg_temp_local_new_ptr();
+    tcg_gen_mov_tl(lpc, pc);
+    if (cs_base) {
+        tcg_gen_mov_tl(lcs_base, cs_base);
+    } else {
+        tcg_gen_movi_tl(lcs_base, tb->cs_base);
+    }
+
+    /*
+     * Pop, and check that the entry is still ours and predicts @pc.
+     * A hit skips check_for_breakpoints(), so cpu_breakpoint_insert()
+     * and cpu_single_step() bump tb_ic_epoch to retire every entry.
+     */
+    top = tcg_temp_new_i32();
+    epoch = tcg_temp_new_i32();
+    cur = tcg_temp_new_i32();
+    entry = tcg_temp_new_ptr();
+    t = tcg_temp_new();
+    t2 = tcg_temp_new();
+    tcg_gen_ld_i32(top, cpu_env, CPU_OFFSET(tb_ras.top));
+    tcg_gen_subi_i32(top, top, 1);
+    tcg_gen_andi_i32(top, top, TB_RAS_SIZE - 1);
+    tcg_gen_st_i32(top, cpu_env, CPU_OFFSET(tb_ras.top));
+    tcg_gen_muli_i32(top, top, sizeof(CPUReturnEntry));
+    tcg_gen_ext_i32_ptr(entry, top);
+    tcg_gen_add_ptr(entry, entry, cpu_env);
+    tcg_gen_ld_tl(t, entry, CPU_OFFSET(tb_ras.entry[0].pc));
+    tcg_gen_ld_ptr(slot, entry, CPU_OFFSET(tb_ras.entry[0].slot));
+    tcg_gen_ld_i32(epoch, entry, CPU_OFFSET(tb_ras.entry[0].epoch));
+    tcg_gen_ld_i32(cur, cpu_env, CPU_OFFSET(tb_ic_epoch));
+    tcg_gen_setcond_i32(TCG_COND_NE, epoch, epoch, cur);
+    tcg_gen_extu_i32_tl(t2, epoch);
+    tcg_gen_setcond_tl(TCG_COND_NE, t, t, lpc);
+    tcg_gen_or_tl(t, t, t2);
+    tcg_gen_brcondi_tl(TCG_COND_NE, t, 0, mispredict);
+    tcg_temp_free_ptr(entry);
+
+    /*
+     * The slot may have been filled for any state: check the TB it
+     * points to against the state we are returning with.
+     */
+    dest = tcg_temp_new_ptr();
+    t32 = tcg_temp_new_i32();
+    tcg_gen_ld_ptr(dest, slot, offsetof(TBInlineCache, dest));
+    tcg_gen_mb(TCG_MO_LD_LD | TCG_BAR_SC);
+    tcg_gen_ld_i32(epoch, slot, offsetof(TBInlineCache, epoch));
+    tcg_gen_ld_i32(cur, cpu_env, CPU_OFFSET(tb_ic_epoch));
+    tcg_gen_setcond_i32(TCG_COND_NE, epoch, epoch, cur);
+    tcg_gen_ld_i32(t32, dest, offsetof(TranslationBlock, flags));
+    tcg_gen_setcondi_i32(TCG_COND_NE, t32, t32, flags);
+    tcg_gen_or_i32(epoch, epoch, t32);
+    tcg_gen_ld_i32(t32, dest, offsetof(TranslationBlock, cflags));
+    tcg_gen_xori_i32(t32, t32, tb_cflags(tb));
+    tcg_gen_andi_i32(t32, t32, CF_LOOKUP_MASK);
+    tcg_gen_or_i32(epoch, epoch, t32);
+    tcg_gen_extu_i32_tl(t2, epoch);
+    tcg_gen_ld_tl(t, dest, offsetof(TranslationBlock, pc));
+    tcg_gen_setcond_tl(TCG_COND_NE, t, t, lpc);
+    tcg_gen_or_tl(t2, t2, t);
+    tcg_gen_ld_tl(t, dest, offsetof(TranslationBlock, cs_base));
+    tcg_gen_setcond_tl(TCG_COND_NE, t, t, lcs_base);
+    tcg_gen_or_tl(t2, t2, t);
+    tcg_gen_ld_ptr(code, dest, offsetof(TranslationBlock, tc.ptr));
+    tcg_gen_brcondi_tl(TCG_COND_NE, t2, 0, miss);
+    tcg_temp_free_i32(t32);
+    tcg_temp_free_ptr(dest);
+    tcg_temp_free(t2);
+    tcg_temp_free(t);
+    tcg_temp_free_i32(cur);
+    tcg_temp_free_i32(top);
+    tcg_temp_free_i32(epoch);
+
+    /* Hit: count it, in CPUState as for inline caches, and go. */
+    dest = tcg_temp_new_ptr();
+    tcg_gen_ld_ptr(dest, cpu_env, CPU_OFFSET(tb_ras_hits));
+    tcg_gen_addi_ptr(dest, dest, 1);
+    tcg_gen_st_ptr(dest, cpu_env, CPU_OFFSET(tb_ras_hits));
+    tcg_gen_op1i(INDEX_op_goto_ptr, tcgv_ptr_arg(code));
+    tcg_temp_free_ptr(dest);
+    tcg_temp_free_ptr(code);
+
+    /* Miss: look the TB up and refill the slot. */
+    gen_set_label(miss);
+    dest = tcg_temp_new_ptr();
+    gen_helper_lookup_tb_ptr_ras(dest, cpu_env, slot);
+    tcg_gen_op1i(INDEX_op_goto_ptr, tcgv_ptr_arg(dest));
+
+    /* Mispredict: plain lookup. */
+    gen_set_label(mispredict);
+    entry = tcg_const_ptr(NULL);
+    gen_helper_lookup_tb_ptr_ras(dest, cpu_env, entry);
+    tcg_gen_op1i(INDEX_op_goto_ptr, tcgv_ptr_arg(dest));
+
+    tcg_temp_free_ptr(entry);
+    tcg_temp_free_ptr(dest);
+    tcg_temp_free_ptr(slot);
+    tcg_temp_free(lcs_base);
+    tcg_temp_free(lpc);
+}
+
+/*
+ * Count the entry in this vCPU's slot for @tb and leave through the exit
+ * request path, before any guest state changed, once it reaches
+ * tb->hot_threshold.  The TB itself is shared by all vCPUs and is never
+ * written here.
+ */
+static void gen_tb_hot_count(TranslationBlock *tb)
+{
+    int ofs = CPU_OFFSET(tb_hot) + tb_hot_slot(tb) * sizeof(uint32_t);
+    TCGv_i32 count = tcg_temp_new_i32();
+
+    tcg_gen_ld_i32(count, cpu_env, ofs);
+    tcg_gen_addi_i32(count, count, 1);
+    tcg_gen_st_i32(count, cpu_env, ofs);
+    tcg_gen_brcondi_i32(TCG_COND_GEU, count, tb->hot_threshold,
+                        tcg_ctx->exitreq_label);
+
+    tcg_temp_free_i32(count);
+}
+
+static bool translator_count_hot(const TranslatorOps *ops, uint32_t cflags)
+{
+    if (cflags & (CF_SUPERBLOCK | CF_NO_HOT_MASK)) {
+        return false;
+    }
+    return (cflags & CF_QUICK) || (ops->superblock && tcg_superblock_threshold);
+}
+
 void translator_loop(const TranslatorOps *ops, DisasContextBase *db,
                      CPUState *cpu, TranslationBlock *tb, int max_insns)
 {
@@ -65,6 +340,7 @@ void translator_loop(const TranslatorOps *ops, DisasContextBase *db,
     db->num_insns = 0;
     db->max_insns = max_insns;
     db->singlestep_enabled = cflags & CF_SINGLE_STEP;
+    db->num_ic = 0;
     translator_page_protect(db, db->pc_next);
 
     ops->init_disas_context(db, cpu);
@@ -75,6 +351,11 @@ void translator_loop(const TranslatorOps *ops, DisasContextBase *db,
 
     /* Start translating.  */
     gen_tb_start(db->tb);
+    if (translator_count_hot(ops, cflags)) {
+        tb->hot_threshold = cflags & CF_QUICK ? tcg_tier_up_threshold
+                                              : tcg_superblock_threshold;
+        gen_tb_hot_count(tb);
+    }
     ops->tb_start(db, cpu);
     tcg_debug_assert(db->is_jmp == DISAS_NEXT);  /* no early exit */
 
@@ -1,3 +1,4 @@
 TARGET_ARCH=arc64
 TARGET_BASE_ARCH=arc
+TARGET_SUPPORTS_MTTCG=y
 TARGET_XML_FILES= gdb-xml/arc-v3_64-core.xml gdb-xml/arc-v3_64-aux.xml gdb-xml/arc-v3_64-fpu.xml
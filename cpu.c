@@ -331,6 +331,9 @@ int cpu_breakpoint_insert(CPUState *cpu, vaddr pc, int flags,
         *breakpoint = bp;
     }
 
+    /* Inline cache hits jump past check_for_breakpoints(). */
+    cpu_tb_ic_epoch_bump(cpu);
+
     trace_breakpoint_insert(cpu->cpu_index, pc, flags);
     return 0;
 }
@@ -358,6 +361,7 @@ int cpu_breakpoint_remove(CPUState *cpu, vaddr pc, int flags)
 void cpu_breakpoint_remove_by_ref(CPUState *cpu, CPUBreakpoint *bp)
 {
     QTAILQ_REMOVE(&cpu->breakpoints, bp, entry);
+    cpu_tb_ic_epoch_bump(cpu);
 
     trace_breakpoint_remove(cpu->cpu_index, bp->pc, bp->flags);
     g_free(bp);
@@ -381,6 +385,7 @@ void cpu_single_step(CPUState *cpu, int enabled)
 {
     if (cpu->singlestep_enabled != enabled) {
         cpu->singlestep_enabled = enabled;
+        cpu_tb_ic_epoch_bump(cpu);
         if (kvm_enabled()) {
             kvm_update_guest_debug(cpu, 0);
         }
@@ -20,6 +20,7 @@
 
 #include "qemu/osdep.h"
 #include "qapi/error.h"
+#include "qapi/visitor.h"
 #include "cpu.h"
 #include "hw/hw.h"
 #include "hw/boards.h"
@@ -29,6 +30,7 @@
 #include "hw/loader.h"
 #include "exec/memory.h"
 #include "exec/address-spaces.h"
+#include "qemu/main-loop.h"
 #include "sysemu/reset.h"
 #include "sysemu/runstate.h"
 #include "sysemu/sysemu.h"
@@ -40,12 +42,28 @@
 
 static uint64_t arc_io_read(void *opaque, hwaddr addr, unsigned size)
 {
-    return 0;
+    MachineState *machine = opaque;
+
+    switch (addr) {
+    case 0x10: /* number of cores, for SMP test programs. */
+        return machine->smp.cpus;
+    default:
+        return 0;
+    }
 }
 
+/*
+ * The region is accessed without the global lock: reads only return
+ * constant board information, writes take the lock here.
+ */
 static void arc_io_write(void *opaque, hwaddr addr,
                          uint64_t val, unsigned size)
 {
+    bool unlocked = !qemu_mutex_iothread_locked();
+
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
     switch (addr) {
     case 0x08: /* board reset. */
         qemu_system_reset_request(SHUTDOWN_CAUSE_GUEST_RESET);
@@ -53,6 +71,9 @@ static void arc_io_write(void *opaque, hwaddr addr,
     default:
         break;
     }
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
 }
 
 static const MemoryRegionOps arc_io_ops = {
@@ -81,6 +102,7 @@ static void arc_sim_init(MachineState *machine)
             fprintf(stderr, "Unable to find CPU definition!\n");
             exit(1);
         }
+        cpu->core_id = n;
 
         /* Set the initial CPU properties. */
         object_property_set_uint(OBJECT(cpu), "freq_hz", 1000000, &error_fatal);
@@ -99,8 +121,9 @@ static void arc_sim_init(MachineState *machine)
     memory_region_add_subregion(get_system_memory(), ram_base, ram);
 
     system_io = g_new(MemoryRegion, 1);
-    memory_region_init_io(system_io, NULL, &arc_io_ops, NULL, "arc.io",
+    memory_region_init_io(system_io, NULL, &arc_io_ops, machine, "arc.io",
                            1024);
+    memory_region_clear_global_locking(system_io);
     memory_region_add_subregion(get_system_memory(), 0xf0000000, system_io);
 
     if (semihosting_enabled()) {
@@ -115,14 +138,59 @@ static void arc_sim_init(MachineState *machine)
     arc_load_kernel(cpu, &boot_info);
 }
 
+static char *arc_sim_get_semi_flush(Object *obj, Error **errp)
+{
+    return g_strdup(arc_semihosting_get_flush());
+}
+
+static void arc_sim_set_semi_flush(Object *obj, const char *value,
+                                   Error **errp)
+{
+    arc_semihosting_set_flush(value, errp);
+}
+
+static void arc_sim_get_semi_bufsize(Object *obj, Visitor *v,
+                                     const char *name, void *opaque,
+                                     Error **errp)
+{
+    uint64_t value = arc_semihosting_get_bufsize();
+
+    visit_type_size(v, name, &value, errp);
+}
+
+static void arc_sim_set_semi_bufsize(Object *obj, Visitor *v,
+                                     const char *name, void *opaque,
+                                     Error **errp)
+{
+    uint64_t value;
+
+    if (visit_type_size(v, name, &value, errp)) {
+        arc_semihosting_set_bufsize(value, errp);
+    }
+}
+
 static void arc_sim_machine_init(MachineClass *mc)
 {
     mc->desc = "ARCxx simulation";
     mc->init = arc_sim_init;
-    mc->max_cpus = 1;
+    mc->max_cpus = 32;
     mc->is_default = false;
     mc->no_serial = 1;
     mc->default_cpu_type = ARC_CPU_TYPE_NAME("archs");
+
+    object_class_property_add_str(OBJECT_CLASS(mc), "semihosting-flush",
+                                  arc_sim_get_semi_flush,
+                                  arc_sim_set_semi_flush);
+    object_class_property_set_description(OBJECT_CLASS(mc),
+        "semihosting-flush",
+        "When buffered semihosting stdout/stderr is flushed: "
+        "none (unbuffered), line or full");
+    object_class_property_add(OBJECT_CLASS(mc), "semihosting-bufsize", "size",
+                              arc_sim_get_semi_bufsize,
+                              arc_sim_set_semi_bufsize, NULL, NULL);
+    object_class_property_set_description(OBJECT_CLASS(mc),
+        "semihosting-bufsize",
+        "Size of the semihosting stdout/stderr buffers");
 }
 
 DEFINE_MACHINE("arc-sim", arc_sim_machine_init)
@@ -69,6 +69,7 @@ void arc_load_kernel(ARCCPU *cpu, struct arc_boot_info *info)
 {
     hwaddr entry;
     int elf_machine, kernel_size;
+    CPUState *cs;
 
     if (!info->kernel_filename) {
         error_report("missing kernel file");
@@ -98,10 +99,14 @@ void arc_load_kernel(ARCCPU *cpu, struct arc_boot_info *info)
         exit(EXIT_FAILURE);
     }
 
-    cpu->env.boot_info = info;
-
-    /* Set CPU's PC to point to the entry-point */
-    cpu->env.pc = entry;
+    /*
+     * Every core starts at the entry-point; software tells them apart by
+     * IDENTITY.ARCNUM.
+     */
+    CPU_FOREACH(cs) {
+        ARC_CPU(cs)->env.boot_info = info;
+        ARC_CPU(cs)->env.pc = entry;
+    }
 }
 
 
@@ -28,6 +28,7 @@
 #include "chardev/char-fe.h"
 #include "chardev/char-serial.h"
 #include "qemu/log.h"
+#include "qemu/main-loop.h"
 #include "qemu/module.h"
 #include "trace.h"
 
@@ -81,8 +82,8 @@ static void pl011_update(PL011State *s)
     }
 }
 
-static uint64_t pl011_read(void *opaque, hwaddr offset,
-                           unsigned size)
+static uint64_t pl011_read_locked(void *opaque, hwaddr offset,
+                                  unsigned size)
 {
     PL011State *s = (PL011State *)opaque;
     uint32_t c;
@@ -191,8 +192,8 @@ static void pl011_trace_baudrate_change(const PL011State *s)
                                 s->ibrd, s->fbrd);
 }
 
-static void pl011_write(void *opaque, hwaddr offset,
-                        uint64_t value, unsigned size)
+static void pl011_write_locked(void *opaque, hwaddr offset,
+                               uint64_t value, unsigned size)
 {
     PL011State *s = (PL011State *)opaque;
     unsigned char ch;
@@ -322,6 +323,47 @@ static void pl011_clock_update(void *opaque, ClockEvent event)
     pl011_trace_baudrate_change(s);
 }
 
+/*
+ * The register window is accessed without the global lock.  The flag
+ * register is polled by drivers while transmitting and has no read side
+ * effects, so it is read atomically; all other registers take the lock.
+ */
+static uint64_t pl011_read(void *opaque, hwaddr offset, unsigned size)
+{
+    PL011State *s = (PL011State *)opaque;
+    bool unlocked = !qemu_mutex_iothread_locked();
+    uint64_t r;
+
+    if ((offset >> 2) == 6 && unlocked) {
+        r = qatomic_read(&s->flags);
+        trace_pl011_read(offset, r);
+        return r;
+    }
+
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    r = pl011_read_locked(opaque, offset, size);
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
+    return r;
+}
+
+static void pl011_write(void *opaque, hwaddr offset,
+                        uint64_t value, unsigned size)
+{
+    bool unlocked = !qemu_mutex_iothread_locked();
+
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    pl011_write_locked(opaque, offset, value, size);
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
+}
+
 static const MemoryRegionOps pl011_ops = {
     .read = pl011_read,
     .write = pl011_write,
@@ -388,6 +430,7 @@ static void pl011_init(Object *obj)
     int i;
 
     memory_region_init_io(&s->iomem, OBJECT(s), &pl011_ops, s, "pl011", 0x1000);
+    memory_region_clear_global_locking(&s->iomem);
     sysbus_init_mmio(sbd, &s->iomem);
     for (i = 0; i < ARRAY_SIZE(s->irq); i++) {
         sysbus_init_irq(sbd, &s->irq[i]);
@@ -80,6 +80,7 @@ static void serial_isa_realizefn(DeviceState *dev, Error **errp)
     qdev_set_legacy_instance_id(dev, isa->iobase, 3);
 
     memory_region_init_io(&s->io, OBJECT(isa), &serial_io_ops, s, "serial", 8);
+    memory_region_clear_global_locking(&s->io);
     isa_register_ioport(isadev, &s->io, isa->iobase);
 }
 
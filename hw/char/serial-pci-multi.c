@@ -114,6 +114,7 @@ static void multi_serial_pci_realize(PCIDevice *dev, Error **errp)
         pci->name[i] = g_strdup_printf("uart #%zu", i + 1);
         memory_region_init_io(&s->io, OBJECT(pci), &serial_io_ops, s,
                               pci->name[i], 8);
+        memory_region_clear_global_locking(&s->io);
         memory_region_add_subregion(&pci->iobar, 8 * i, &s->io);
         pci->ports++;
     }
@@ -58,6 +58,7 @@ static void serial_pci_realize(PCIDevice *dev, Error **errp)
     s->irq = pci_allocate_irq(&pci->dev);
 
     memory_region_init_io(&s->io, OBJECT(pci), &serial_io_ops, s, "serial", 8);
+    memory_region_clear_global_locking(&s->io);
     pci_register_bar(&pci->dev, 0, PCI_BASE_ADDRESS_SPACE_IO, &s->io);
 }
 
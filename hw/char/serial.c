@@ -31,6 +31,7 @@
 #include "chardev/char-serial.h"
 #include "qapi/error.h"
 #include "qemu/timer.h"
+#include "qemu/main-loop.h"
 #include "sysemu/reset.h"
 #include "sysemu/runstate.h"
 #include "qemu/error-report.h"
@@ -329,8 +330,8 @@ static void serial_update_tiocm(SerialState *s)
     qemu_chr_fe_ioctl(&s->chr, CHR_IOCTL_SERIAL_SET_TIOCM, &flags);
 }
 
-static void serial_ioport_write(void *opaque, hwaddr addr, uint64_t val,
-                                unsigned size)
+static void serial_ioport_write_locked(void *opaque, hwaddr addr,
+                                       uint64_t val, unsigned size)
 {
     SerialState *s = opaque;
 
@@ -466,7 +467,8 @@ static void serial_ioport_write(void *opaque, hwaddr addr, uint64_t val,
     }
 }
 
-static uint64_t serial_ioport_read(void *opaque, hwaddr addr, unsigned size)
+static uint64_t serial_ioport_read_locked(void *opaque, hwaddr addr,
+                                          unsigned size)
 {
     SerialState *s = opaque;
     uint32_t ret;
@@ -552,6 +554,50 @@ static uint64_t serial_ioport_read(void *opaque, hwaddr addr, unsigned size)
     return ret;
 }
 
+/*
+ * The register window is accessed without the global lock.  Drivers spin
+ * on the line status register while transmitting, so it is read without
+ * the lock unless the read has to clear break or overrun status.
+ */
+static uint64_t serial_ioport_read(void *opaque, hwaddr addr, unsigned size)
+{
+    SerialState *s = opaque;
+    bool unlocked = !qemu_mutex_iothread_locked();
+    uint64_t ret;
+
+    if (addr == 5 && unlocked) {
+        uint8_t lsr = qatomic_read(&s->lsr);
+
+        if (!(lsr & (UART_LSR_BI | UART_LSR_OE))) {
+            trace_serial_read(addr, lsr);
+            return lsr;
+        }
+    }
+
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    ret = serial_ioport_read_locked(opaque, addr, size);
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
+    return ret;
+}
+
+static void serial_ioport_write(void *opaque, hwaddr addr, uint64_t val,
+                                unsigned size)
+{
+    bool unlocked = !qemu_mutex_iothread_locked();
+
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    serial_ioport_write_locked(opaque, addr, val, size);
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
+}
+
 static int serial_can_receive(SerialState *s)
 {
     if(s->fcr & UART_FCR_FE) {
@@ -1045,6 +1091,7 @@ static void serial_mm_realize(DeviceState *dev, Error **errp)
     memory_region_init_io(&s->io, OBJECT(dev),
                           &serial_mm_ops[smm->endianness], smm, "serial",
                           8 << smm->regshift);
+    memory_region_clear_global_locking(&s->io);
     sysbus_init_mmio(SYS_BUS_DEVICE(smm), &s->io);
     sysbus_init_irq(SYS_BUS_DEVICE(smm), &smm->serial.irq);
 }
@@ -49,6 +49,9 @@ CPUState *cpu_by_arch_id(int64_t id)
     return NULL;
 }
 
+/* Source of CPUState::tb_ic_epoch values, see cpu_tb_ic_epoch_bump(). */
+uint32_t tb_ic_epoch_next;
+
 bool cpu_exists(int64_t id)
 {
     return !!cpu_by_arch_id(id);
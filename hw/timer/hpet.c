@@ -30,6 +30,8 @@
 #include "qapi/error.h"
 #include "qemu/error-report.h"
 #include "qemu/timer.h"
+#include "qemu/main-loop.h"
+#include "qemu/seqlock.h"
 #include "hw/timer/hpet.h"
 #include "hw/sysbus.h"
 #include "hw/rtc/mc146818rtc.h"
@@ -88,6 +90,12 @@ struct HPETState {
     uint64_t isr;               /* interrupt status reg */
     uint64_t hpet_counter;      /* main counter */
     uint8_t  hpet_id;           /* instance id */
+
+    /*
+     * Guards config, hpet_offset and hpet_counter for counter reads done
+     * outside the global lock; writers hold the global lock.
+     */
+    QemuSeqLock counter_lock;
 };
 
 static uint32_t hpet_in_legacy_mode(HPETState *s)
@@ -226,7 +234,9 @@ static int hpet_pre_save(void *opaque)
 
     /* save current counter value */
     if (hpet_enabled(s)) {
+        seqlock_write_begin(&s->counter_lock);
         s->hpet_counter = hpet_get_ticks(s);
+        seqlock_write_end(&s->counter_lock);
     }
 
     return 0;
@@ -259,8 +269,10 @@ static int hpet_post_load(void *opaque, int version_id)
 
     /* Recalculate the offset between the main counter and guest time */
     if (!s->hpet_offset_saved) {
+        seqlock_write_begin(&s->counter_lock);
         s->hpet_offset = ticks_to_ns(s->hpet_counter)
                         - qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+        seqlock_write_end(&s->counter_lock);
     }
 
     /* Push number of timers into capability returned via HPET_ID */
@@ -417,8 +429,8 @@ static void hpet_del_timer(HPETTimer *t)
     update_irq(t, 0);
 }
 
-static uint64_t hpet_ram_read(void *opaque, hwaddr addr,
-                              unsigned size)
+static uint64_t hpet_ram_read_locked(void *opaque, hwaddr addr,
+                                     unsigned size)
 {
     HPETState *s = opaque;
     uint64_t cur_tick, index;
@@ -489,8 +501,8 @@ static uint64_t hpet_ram_read(void *opaque, hwaddr addr,
     return 0;
 }
 
-static void hpet_ram_write(void *opaque, hwaddr addr,
-                           uint64_t value, unsigned size)
+static void hpet_ram_write_locked(void *opaque, hwaddr addr,
+                                  uint64_t value, unsigned size)
 {
     int i;
     HPETState *s = opaque;
@@ -499,7 +511,7 @@ static void hpet_ram_write(void *opaque, hwaddr addr,
     DPRINTF("qemu: Enter hpet_ram_writel at %" PRIx64 " = 0x%" PRIx64 "\n",
             addr, value);
     index = addr;
-    old_val = hpet_ram_read(opaque, addr, 4);
+    old_val = hpet_ram_read_locked(opaque, addr, 4);
     new_val = value;
 
     /*address range of all TN regs*/
@@ -658,6 +670,59 @@ static void hpet_ram_write(void *opaque, hwaddr addr,
     }
 }
 
+/*
+ * The main counter is polled by guests as a clocksource, so it is read
+ * without the global lock.  All other registers take it.
+ */
+static uint64_t hpet_ram_read(void *opaque, hwaddr addr, unsigned size)
+{
+    HPETState *s = opaque;
+    bool unlocked;
+    uint64_t val;
+
+    if (addr == HPET_COUNTER || addr == HPET_COUNTER + 4) {
+        uint64_t cur_tick;
+        unsigned start;
+
+        do {
+            start = seqlock_read_begin(&s->counter_lock);
+            if (hpet_enabled(s)) {
+                cur_tick = hpet_get_ticks(s);
+            } else {
+                cur_tick = s->hpet_counter;
+            }
+        } while (seqlock_read_retry(&s->counter_lock, start));
+        return addr == HPET_COUNTER ? cur_tick : cur_tick >> 32;
+    }
+
+    unlocked = !qemu_mutex_iothread_locked();
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    val = hpet_ram_read_locked(opaque, addr, size);
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
+    return val;
+}
+
+static void hpet_ram_write(void *opaque, hwaddr addr,
+                           uint64_t value, unsigned size)
+{
+    HPETState *s = opaque;
+    bool unlocked = !qemu_mutex_iothread_locked();
+
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    seqlock_write_begin(&s->counter_lock);
+    hpet_ram_write_locked(opaque, addr, value, size);
+    seqlock_write_end(&s->counter_lock);
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
+}
+
 static const MemoryRegionOps hpet_ram_ops = {
     .read = hpet_ram_read,
     .write = hpet_ram_write,
@@ -690,9 +755,11 @@ static void hpet_reset(DeviceState *d)
     }
 
     qemu_set_irq(s->pit_enabled, 1);
+    seqlock_write_begin(&s->counter_lock);
     s->hpet_counter = 0ULL;
     s->hpet_offset = 0ULL;
     s->config = 0ULL;
+    seqlock_write_end(&s->counter_lock);
     hpet_cfg.hpet[s->hpet_id].event_timer_block_id = (uint32_t)s->capability;
     hpet_cfg.hpet[s->hpet_id].address = sbd->mmio[0].addr;
 
@@ -722,7 +789,9 @@ static void hpet_init(Object *obj)
     HPETState *s = HPET(obj);
 
     /* HPET Area */
+    seqlock_init(&s->counter_lock);
     memory_region_init_io(&s->iomem, obj, &hpet_ram_ops, s, "hpet", HPET_LEN);
+    memory_region_clear_global_locking(&s->iomem);
     sysbus_init_mmio(sbd, &s->iomem);
 }
 
@@ -27,6 +27,7 @@
 #include "hw/virtio/virtio.h"
 #include "migration/qemu-file-types.h"
 #include "qemu/host-utils.h"
+#include "qemu/main-loop.h"
 #include "qemu/module.h"
 #include "sysemu/kvm.h"
 #include "sysemu/replay.h"
@@ -81,9 +82,9 @@ static void virtio_mmio_soft_reset(VirtIOMMIOProxy *proxy)
     }
 }
 
-static uint64_t virtio_mmio_read(void *opaque, hwaddr offset, unsigned size)
+static uint64_t virtio_mmio_read_locked(VirtIOMMIOProxy *proxy,
+                                        hwaddr offset, unsigned size)
 {
-    VirtIOMMIOProxy *proxy = (VirtIOMMIOProxy *)opaque;
     VirtIODevice *vdev = virtio_bus_get_device(&proxy->bus);
 
     trace_virtio_mmio_read(offset);
@@ -243,10 +244,9 @@ static uint64_t virtio_mmio_read(void *opaque, hwaddr offset, unsigned size)
     return 0;
 }
 
-static void virtio_mmio_write(void *opaque, hwaddr offset, uint64_t value,
-                              unsigned size)
+static void virtio_mmio_write_locked(VirtIOMMIOProxy *proxy, hwaddr offset,
+                                     uint64_t value, unsigned size)
 {
-    VirtIOMMIOProxy *proxy = (VirtIOMMIOProxy *)opaque;
     VirtIODevice *vdev = virtio_bus_get_device(&proxy->bus);
 
     trace_virtio_mmio_write_offset(offset, value);
@@ -516,6 +516,50 @@ static void virtio_mmio_write(void *opaque, hwaddr offset, uint64_t value,
     }
 }
 
+/*
+ * The register window is accessed without the global lock.  Drivers poll
+ * the interrupt status, which is read atomically; every other register
+ * is handled with the lock taken here.  Queue notifications bound to an
+ * ioeventfd never get this far.
+ */
+static uint64_t virtio_mmio_read(void *opaque, hwaddr offset, unsigned size)
+{
+    VirtIOMMIOProxy *proxy = (VirtIOMMIOProxy *)opaque;
+    bool unlocked = !qemu_mutex_iothread_locked();
+    uint64_t ret;
+
+    if (offset == VIRTIO_MMIO_INTERRUPT_STATUS && size == 4 && unlocked) {
+        VirtIODevice *vdev = virtio_bus_get_device(&proxy->bus);
+
+        trace_virtio_mmio_read(offset);
+        return vdev ? qatomic_read(&vdev->isr) : 0;
+    }
+
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    ret = virtio_mmio_read_locked(proxy, offset, size);
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
+    return ret;
+}
+
+static void virtio_mmio_write(void *opaque, hwaddr offset, uint64_t value,
+                              unsigned size)
+{
+    VirtIOMMIOProxy *proxy = (VirtIOMMIOProxy *)opaque;
+    bool unlocked = !qemu_mutex_iothread_locked();
+
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    virtio_mmio_write_locked(proxy, offset, value, size);
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
+}
+
 static const MemoryRegionOps virtio_legacy_mem_ops = {
     .read = virtio_mmio_read,
     .write = virtio_mmio_write,
@@ -753,6 +797,7 @@ static void virtio_mmio_realizefn(DeviceState *d, Error **errp)
                               &virtio_mem_ops, proxy,
                               TYPE_VIRTIO_MMIO, 0x200);
     }
+    memory_region_clear_global_locking(&proxy->iomem);
     sysbus_init_mmio(sbd, &proxy->iomem);
 }
 
@@ -29,6 +29,7 @@
 #include "qemu/error-report.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
+#include "qemu/main-loop.h"
 #include "hw/pci/msi.h"
 #include "hw/pci/msix.h"
 #include "hw/loader.h"
@@ -1371,30 +1372,40 @@ static uint64_t virtio_pci_notify_read(void *opaque, hwaddr addr,
     return 0;
 }
 
-static void virtio_pci_notify_write(void *opaque, hwaddr addr,
-                                    uint64_t val, unsigned size)
+/*
+ * The notify regions are accessed without the global lock, so that kicks
+ * bound to an ioeventfd are signalled without it.  Kicks that reach the
+ * device are processed with the lock taken here.
+ */
+static void virtio_pci_queue_notify(VirtIOPCIProxy *proxy, unsigned queue)
 {
-    VirtIOPCIProxy *proxy = opaque;
-    VirtIODevice *vdev = virtio_bus_get_device(&proxy->bus);
-
-    unsigned queue = addr / virtio_pci_queue_mem_mult(proxy);
+    bool unlocked = !qemu_mutex_iothread_locked();
+    VirtIODevice *vdev;
 
+    if (unlocked) {
+        qemu_mutex_lock_iothread();
+    }
+    vdev = virtio_bus_get_device(&proxy->bus);
     if (vdev != NULL && queue < VIRTIO_QUEUE_MAX) {
         virtio_queue_notify(vdev, queue);
     }
+    if (unlocked) {
+        qemu_mutex_unlock_iothread();
+    }
 }
 
-static void virtio_pci_notify_write_pio(void *opaque, hwaddr addr,
-                                        uint64_t val, unsigned size)
+static void virtio_pci_notify_write(void *opaque, hwaddr addr,
+                                    uint64_t val, unsigned size)
 {
     VirtIOPCIProxy *proxy = opaque;
-    VirtIODevice *vdev = virtio_bus_get_device(&proxy->bus);
 
-    unsigned queue = val;
+    virtio_pci_queue_notify(proxy, addr / virtio_pci_queue_mem_mult(proxy));
+}
 
-    if (vdev != NULL && queue < VIRTIO_QUEUE_MAX) {
-        virtio_queue_notify(vdev, queue);
-    }
+static void virtio_pci_notify_write_pio(void *opaque, hwaddr addr,
+                                        uint64_t val, unsigned size)
+{
+    virtio_pci_queue_notify(opaque, val);
 }
 
 static uint64_t virtio_pci_isr_read(void *opaque, hwaddr addr,
@@ -1546,6 +1557,7 @@ static void virtio_pci_modern_regions_init(VirtIOPCIProxy *proxy,
                           proxy,
                           name->str,
                           proxy->notify.size);
+    memory_region_clear_global_locking(&proxy->notify.mr);
 
     g_string_printf(name, "virtio-pci-notify-pio-%s", vdev_name);
     memory_region_init_io(&proxy->notify_pio.mr, OBJECT(proxy),
@@ -1553,6 +1565,7 @@ static void virtio_pci_modern_regions_init(VirtIOPCIProxy *proxy,
                           proxy,
                           name->str,
                           proxy->notify_pio.size);
+    memory_region_clear_global_locking(&proxy->notify_pio.mr);
 }
 
 static void virtio_pci_modern_region_map(VirtIOPCIProxy *proxy,
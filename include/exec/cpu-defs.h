@@ -76,8 +76,15 @@ typedef uint64_t target_ulong;
 
 #if !defined(CONFIG_USER_ONLY) && defined(CONFIG_TCG)
 
-/* use a fully associative victim tlb of 8 entries */
-#define CPU_VTLB_SIZE 8
+/*
+ * use a fully associative victim tlb, sized along with the main tlb
+ * from CPU_VTLB_MIN_SIZE to CPU_VTLB_MAX_SIZE entries
+ */
+#define CPU_VTLB_MIN_SIZE 8
+#define CPU_VTLB_MAX_SIZE 64
+
+/* number of separate large-page areas tracked per mmu_idx */
+#define CPU_TLB_LARGE_PAGES 4
 
 #if HOST_LONG_BITS == 32 && TARGET_LONG_BITS == 32
 #define CPU_TLB_ENTRY_BITS 4
@@ -154,15 +161,20 @@ typedef struct CPUIOTLBEntry {
  * Data elements that are per MMU mode, minus the bits accessed by
  * the TCG fast path.
  */
+typedef struct CPUTLBLargePage {
+    target_ulong addr;
+    target_ulong mask;
+} CPUTLBLargePage;
+
 typedef struct CPUTLBDesc {
     /*
-     * Describe a region covering all of the large pages allocated
-     * into the tlb.  When any page within this region is flushed,
-     * we must flush the entire tlb.  The region is matched if
-     * (addr & large_page_mask) == large_page_addr.
+     * Describe regions covering all of the large pages allocated
+     * into the tlb.  When any page within one of these regions is
+     * flushed, we must flush every entry of that region.  Region i
+     * is matched if (addr & large_page[i].mask) == large_page[i].addr.
      */
-    target_ulong large_page_addr;
-    target_ulong large_page_mask;
+    CPUTLBLargePage large_page[CPU_TLB_LARGE_PAGES];
+    unsigned n_large_pages;
     /* host time (in ns) at the beginning of the time window */
     int64_t window_begin_ns;
     /* maximum number of entries observed in the window */
@@ -170,9 +182,10 @@ typedef struct CPUTLBDesc {
     size_t n_used_entries;
     /* The next index to use in the tlb victim table.  */
     size_t vindex;
-    /* The tlb victim table, in two parts.  */
-    CPUTLBEntry vtable[CPU_VTLB_SIZE];
-    CPUIOTLBEntry viotlb[CPU_VTLB_SIZE];
+    /* The tlb victim table, in two parts, of vtlb_size entries.  */
+    size_t vtlb_size;
+    CPUTLBEntry *vtable;
+    CPUIOTLBEntry *viotlb;
     /* The iotlb.  */
     CPUIOTLBEntry *iotlb;
 } CPUTLBDesc;
@@ -208,6 +221,14 @@ typedef struct CPUTLBCommon {
     size_t full_flush_count;
     size_t part_flush_count;
     size_t elide_flush_count;
+    size_t coalesced_flush_count;
+    /*
+     * Page and range flushes requested by other vCPUs, pushed and
+     * drained locklessly, see tlb_inval_post().
+     */
+    QSLIST_HEAD(, TLBInvalidation) inval_queue;
+    /* A drain of inval_queue is queued as safe work.  */
+    bool inval_safe_pending;
 } CPUTLBCommon;
 
 /*
@@ -459,6 +459,20 @@ struct tb_tc {
     size_t size;
 };
 
+/*
+ * Inline cache for an indirect jump out of a TB, see
+ * translator_lookup_and_goto_ptr().  @dest always points to a TB so that
+ * generated code can dereference it unconditionally; an empty slot points
+ * to tb_ic_empty, which is permanently CF_INVALID.  @epoch ties the entry
+ * to the vCPU that filled it and to the state of its jump cache.
+ */
+#define TB_IC_SLOTS 2
+
+typedef struct TBInlineCache {
+    TranslationBlock *dest;
+    uint32_t epoch;
+} TBInlineCache;
+
 struct TranslationBlock {
     target_ulong pc;   /* simulated PC corresponding to this block (EIP + CS base) */
     target_ulong cs_base; /* CS base for this block */
@@ -470,6 +484,8 @@ struct TranslationBlock {
 #define CF_NO_GOTO_TB    0x00000200 /* Do not chain with goto_tb */
 #define CF_NO_GOTO_PTR   0x00000400 /* Do not chain with goto_ptr */
 #define CF_SINGLE_STEP   0x00000800 /* gdbstub single-step in effect */
+#define CF_SUPERBLOCK    0x00001000 /* Hot TB retranslated across jumps */
+#define CF_QUICK         0x00002000 /* Not optimized until it turns hot */
 #define CF_LAST_IO       0x00008000 /* Last insn may be an IO access.  */
 #define CF_MEMI_ONLY     0x00010000 /* Only instrument memory ops */
 #define CF_USE_ICOUNT    0x00020000
@@ -532,8 +548,32 @@ struct TranslationBlock {
     uintptr_t jmp_list_head;
     uintptr_t jmp_list_next[2];
     uintptr_t jmp_dest[2];
+
+    /*
+     * Entries by one vCPU before the TB is retranslated, either with the
+     * optimizer for a CF_QUICK TB or else as a superblock, when
+     * -accel tcg,tier-up-threshold or superblock-threshold is set; 0 if
+     * the TB is not counted.  The count itself is kept in the vCPU, see
+     * tb_hot_slot() and tb_retranslate_hot().
+     */
+    uint32_t hot_threshold;
+
+    /* Indirect jump sites of this TB, filled by helper_lookup_tb_ptr_ic. */
+    TBInlineCache ic[TB_IC_SLOTS];
+    /* Where calls made by this TB return to, see translator_ras_push(). */
+    TBInlineCache ret_ic;
 };
 
+/*
+ * CF_SUPERBLOCK and CF_QUICK only change how a TB was translated, not
+ * what it computes, so they take no part in TB lookup.
+ */
+#define CF_LOOKUP_MASK   (~(CF_SUPERBLOCK | CF_QUICK))
+
+/* TBs translated with any of these are never retranslated when hot. */
+#define CF_NO_HOT_MASK   (CF_COUNT_MASK | CF_NO_GOTO_TB | CF_SINGLE_STEP | \
+                          CF_LAST_IO | CF_USE_ICOUNT | CF_NOIRQ)
+
 /* Hide the qatomic_read to make code a little easier on the eyes */
 static inline uint32_t tb_cflags(const TranslationBlock *tb)
 {
@@ -543,6 +583,17 @@ static inline uint32_t tb_cflags(const TranslationBlock *tb)
 /* current cflags for hashing/comparison */
 uint32_t curr_cflags(CPUState *cpu);
 
+/*
+ * Slot of CPUState::tb_hot counting the entries into @tb.  TBs sharing a
+ * slot share the count, which only makes them look hotter than they are.
+ */
+static inline unsigned int tb_hot_slot(const TranslationBlock *tb)
+{
+    uintptr_t h = (uintptr_t)tb >> 6;
+
+    return (h ^ (h >> TB_HOT_BITS)) & (TB_HOT_SLOTS - 1);
+}
+
 /* TranslationBlock invalidate API */
 #if defined(CONFIG_USER_ONLY)
 void tb_invalidate_phys_addr(target_ulong addr);
@@ -64,6 +64,7 @@ typedef enum DisasJumpType {
  * @num_insns: Number of translated instructions (including current).
  * @max_insns: Maximum number of instructions to be translated in this TB.
  * @singlestep_enabled: "Hardware" single stepping enabled.
+ * @num_ic: Number of inline cache slots of this TB in use.
  *
  * Architecture-agnostic disassembly context.
  */
@@ -75,6 +76,7 @@ typedef struct DisasContextBase {
     int num_insns;
     int max_insns;
     bool singlestep_enabled;
+    int num_ic;
 #ifdef CONFIG_USER_ONLY
     /*
      * Guest address of the last byte of the last protected page.
@@ -111,6 +113,10 @@ typedef struct DisasContextBase {
  *
  * @disas_log:
  *      Print instruction disassembly to log.
+ *
+ * @superblock:
+ *      The target folds jumps into superblocks through
+ *      translator_follow_jump(), so hot TBs are worth retranslating.
  */
 typedef struct TranslatorOps {
     void (*init_disas_context)(DisasContextBase *db, CPUState *cpu);
@@ -119,6 +125,7 @@ typedef struct TranslatorOps {
     void (*translate_insn)(DisasContextBase *db, CPUState *cpu);
     void (*tb_stop)(DisasContextBase *db, CPUState *cpu);
     void (*disas_log)(const DisasContextBase *db, CPUState *cpu);
+    bool superblock;
 } TranslatorOps;
 
 /**
@@ -156,6 +163,63 @@ void translator_loop_temp_check(DisasContextBase *db);
  */
 bool translator_use_goto_tb(DisasContextBase *db, target_ulong dest);
 
+/**
+ * translator_follow_jump
+ * @db: Disassembly context
+ * @next: pc following the jump instruction
+ * @dest: target pc of an unconditional direct jump
+ *
+ * Return true if translation may carry on at @dest rather than end the
+ * TB with a jump, i.e. if the TB is a superblock and @dest is ahead of
+ * @next on the first page of the TB.  Only jumping forward keeps every
+ * translated instruction inside [pc_first, pc_first + tb->size), which
+ * is what TB invalidation looks at.  The caller is responsible for any
+ * page bound it keeps in terms of instruction counts.
+ */
+bool translator_follow_jump(DisasContextBase *db, target_ulong next,
+                            target_ulong dest);
+
+/**
+ * translator_lookup_and_goto_ptr
+ * @db: Disassembly context
+ * @pc: pc the jump is going to, as cpu_get_tb_cpu_state() will report it
+ *
+ * Like tcg_gen_lookup_and_goto_ptr(), but give the jump a slot in the
+ * TB's inline cache: the TB last reached from here is jumped to without
+ * calling out of generated code as long as @pc matches.  Only use this
+ * if the cs_base and flags of the current cpu state, at this point of
+ * the TB, are known to be those the TB was translated for.  Falls back
+ * to tcg_gen_lookup_and_goto_ptr() when out of slots.
+ */
+void translator_lookup_and_goto_ptr(DisasContextBase *db, TCGv pc);
+
+/**
+ * translator_ras_push
+ * @db: Disassembly context
+ * @ret_pc: pc the call returns to
+ *
+ * Push @ret_pc on the shadow return stack of the vCPU, for a guest call
+ * instruction.  Pairs with translator_ras_return(); the stack is only a
+ * prediction, so unbalanced pushes and pops cost speed, not correctness.
+ */
+void translator_ras_push(const DisasContextBase *db, target_ulong ret_pc);
+
+/**
+ * translator_ras_return
+ * @db: Disassembly context
+ * @pc: pc the return is going to
+ * @cs_base: cs_base of the cpu state after the return, or NULL if it is
+ *           that of the current TB
+ * @flags: TB flags of the cpu state after the return
+ *
+ * End the TB with a guest return.  If @pc is the top of the shadow
+ * return stack, jump to the TB last reached by returning to the call
+ * that pushed it, provided it was translated for @cs_base and @flags.
+ * Otherwise look the TB up like tcg_gen_lookup_and_goto_ptr().
+ */
+void translator_ras_return(const DisasContextBase *db, TCGv pc,
+                           TCGv cs_base, uint32_t flags);
+
 /*
  * Translator Load Functions
  *
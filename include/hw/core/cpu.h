@@ -233,6 +233,30 @@ struct hvf_vcpu_state;
 #define TB_JMP_CACHE_BITS 12
 #define TB_JMP_CACHE_SIZE (1 << TB_JMP_CACHE_BITS)
 
+/* Per-vCPU execution counters of hot TB detection, see tb_hot_slot(). */
+#define TB_HOT_BITS 8
+#define TB_HOT_SLOTS (1 << TB_HOT_BITS)
+
+#define TB_RAS_SIZE 16
+
+/*
+ * Return addresses pushed by guest calls, only ever touched by generated
+ * code.  An entry is valid while @epoch matches CPUState::tb_ic_epoch;
+ * @pc is accessed with the width of target_ulong.
+ */
+typedef struct CPUReturnEntry {
+    uint64_t pc;
+    void *slot;             /* TBInlineCache of the calling TB */
+    uint32_t epoch;
+} CPUReturnEntry;
+
+typedef struct CPUReturnStack {
+    CPUReturnEntry entry[TB_RAS_SIZE];
+    uint32_t top;
+} CPUReturnStack;
+
+struct TBTierUpQueue;
+
 /* work queue */
 
 /* The union type allows passing of 64 bit target pointers on 32 bit
@@ -363,6 +387,22 @@ struct CPUState {
 
     /* Accessed in parallel; all accesses must be atomic */
     TranslationBlock *tb_jmp_cache[TB_JMP_CACHE_SIZE];
+    /*
+     * Bumped whenever tb_jmp_cache loses entries, so that TB inline
+     * caches filled by this vCPU stop matching.  Never 0 after reset.
+     */
+    uint32_t tb_ic_epoch;
+    /* Inline cache statistics, only written by this vCPU. */
+    size_t tb_ic_hits;
+    size_t tb_ic_misses;
+    /* Shadow return stack of generated code, see translator_ras_push(). */
+    CPUReturnStack tb_ras;
+    size_t tb_ras_hits;
+    size_t tb_ras_misses;
+    /* Entries into counted TBs, only written by this vCPU. */
+    uint32_t tb_hot[TB_HOT_SLOTS];
+    /* Hot quick TBs waiting for the vCPU to halt, see tb_tier_up_drain(). */
+    struct TBTierUpQueue *tb_tier_up;
 
     struct GDBRegisterState *gdb_regs;
     int gdb_num_regs;
@@ -442,6 +482,22 @@ extern CPUTailQ cpus;
 
 extern __thread CPUState *current_cpu;
 
+extern uint32_t tb_ic_epoch_next;
+
+/*
+ * Epochs come from a global counter so that no two vCPUs ever share one;
+ * a TB inline cache entry is only ever hit by the vCPU that filled it.
+ */
+static inline void cpu_tb_ic_epoch_bump(CPUState *cpu)
+{
+    uint32_t epoch;
+
+    do {
+        epoch = qatomic_fetch_inc(&tb_ic_epoch_next) + 1;
+    } while (epoch == 0);
+    qatomic_set(&cpu->tb_ic_epoch, epoch);
+}
+
 static inline void cpu_tb_jmp_cache_clear(CPUState *cpu)
 {
     unsigned int i;
@@ -449,6 +505,7 @@ static inline void cpu_tb_jmp_cache_clear(CPUState *cpu)
     for (i = 0; i < TB_JMP_CACHE_SIZE; i++) {
         qatomic_set(&cpu->tb_jmp_cache[i], NULL);
     }
+    cpu_tb_ic_epoch_bump(cpu);
 }
 
 /**
@@ -48,6 +48,11 @@ typedef bool (*qht_iter_bool_func_t)(void *p, uint32_t h, void *up);
 
 #define QHT_MODE_AUTO_RESIZE 0x1 /* auto-resize when heavily loaded */
 #define QHT_MODE_RAW_MUTEXES 0x2 /* bypass the profiler (QSP) */
+/*
+ * With QHT_MODE_AUTO_RESIZE, grow by migrating buckets a few at a time from
+ * the writers' paths, instead of stopping all writers during the resize.
+ */
+#define QHT_MODE_INCREMENTAL_RESIZE 0x4
 
 /**
  * qht_init - Initialize a QHT
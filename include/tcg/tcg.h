@@ -804,6 +804,11 @@ void tcg_pool_reset(TCGContext *s);
 TranslationBlock *tcg_tb_alloc(TCGContext *s);
 
 void tcg_region_reset_all(void);
+bool tcg_region_evict_wanted(void);
+ssize_t tcg_region_evict_begin(uint64_t *reset_count);
+GPtrArray *tcg_region_tbs(size_t i);
+void tcg_region_range(size_t i, const void **pstart, const void **pend);
+bool tcg_region_evict_end(size_t i, uint64_t reset_count);
 
 size_t tcg_code_size(void);
 size_t tcg_code_capacity(void);
@@ -150,7 +150,9 @@ DEF("accel", HAS_ARG, QEMU_OPTION_accel,
     "                kernel-irqchip=on|off|split controls accelerated irqchip support (default=on)\n"
     "                kvm-shadow-mem=size of KVM shadow MMU in bytes\n"
     "                split-wx=on|off (enable TCG split w^x mapping)\n"
+    "                superblock-threshold=n (retranslate TCG blocks entered n times as superblocks, default=0)\n"
     "                tb-size=n (TCG translation block cache size)\n"
+    "                tier-up-threshold=n (optimize TCG blocks once entered n times, default=0)\n"
     "                dirty-ring-size=n (KVM dirty ring GFN count, default 0)\n"
     "                thread=single|multi (enable multi-threaded TCG)\n", QEMU_ARCH_ALL)
 SRST
@@ -182,9 +184,27 @@ SRST
         such a case this will default on. On other operating systems, this
         will default off, but one may enable this for testing or debugging.
 
+    ``superblock-threshold=n``
+        Once a TCG translation block has been entered n times it is
+        translated again as a superblock, which carries on through
+        forward direct jumps on the same page instead of ending there.
+        Supported on i386, aarch64 and ARC guests.  The default of 0
+        disables it.  The number of superblocks is reported by
+        ``info jit``.
+
     ``tb-size=n``
         Controls the size (in MiB) of the TCG translation block cache.
 
+    ``tier-up-threshold=n``
+        TCG translation blocks are first translated without running the
+        TCG optimizer, which is cheaper for code that only runs a few
+        times, and translated again with it once entered n times by one
+        vCPU.  In system emulation the second translation waits until that
+        vCPU halts, unless many blocks are already waiting.  The default
+        of 0 optimizes every block from the start.  Not used for blocks
+        that cannot chain, e.g. with icount.  The number of blocks still
+        unoptimized is reported by ``info jit``.
+
     ``thread=single|multi``
         Controls number of TCG threads. When the TCG is multi-threaded
         there will be one thread per vCPU therefore taking advantage of
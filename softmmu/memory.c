@@ -100,6 +100,28 @@ static AddrRange addrrange_intersection(AddrRange r1, AddrRange r2)
     return addrrange_make(start, int128_sub(end, start));
 }
 
+/*
+ * Parts of the memory topology changed by the pending transaction, each
+ * relative to the container of @root: one for the root container the
+ * change was found in, and one for every region on the way that aliases
+ * point to.  At commit time only these windows are re-rendered in the
+ * existing FlatViews; changes that cannot be bounded this way force a
+ * full re-render.  @root is only compared, never dereferenced, as it may
+ * be gone by then.
+ */
+typedef struct MemoryRegionUpdate {
+    MemoryRegion *root;
+    AddrRange addr;
+    bool via_alias;
+} MemoryRegionUpdate;
+
+#define MEMORY_REGION_UPDATES_MAX 64
+#define FLATVIEW_WINDOWS_MAX (4 * MEMORY_REGION_UPDATES_MAX)
+
+static MemoryRegionUpdate memory_region_updates[MEMORY_REGION_UPDATES_MAX];
+static unsigned memory_region_updates_nb;
+static bool memory_region_update_all;
+
 enum ListenerDirection { Forward, Reverse };
 
 #define MEMORY_LISTENER_CALL_GLOBAL(_callback, _direction, _args...)    \
@@ -573,6 +595,23 @@ static AddressSpace *memory_region_to_address_space(MemoryRegion *mr)
     return NULL;
 }
 
+/* Index of the first range of @view that ends after @addr. */
+static unsigned flatview_range_index(FlatView *view, Int128 addr)
+{
+    unsigned lo = 0, hi = view->nr;
+
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+
+        if (int128_ge(addr, addrrange_end(view->ranges[mid].addr))) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 /* Render a memory region into the global view.  Ranges in @view obscure
  * ranges in @mr.
  */
@@ -636,7 +675,8 @@ static void render_memory_region(FlatView *view,
     fr.nonvolatile = nonvolatile;
 
     /* Render the region itself into any gaps left by the current view. */
-    for (i = 0; i < view->nr && int128_nz(remain); ++i) {
+    for (i = flatview_range_index(view, base);
+         i < view->nr && int128_nz(remain); ++i) {
         if (int128_ge(base, addrrange_end(view->ranges[i].addr))) {
             continue;
         }
@@ -724,10 +764,26 @@ static MemoryRegion *memory_region_get_flatview_root(MemoryRegion *mr)
     return NULL;
 }
 
+/* Simplify a freshly rendered view and build its dispatch tree. */
+static void flatview_finish(FlatView *view)
+{
+    int i;
+
+    flatview_simplify(view);
+
+    view->dispatch = address_space_dispatch_new(view);
+    for (i = 0; i < view->nr; i++) {
+        MemoryRegionSection mrs =
+            section_from_flat_range(&view->ranges[i], view);
+        flatview_add_to_dispatch(view, &mrs);
+    }
+    address_space_dispatch_compact(view->dispatch);
+    g_hash_table_replace(flat_views, view->root, view);
+}
+
 /* Render a memory topology into a list of disjoint absolute ranges. */
 static FlatView *generate_memory_topology(MemoryRegion *mr)
 {
-    int i;
     FlatView *view;
 
     view = flatview_new(mr);
@@ -737,20 +793,218 @@ static FlatView *generate_memory_topology(MemoryRegion *mr)
                              addrrange_make(int128_zero(), int128_2_64()),
                              false, false);
     }
-    flatview_simplify(view);
+    flatview_finish(view);
 
-    view->dispatch = address_space_dispatch_new(view);
-    for (i = 0; i < view->nr; i++) {
-        MemoryRegionSection mrs =
-            section_from_flat_range(&view->ranges[i], view);
-        flatview_add_to_dispatch(view, &mrs);
+    return view;
+}
+
+/*
+ * Find where addresses relative to @root appear in a view rendered from
+ * @mr, following the containers of @mr and then the regions it aliases.
+ * Returns false if the subtree of @root is not part of that view.
+ */
+static bool memory_region_root_delta(MemoryRegion *mr, MemoryRegion *root,
+                                     Int128 *delta)
+{
+    Int128 d = int128_zero();
+    MemoryRegion *cur;
+
+    for (; mr; mr = mr->alias) {
+        Int128 off = d;
+
+        for (cur = mr; cur != root && cur->container; ) {
+            cur = cur->container;
+            int128_subfrom(&off, int128_make64(cur->addr));
+        }
+        if (cur == root) {
+            *delta = off;
+            return true;
+        }
+        if (mr->alias) {
+            int128_addto(&d, int128_make64(mr->addr));
+            int128_subfrom(&d, int128_make64(mr->alias_offset));
+            int128_subfrom(&d, int128_make64(mr->alias->addr));
+        }
     }
-    address_space_dispatch_compact(view->dispatch);
-    g_hash_table_replace(flat_views, mr, view);
+    return false;
+}
+
+/*
+ * Add to @windows where the updates recorded for aliased regions appear
+ * in the view, by walking the regions below @mr the way
+ * render_memory_region() does and matching the aliases met on the way.
+ * Returns false if there are more than FLATVIEW_WINDOWS_MAX windows.
+ */
+static bool flatview_alias_windows(MemoryRegion *mr, Int128 base,
+                                   AddrRange clip, AddrRange *windows,
+                                   unsigned *nb)
+{
+    MemoryRegion *subregion;
+    AddrRange tmp;
+    unsigned i;
+
+    if (!mr->enabled) {
+        return true;
+    }
+
+    int128_addto(&base, int128_make64(mr->addr));
+    tmp = addrrange_make(base, mr->size);
+    if (!addrrange_intersects(tmp, clip)) {
+        return true;
+    }
+    clip = addrrange_intersection(tmp, clip);
+
+    if (mr->alias) {
+        int128_subfrom(&base, int128_make64(mr->alias->addr));
+        int128_subfrom(&base, int128_make64(mr->alias_offset));
+        for (i = 0; i < memory_region_updates_nb; i++) {
+            MemoryRegionUpdate *u = &memory_region_updates[i];
+            AddrRange r;
+
+            if (!u->via_alias || u->root != mr->alias) {
+                continue;
+            }
+            r = addrrange_shift(u->addr, base);
+            if (!int128_nz(r.size) || !addrrange_intersects(r, clip)) {
+                continue;
+            }
+            if (*nb == FLATVIEW_WINDOWS_MAX) {
+                return false;
+            }
+            windows[(*nb)++] = addrrange_intersection(r, clip);
+        }
+        return flatview_alias_windows(mr->alias, base, clip, windows, nb);
+    }
+
+    QTAILQ_FOREACH(subregion, &mr->subregions, subregions_link) {
+        if (!flatview_alias_windows(subregion, base, clip, windows, nb)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int addrrange_cmp(const void *a_, const void *b_)
+{
+    const AddrRange *a = a_, *b = b_;
+
+    if (int128_lt(a->start, b->start)) {
+        return -1;
+    }
+    return int128_eq(a->start, b->start) ? 0 : 1;
+}
+
+/*
+ * Build the view of @mr from @old_view: ranges outside @windows are
+ * carried over, the windows themselves are rendered again.  @windows
+ * must be sorted and disjoint.
+ */
+static FlatView *generate_memory_topology_partial(MemoryRegion *mr,
+                                                  FlatView *old_view,
+                                                  AddrRange *windows,
+                                                  unsigned nb)
+{
+    FlatView *view;
+    FlatRange *fr;
+    unsigned i, w = 0;
+
+    view = flatview_new(mr);
+    view->nr_allocated = old_view->nr + 2 * nb + 10;
+    view->ranges = g_new(FlatRange, view->nr_allocated);
+
+    FOR_EACH_FLAT_RANGE(fr, old_view) {
+        Int128 start = fr->addr.start;
+        Int128 end = addrrange_end(fr->addr);
+
+        while (w < nb && int128_le(addrrange_end(windows[w]), start)) {
+            w++;
+        }
+        for (i = w; int128_lt(start, end); i++) {
+            Int128 piece_end = end;
+            FlatRange piece = *fr;
+
+            if (i < nb) {
+                piece_end = int128_min(end, windows[i].start);
+            }
+            if (int128_lt(start, piece_end)) {
+                piece.offset_in_region +=
+                    int128_get64(int128_sub(start, fr->addr.start));
+                piece.addr = addrrange_make(start,
+                                            int128_sub(piece_end, start));
+                flatview_insert(view, view->nr, &piece);
+            }
+            if (i == nb || int128_le(end, windows[i].start)) {
+                break;
+            }
+            start = int128_max(start, addrrange_end(windows[i]));
+        }
+    }
+
+    for (i = 0; i < nb; i++) {
+        render_memory_region(view, mr, int128_zero(), windows[i],
+                             false, false);
+    }
+    flatview_finish(view);
 
     return view;
 }
 
+/*
+ * Bring the view of @mr up to date after a transaction, starting from
+ * @old_view and the windows recorded by memory_region_update_range().
+ */
+static FlatView *flatview_update(MemoryRegion *mr, FlatView *old_view)
+{
+    AddrRange all = addrrange_make(int128_zero(), int128_2_64());
+    AddrRange windows[FLATVIEW_WINDOWS_MAX];
+    unsigned i, n, nb = 0;
+    bool via_alias = false;
+
+    for (i = 0; i < memory_region_updates_nb; i++) {
+        MemoryRegionUpdate *u = &memory_region_updates[i];
+        AddrRange r;
+        Int128 delta;
+
+        via_alias |= u->via_alias;
+        if (!memory_region_root_delta(mr, u->root, &delta)) {
+            continue;
+        }
+        r = addrrange_shift(u->addr, delta);
+        if (!int128_nz(r.size) || !addrrange_intersects(r, all)) {
+            continue;
+        }
+        windows[nb++] = addrrange_intersection(r, all);
+    }
+    if (via_alias &&
+        !flatview_alias_windows(mr, int128_zero(), all, windows, &nb)) {
+        return generate_memory_topology(mr);
+    }
+
+    if (!nb) {
+        flatview_ref(old_view);
+        g_hash_table_replace(flat_views, mr, old_view);
+        return old_view;
+    }
+
+    /* Sort the windows and merge the ones that overlap or touch. */
+    qsort(windows, nb, sizeof(*windows), addrrange_cmp);
+    n = nb;
+    for (i = 1, nb = 1; i < n; i++) {
+        AddrRange *last = &windows[nb - 1];
+        Int128 end = addrrange_end(windows[i]);
+
+        if (int128_le(windows[i].start, addrrange_end(*last))) {
+            if (int128_gt(end, addrrange_end(*last))) {
+                last->size = int128_sub(end, last->start);
+            }
+        } else {
+            windows[nb++] = windows[i];
+        }
+    }
+
+    return generate_memory_topology_partial(mr, old_view, windows, nb);
+}
+
 static void address_space_add_del_ioeventfds(AddressSpace *as,
                                              MemoryRegionIoeventfd *fds_new,
                                              unsigned fds_new_nb,
@@ -1003,24 +1257,36 @@ static void flatviews_init(void)
 
 static void flatviews_reset(void)
 {
+    GHashTable *old_views = flat_views;
     AddressSpace *as;
 
-    if (flat_views) {
-        g_hash_table_unref(flat_views);
-        flat_views = NULL;
-    }
+    flat_views = NULL;
     flatviews_init();
 
-    /* Render unique FVs */
+    /* Render unique FVs, reusing what did not change from the old ones */
     QTAILQ_FOREACH(as, &address_spaces, address_spaces_link) {
         MemoryRegion *physmr = memory_region_get_flatview_root(as->root);
+        FlatView *old_view = NULL;
 
         if (g_hash_table_lookup(flat_views, physmr)) {
             continue;
         }
 
-        generate_memory_topology(physmr);
+        if (old_views && !memory_region_update_all) {
+            old_view = g_hash_table_lookup(old_views, physmr);
+        }
+        if (old_view) {
+            flatview_update(physmr, old_view);
+        } else {
+            generate_memory_topology(physmr);
+        }
+    }
+
+    if (old_views) {
+        g_hash_table_unref(old_views);
     }
+    memory_region_updates_nb = 0;
+    memory_region_update_all = false;
 }
 
 static void address_space_set_flatview(AddressSpace *as)
@@ -1079,6 +1345,50 @@ static void address_space_update_topology(AddressSpace *as)
     address_space_set_flatview(as);
 }
 
+/*
+ * Record that the part of the address space covered by @mr has to be
+ * rendered again.  The window is tracked relative to the root container
+ * of @mr, and also relative to @mr and each of its containers that can
+ * be seen through an alias; flatview_update() maps the latter through
+ * the aliases found in each view.
+ */
+static void memory_region_update_range(MemoryRegion *mr)
+{
+    MemoryRegionUpdate *u;
+    Int128 start = int128_zero();
+    Int128 size = mr->size;
+
+    memory_region_update_pending = true;
+    if (memory_region_update_all) {
+        return;
+    }
+
+    for (;;) {
+        int128_addto(&start, int128_make64(mr->addr));
+        if (mr->mapped_via_alias || !mr->container) {
+            if (memory_region_updates_nb == MEMORY_REGION_UPDATES_MAX) {
+                memory_region_update_all = true;
+                return;
+            }
+            u = &memory_region_updates[memory_region_updates_nb++];
+            u->root = mr;
+            u->addr = addrrange_make(start, size);
+            u->via_alias = mr->mapped_via_alias;
+        }
+        if (!mr->container) {
+            break;
+        }
+        mr = mr->container;
+    }
+}
+
+/* Re-render every view at the end of the pending transaction. */
+static void memory_region_update_everything(void)
+{
+    memory_region_update_pending = true;
+    memory_region_update_all = true;
+}
+
 void memory_region_transaction_begin(void)
 {
     qemu_flush_coalesced_mmio_buffer();
@@ -1100,8 +1410,13 @@ void memory_region_transaction_commit(void)
             MEMORY_LISTENER_CALL_GLOBAL(begin, Forward);
 
             QTAILQ_FOREACH(as, &address_spaces, address_spaces_link) {
+                FlatView *old_view = address_space_to_flatview(as);
+
                 address_space_set_flatview(as);
-                address_space_update_ioeventfds(as);
+                if (ioeventfd_update_pending ||
+                    address_space_to_flatview(as) != old_view) {
+                    address_space_update_ioeventfds(as);
+                }
             }
             memory_region_update_pending = false;
             ioeventfd_update_pending = false;
@@ -1246,6 +1561,7 @@ static void memory_region_initfn(Object *obj)
     mr->ops = &unassigned_mem_ops;
     mr->enabled = true;
     mr->romd_mode = true;
+    mr->global_locking = true;
     mr->destructor = memory_region_destructor_none;
     QTAILQ_INIT(&mr->subregions);
     QTAILQ_INIT(&mr->coalesced);
@@ -1459,6 +1775,13 @@ MemTxResult memory_region_dispatch_read(MemoryRegion *mr,
     return r;
 }
 
+/*
+ * Regions without global locking have their ioeventfds looked up and
+ * signalled under this lock instead, so that an eventfd cannot be removed
+ * and closed while another thread is about to signal it.
+ */
+static QemuSpin ioeventfds_lock;
+
 /* Return true if an eventfd was signalled */
 static bool memory_region_dispatch_write_eventfds(MemoryRegion *mr,
                                                     hwaddr addr,
@@ -1470,19 +1793,30 @@ static bool memory_region_dispatch_write_eventfds(MemoryRegion *mr,
         .addr = addrrange_make(int128_make64(addr), int128_make64(size)),
         .data = data,
     };
+    bool found = false;
     unsigned i;
 
+    if (!mr->global_locking) {
+        if (!qatomic_read(&mr->ioeventfd_nb)) {
+            return false;
+        }
+        qemu_spin_lock(&ioeventfds_lock);
+    }
     for (i = 0; i < mr->ioeventfd_nb; i++) {
         ioeventfd.match_data = mr->ioeventfds[i].match_data;
         ioeventfd.e = mr->ioeventfds[i].e;
 
         if (memory_region_ioeventfd_equal(&ioeventfd, &mr->ioeventfds[i])) {
             event_notifier_set(ioeventfd.e);
-            return true;
+            found = true;
+            break;
         }
     }
+    if (!mr->global_locking) {
+        qemu_spin_unlock(&ioeventfds_lock);
+    }
 
-    return false;
+    return found;
 }
 
 MemTxResult memory_region_dispatch_write(MemoryRegion *mr,
@@ -2135,7 +2469,9 @@ void memory_region_set_log(MemoryRegion *mr, bool log, unsigned client)
 
     memory_region_transaction_begin();
     mr->dirty_log_mask = (mr->dirty_log_mask & ~mask) | (log * mask);
-    memory_region_update_pending |= mr->enabled;
+    if (mr->enabled) {
+        memory_region_update_range(mr);
+    }
     memory_region_transaction_commit();
 }
 
@@ -2265,7 +2601,9 @@ void memory_region_set_readonly(MemoryRegion *mr, bool readonly)
     if (mr->readonly != readonly) {
         memory_region_transaction_begin();
         mr->readonly = readonly;
-        memory_region_update_pending |= mr->enabled;
+        if (mr->enabled) {
+            memory_region_update_range(mr);
+        }
         memory_region_transaction_commit();
     }
 }
@@ -2275,7 +2613,9 @@ void memory_region_set_nonvolatile(MemoryRegion *mr, bool nonvolatile)
     if (mr->nonvolatile != nonvolatile) {
         memory_region_transaction_begin();
         mr->nonvolatile = nonvolatile;
-        memory_region_update_pending |= mr->enabled;
+        if (mr->enabled) {
+            memory_region_update_range(mr);
+        }
         memory_region_transaction_commit();
     }
 }
@@ -2285,7 +2625,9 @@ void memory_region_rom_device_set_romd(MemoryRegion *mr, bool romd_mode)
     if (mr->romd_mode != romd_mode) {
         memory_region_transaction_begin();
         mr->romd_mode = romd_mode;
-        memory_region_update_pending |= mr->enabled;
+        if (mr->enabled) {
+            memory_region_update_range(mr);
+        }
         memory_region_transaction_commit();
     }
 }
@@ -2442,6 +2784,11 @@ void memory_region_clear_flush_coalesced(MemoryRegion *mr)
     }
 }
 
+void memory_region_clear_global_locking(MemoryRegion *mr)
+{
+    mr->global_locking = false;
+}
+
 static bool userspace_eventfd_warning;
 
 void memory_region_add_eventfd(MemoryRegion *mr,
@@ -2476,12 +2823,14 @@ void memory_region_add_eventfd(MemoryRegion *mr,
             break;
         }
     }
+    qemu_spin_lock(&ioeventfds_lock);
     ++mr->ioeventfd_nb;
     mr->ioeventfds = g_realloc(mr->ioeventfds,
                                   sizeof(*mr->ioeventfds) * mr->ioeventfd_nb);
     memmove(&mr->ioeventfds[i+1], &mr->ioeventfds[i],
             sizeof(*mr->ioeventfds) * (mr->ioeventfd_nb-1 - i));
     mr->ioeventfds[i] = mrfd;
+    qemu_spin_unlock(&ioeventfds_lock);
     ioeventfd_update_pending |= mr->enabled;
     memory_region_transaction_commit();
 }
@@ -2512,11 +2861,13 @@ void memory_region_del_eventfd(MemoryRegion *mr,
         }
     }
     assert(i != mr->ioeventfd_nb);
+    qemu_spin_lock(&ioeventfds_lock);
     memmove(&mr->ioeventfds[i], &mr->ioeventfds[i+1],
             sizeof(*mr->ioeventfds) * (mr->ioeventfd_nb - (i+1)));
     --mr->ioeventfd_nb;
     mr->ioeventfds = g_realloc(mr->ioeventfds,
                                   sizeof(*mr->ioeventfds)*mr->ioeventfd_nb + 1);
+    qemu_spin_unlock(&ioeventfds_lock);
     ioeventfd_update_pending |= mr->enabled;
     memory_region_transaction_commit();
 }
@@ -2537,7 +2888,9 @@ static void memory_region_update_container_subregions(MemoryRegion *subregion)
     }
     QTAILQ_INSERT_TAIL(&mr->subregions, subregion, subregions_link);
 done:
-    memory_region_update_pending |= mr->enabled && subregion->enabled;
+    if (mr->enabled && subregion->enabled) {
+        memory_region_update_range(subregion);
+    }
     memory_region_transaction_commit();
 }
 
@@ -2580,6 +2933,9 @@ void memory_region_del_subregion(MemoryRegion *mr,
 
     memory_region_transaction_begin();
     assert(subregion->container == mr);
+    if (mr->enabled && subregion->enabled) {
+        memory_region_update_range(subregion);
+    }
     subregion->container = NULL;
     for (alias = subregion->alias; alias; alias = alias->alias) {
         alias->mapped_via_alias--;
@@ -2587,7 +2943,6 @@ void memory_region_del_subregion(MemoryRegion *mr,
     }
     QTAILQ_REMOVE(&mr->subregions, subregion, subregions_link);
     memory_region_unref(subregion);
-    memory_region_update_pending |= mr->enabled && subregion->enabled;
     memory_region_transaction_commit();
 }
 
@@ -2598,7 +2953,7 @@ void memory_region_set_enabled(MemoryRegion *mr, bool enabled)
     }
     memory_region_transaction_begin();
     mr->enabled = enabled;
-    memory_region_update_pending = true;
+    memory_region_update_range(mr);
     memory_region_transaction_commit();
 }
 
@@ -2613,8 +2968,9 @@ void memory_region_set_size(MemoryRegion *mr, uint64_t size)
         return;
     }
     memory_region_transaction_begin();
+    memory_region_update_range(mr);
     mr->size = s;
-    memory_region_update_pending = true;
+    memory_region_update_range(mr);
     memory_region_transaction_commit();
 }
 
@@ -2635,8 +2991,14 @@ static void memory_region_readd_subregion(MemoryRegion *mr)
 void memory_region_set_address(MemoryRegion *mr, hwaddr addr)
 {
     if (addr != mr->addr) {
+        memory_region_transaction_begin();
+        if (mr->container && mr->container->enabled && mr->enabled) {
+            /* The old location; the new one is recorded when re-added. */
+            memory_region_update_range(mr);
+        }
         mr->addr = addr;
         memory_region_readd_subregion(mr);
+        memory_region_transaction_commit();
     }
 }
 
@@ -2650,7 +3012,9 @@ void memory_region_set_alias_offset(MemoryRegion *mr, hwaddr offset)
 
     memory_region_transaction_begin();
     mr->alias_offset = offset;
-    memory_region_update_pending |= mr->enabled;
+    if (mr->enabled) {
+        memory_region_update_range(mr);
+    }
     memory_region_transaction_commit();
 }
 
@@ -2821,7 +3185,7 @@ void memory_global_dirty_log_start(unsigned int flags)
     if (!old_flags) {
         MEMORY_LISTENER_CALL_GLOBAL(log_global_start, Forward);
         memory_region_transaction_begin();
-        memory_region_update_pending = true;
+        memory_region_update_everything();
         memory_region_transaction_commit();
     }
 }
@@ -2836,7 +3200,7 @@ static void memory_global_dirty_log_do_stop(unsigned int flags)
 
     if (!global_dirty_tracking) {
         memory_region_transaction_begin();
-        memory_region_update_pending = true;
+        memory_region_update_everything();
         memory_region_transaction_commit();
         MEMORY_LISTENER_CALL_GLOBAL(log_global_stop, Reverse);
     }
@@ -5,6 +5,7 @@
 #include "qapi/error.h"
 #include "exec/helper-proto.h"
 #include "semihosting/semihost.h"
+#include "sysemu/runstate.h"
 
 enum {
     TARGET_SYS_exit = 1,
@@ -19,6 +20,8 @@ enum {
     TARGET_SYS_gettimeofday = 78,
     TARGET_SYS_stat = 106, /* nsim stat's is corupted.  */
     TARGET_SYS_fstat = 108,
+    TARGET_SYS_readv = 145,
+    TARGET_SYS_writev = 146,
 
     TARGET_SYS_argc = 1000,
     TARGET_SYS_argv_sz = 1001,
@@ -73,6 +76,294 @@ void arc_sim_open_console(Chardev *chr)
     sim_console = &console;
 }
 
+/*
+ * Output to stdout and stderr is buffered, so that firmware logging a
+ * character at a time does not cost a host write (and a chardev
+ * round-trip) per trap.  Writing to one stream flushes the other, to
+ * keep their relative order, and both are flushed before stdin is read
+ * and when the guest exits or QEMU shuts down.  Everything runs under
+ * the BQL, like the rest of the exception delivery.
+ */
+#define ARC_SEMI_DEFAULT_BUFSIZE 4096
+#define ARC_SEMI_IOV_MAX         1024
+#define ARC_SEMI_CHUNK           (64 * 1024)
+
+typedef struct ArcSemiStream {
+    int fd;
+    uint8_t *buf;
+    size_t len;
+} ArcSemiStream;
+
+static const char * const arc_semi_flush_names[] = {
+    [ARC_SEMI_FLUSH_NONE] = "none",
+    [ARC_SEMI_FLUSH_LINE] = "line",
+    [ARC_SEMI_FLUSH_FULL] = "full",
+};
+
+static struct {
+    ArcSemiFlush policy;
+    size_t bufsize;
+    ArcSemiStream out[2];           /* stdout, stderr */
+    Notifier shutdown;
+    uint8_t *bounce;                /* for unbuffered and host fd I/O */
+} arc_semi = {
+    .policy = ARC_SEMI_FLUSH_LINE,
+    .bufsize = ARC_SEMI_DEFAULT_BUFSIZE,
+    .out = { { .fd = 1 }, { .fd = 2 } },
+};
+
+const char *arc_semihosting_get_flush(void)
+{
+    return arc_semi_flush_names[arc_semi.policy];
+}
+
+void arc_semihosting_set_flush(const char *policy, Error **errp)
+{
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(arc_semi_flush_names); i++) {
+        if (!strcmp(policy, arc_semi_flush_names[i])) {
+            arc_semi.policy = i;
+            return;
+        }
+    }
+    error_setg(errp, "Invalid semihosting flush policy '%s'", policy);
+    error_append_hint(errp, "Valid values are none, line and full.\n");
+}
+
+size_t arc_semihosting_get_bufsize(void)
+{
+    return arc_semi.bufsize;
+}
+
+void arc_semihosting_set_bufsize(size_t size, Error **errp)
+{
+    if (size == 0 || size > ARC_SEMI_CHUNK) {
+        error_setg(errp, "semihosting buffer size must be between 1 and %u",
+                   ARC_SEMI_CHUNK);
+        return;
+    }
+    if (arc_semi.out[0].buf || arc_semi.out[1].buf) {
+        error_setg(errp, "semihosting buffers are already in use");
+        return;
+    }
+    arc_semi.bufsize = size;
+}
+
+static ssize_t arc_semi_host_write(int fd, const uint8_t *buf, size_t len)
+{
+    if (fd < 3 && sim_console) {
+        if (fd == 1 || fd == 2) {
+            return qemu_chr_fe_write_all(&sim_console->be, buf, len);
+        }
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "writing to fd %d is not supported with chardev console\n",
+                      fd);
+        return -1;
+    }
+    return write(fd, buf, len);
+}
+
+static void arc_semi_stream_flush(ArcSemiStream *s)
+{
+    size_t done = 0;
+
+    while (done < s->len) {
+        ssize_t ret = arc_semi_host_write(s->fd, s->buf + done,
+                                          s->len - done);
+        if (ret <= 0) {
+            qemu_log_mask(LOG_GUEST_ERROR, "semihosting: dropped %zu bytes of fd %d\n",
+                          s->len - done, s->fd);
+            break;
+        }
+        done += ret;
+    }
+    s->len = 0;
+}
+
+static void arc_semi_flush_all(void)
+{
+    arc_semi_stream_flush(&arc_semi.out[0]);
+    arc_semi_stream_flush(&arc_semi.out[1]);
+}
+
+static void arc_semi_shutdown_notify(Notifier *notifier, void *data)
+{
+    arc_semi_flush_all();
+}
+
+static ArcSemiStream *arc_semi_stream(int fd)
+{
+    ArcSemiStream *s;
+
+    if (arc_semi.policy == ARC_SEMI_FLUSH_NONE || (fd != 1 && fd != 2)) {
+        return NULL;
+    }
+    s = &arc_semi.out[fd - 1];
+    if (s->buf == NULL) {
+        s->buf = g_malloc(arc_semi.bufsize);
+        if (arc_semi.shutdown.notify == NULL) {
+            arc_semi.shutdown.notify = arc_semi_shutdown_notify;
+            qemu_register_shutdown_notifier(&arc_semi.shutdown);
+        }
+    }
+    return s;
+}
+
+/*
+ * Guest buffers are moved with cpu_memory_rw_debug(), which walks the
+ * pages itself, so a whole buffer costs one copy and, unbuffered, one
+ * host call per ARC_SEMI_CHUNK.  Returns the number of bytes transferred,
+ * or -1 if an error happened before anything was.
+ */
+static int64_t arc_semi_write(CPUState *cs, int fd, target_ulong vaddr,
+                              uint32_t len)
+{
+    ArcSemiStream *s = arc_semi_stream(fd);
+    ArcSemiStream *other;
+    int64_t done = 0;
+
+    if (s == NULL) {
+        arc_semi_flush_all();
+    } else {
+        other = &arc_semi.out[2 - fd];
+        arc_semi_stream_flush(other);
+    }
+
+    while (done < len) {
+        uint32_t n;
+
+        if (s != NULL) {
+            uint8_t *p = s->buf + s->len;
+
+            n = MIN(len - done, arc_semi.bufsize - s->len);
+            if (cpu_memory_rw_debug(cs, vaddr + done, p, n, false) != 0) {
+                break;
+            }
+            s->len += n;
+            if (s->len == arc_semi.bufsize
+                || (arc_semi.policy == ARC_SEMI_FLUSH_LINE
+                    && memchr(p, '\n', n) != NULL)) {
+                arc_semi_stream_flush(s);
+            }
+        } else {
+            ssize_t ret;
+
+            n = MIN(len - done, ARC_SEMI_CHUNK);
+            if (cpu_memory_rw_debug(cs, vaddr + done, arc_semi.bounce,
+                                    n, false) != 0) {
+                break;
+            }
+            ret = arc_semi_host_write(fd, arc_semi.bounce, n);
+            if (ret < 0) {
+                break;
+            }
+            n = ret;
+        }
+        done += n;
+        if (n == 0) {
+            break;
+        }
+    }
+    return done ? done : (len ? -1 : 0);
+}
+
+/*
+ * Returns the number of bytes read, 0 at end of file, or -1 if an error
+ * happened before anything was read.
+ */
+static int64_t arc_semi_read(CPUState *cs, int fd, target_ulong vaddr,
+                             uint32_t len)
+{
+    int64_t done = 0;
+
+    /* Prompts must show up before the guest blocks on input. */
+    arc_semi_flush_all();
+
+    if (fd < 3 && sim_console) {
+        size_t n = MIN(len, sim_console->input.offset);
+
+        if (fd != 0) {
+            qemu_log_mask(LOG_GUEST_ERROR,
+                          "reading from fd %d is not supported with chardev console\n",
+                          fd);
+            return -1;
+        }
+        if (n == 0) {
+            return len ? -1 : 0;
+        }
+        if (cpu_memory_rw_debug(cs, vaddr, (uint8_t *)sim_console->input.buffer,
+                                n, true) != 0) {
+            return -1;
+        }
+        memmove(sim_console->input.buffer, sim_console->input.buffer + n,
+                sim_console->input.offset - n);
+        sim_console->input.offset -= n;
+        qemu_chr_fe_accept_input(&sim_console->be);
+        return n;
+    }
+
+    while (done < len) {
+        uint32_t n = MIN(len - done, ARC_SEMI_CHUNK);
+        ssize_t ret = read(fd, arc_semi.bounce, n);
+
+        if (ret == 0) {
+            /* end of file */
+            break;
+        }
+        if (ret < 0
+            || cpu_memory_rw_debug(cs, vaddr + done, arc_semi.bounce,
+                                   ret, true) != 0) {
+            return done ? done : -1;
+        }
+        done += ret;
+        if (ret < n) {
+            break;
+        }
+    }
+    return done;
+}
+
+/*
+ * readv/writev: R0 fd, R1 guest array of { target_ulong base, len },
+ * R2 number of entries.  Stops at the first short transfer.
+ */
+static int64_t arc_semi_rwv(CPUState *cs, bool is_write, int fd,
+                            target_ulong iov, uint32_t iovcnt)
+{
+    int64_t done = 0;
+    uint32_t i;
+
+    if (iovcnt > ARC_SEMI_IOV_MAX) {
+        return -1;
+    }
+    for (i = 0; i < iovcnt; i++) {
+        target_ulong ent[2];
+        int64_t ret;
+
+        if (cpu_memory_rw_debug(cs, iov + i * sizeof(ent), (uint8_t *)ent,
+                                sizeof(ent), false) != 0) {
+            return done ? done : -1;
+        }
+        ent[0] = tswapl(ent[0]);
+        ent[1] = tswapl(ent[1]);
+        if (ent[1] > UINT32_MAX) {
+            return done ? done : -1;
+        }
+        ret = is_write ? arc_semi_write(cs, fd, ent[0], ent[1])
+                       : arc_semi_read(cs, fd, ent[0], ent[1]);
+        if (ret < 0) {
+            return done ? done : -1;
+        }
+        done += ret;
+        if (ret < ent[1]) {
+            /* short transfer, e.g. end of file */
+            break;
+        }
+    }
+    return done;
+}
+
 /*
  * SYSCALL0:
  *  - Input: R8 syscall name;
@@ -87,88 +378,28 @@ void do_arc_semihosting(CPUARCState *env)
     CPUState *cs = env_cpu(env);
     target_ulong *regs = env->r;
 
+    if (arc_semi.bounce == NULL) {
+        arc_semi.bounce = g_malloc(ARC_SEMI_CHUNK);
+    }
+
     switch (regs[8]) {
     case TARGET_SYS_exit:
+        arc_semi_flush_all();
         exit(regs[0]);
         break;
 
     case TARGET_SYS_read:
+        regs[0] = arc_semi_read(cs, regs[0], regs[1], regs[2]);
+        break;
+
     case TARGET_SYS_write:
-        {
-            bool is_write = regs[8] == TARGET_SYS_write;
-            uint32_t fd = (uint32_t) regs[0];
-            target_ulong vaddr = regs[1];
-            uint32_t len = (uint32_t) regs[2];
-            uint32_t len_done = 0;
-
-            while (len > 0) {
-                hwaddr paddr = cpu_get_phys_page_debug(cs, vaddr);
-                uint32_t page_left =
-                    TARGET_PAGE_SIZE - (vaddr & (TARGET_PAGE_SIZE - 1));
-                uint32_t io_sz = page_left < len ? page_left : len;
-                hwaddr sz = io_sz;
-                void *buf = cpu_physical_memory_map(paddr, &sz, !is_write);
-                uint32_t io_done;
-                bool error = false;
-
-                if (buf) {
-                    vaddr += io_sz;
-                    len -= io_sz;
-                    if (fd < 3 && sim_console) {
-                        if (is_write && (fd == 1 || fd == 2)) {
-                            /* stdout, stderr */
-                            io_done = qemu_chr_fe_write_all(&sim_console->be,
-                                                            buf, io_sz);
-                        } else if (!is_write && fd == 0) {
-                            /* stdin */
-                            if (sim_console->input.offset) {
-                                io_done = sim_console->input.offset;
-                                if (io_sz < io_done) {
-                                    io_done = io_sz;
-                                }
-                                memcpy(buf, sim_console->input.buffer, io_done);
-                                memmove(sim_console->input.buffer,
-                                        sim_console->input.buffer + io_done,
-                                        sim_console->input.offset - io_done);
-                                sim_console->input.offset -= io_done;
-                                qemu_chr_fe_accept_input(&sim_console->be);
-                            } else {
-                                io_done = -1;
-                            }
-                        } else {
-                            qemu_log_mask(LOG_GUEST_ERROR,
-                                          "%s fd %d is not supported with chardev console\n",
-                                          is_write ?
-                                          "writing to" : "reading from", fd);
-                            io_done = -1;
-                        }
-                    } else {
-                        io_done = is_write ?
-                            write(fd, buf, io_sz) :
-                            read(fd, buf, io_sz);
-                    }
-                    if (io_done == -1) {
-                        error = true;
-                        io_done = 0;
-                    }
-                    cpu_physical_memory_unmap(buf, sz, !is_write, io_done);
-                } else {
-                    error = true;
-                    break;
-                }
-                if (error) {
-                    if (!len_done) {
-                        len_done = -1;
-                    }
-                    break;
-                }
-                len_done += io_done;
-                if (io_done < io_sz) {
-                    break;
-                }
-            }
-            regs[0] = len_done;
-        }
+        regs[0] = arc_semi_write(cs, regs[0], regs[1], regs[2]);
+        break;
+
+    case TARGET_SYS_readv:
+    case TARGET_SYS_writev:
+        regs[0] = arc_semi_rwv(cs, regs[8] == TARGET_SYS_writev,
+                               regs[0], regs[1], regs[2]);
         break;
 
     case TARGET_SYS_open:
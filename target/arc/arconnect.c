@@ -24,10 +24,12 @@
 #include "target/arc/cpu.h"
 #include "target/arc/arconnect.h"
 #include "hw/irq.h"
+#include "hw/core/cpu.h"
 
 #define ICI_IRQ 19
 
-struct lpa_lf_entry lpa_lfs[LPA_LFS_SIZE];
+/* The ICI commands address cores with a 5-bit field. */
+#define ARCONNECT_MAX_CORES 32
 
 enum arconnect_commands {
     CMD_CHECK_CORE_ID = 0x0,
@@ -95,55 +97,97 @@ enum arconnect_commands {
     CMD_IDU_READ_PSTATUS
 };
 
+/*
+ * Core id to CPU map, filled in on first use.  A CPU never changes its
+ * core id, so the ICI unit can find any other core in constant time and
+ * without walking the CPU list.
+ */
+static ARCCPU *arconnect_cores[ARCONNECT_MAX_CORES];
+
 void arc_arconnect_init(ARCCPU *cpu)
 {
-    int i;
-    cpu->env.arconnect.intrpt_status = 0;
-    cpu->env.arconnect.lpa_lf = 0;
-    cpu->env.arconnect.locked_mutex = NULL;
-    for(i = 0; i < LPA_LFS_SIZE; i++) {
-        lpa_lfs[i].lpa_lf = 0;
-        qemu_mutex_init(&lpa_lfs[i].mutex);
-    }
+    qatomic_set(&cpu->env.arconnect.intrpt_status, 0);
+    qatomic_set(&cpu->env.arconnect.irq_sync_pending, 0);
 }
 
-/* TODO: Find a better way to get cpu for core. */
 static ARCCPU *get_cpu_for_core(uint8_t core_id)
 {
     CPUState *cs;
-    ARCCPU *ret = NULL;
+    ARCCPU *ret;
+
+    if (core_id >= ARCONNECT_MAX_CORES) {
+        return NULL;
+    }
+
+    ret = qatomic_read(&arconnect_cores[core_id]);
+    if (ret != NULL) {
+        return ret;
+    }
+
     CPU_FOREACH(cs) {
-        if(ARC_CPU(cs)->core_id == core_id) {
+        if (ARC_CPU(cs)->core_id == core_id) {
             ret = ARC_CPU(cs);
+            qatomic_set(&arconnect_cores[core_id], ret);
+            break;
         }
     }
     return ret;
 }
-static void arcon_status_set(CPUARCState *env, uint8_t status_core_id, uint8_t sender_core_id)
+
+/*
+ * The MCIP interrupt line of a core follows its intrpt_status mailbox:
+ * raised while any sender is pending, lowered once all of them have been
+ * acknowledged.  Senders only touch the mailbox bits, atomically; the line
+ * itself is updated by the receiving vCPU from its own thread, where the
+ * queued work item runs with the iothread lock already held.  At most one
+ * update is queued per core, however many cores are sending to it.
+ */
+static void arcon_irq_sync(CPUState *cs, run_on_cpu_data data)
+{
+    CPUARCState *env = &ARC_CPU(cs)->env;
+
+    qatomic_set(&env->arconnect.irq_sync_pending, 0);
+    /* Pairs with the barrier in arcon_irq_sync_schedule(). */
+    smp_mb();
+    qemu_set_irq(env->irq[ICI_IRQ],
+                 qatomic_read(&env->arconnect.intrpt_status) != 0);
+}
+
+static void arcon_irq_sync_schedule(ARCCPU *cpu)
+{
+    /* qatomic_xchg() is a full barrier after the mailbox update. */
+    if (qatomic_xchg(&cpu->env.arconnect.irq_sync_pending, 1) == 0) {
+        async_run_on_cpu(CPU(cpu), arcon_irq_sync, RUN_ON_CPU_NULL);
+    }
+}
+
+static void arcon_status_set(CPUARCState *env, ARCCPU *status_cpu,
+                             uint8_t sender_core_id)
 {
     ARCCPU *cpu = env_archcpu(env);
     qemu_log_mask(CPU_LOG_INT,
             "[ICI %d] Set intrpt_status in core %d for sender %d\n",
-            cpu->core_id, status_core_id, sender_core_id);
-    qatomic_or(&(get_cpu_for_core(status_core_id)->env.arconnect.intrpt_status),
-               1 << sender_core_id);
+            cpu->core_id, status_cpu->core_id, sender_core_id);
+    qatomic_or(&status_cpu->env.arconnect.intrpt_status,
+               1ULL << sender_core_id);
 }
-static void arcon_status_clr(CPUARCState *env, uint8_t status_core_id, uint8_t sender_core_id)
+static void arcon_status_clr(CPUARCState *env, ARCCPU *status_cpu,
+                             uint8_t sender_core_id)
 {
     ARCCPU *cpu = env_archcpu(env);
     qemu_log_mask(CPU_LOG_INT,
             "[ICI %d] Clear intrpt_status in core %d for sender %d\n",
-            cpu->core_id, status_core_id, sender_core_id);
-    qatomic_and(&(get_cpu_for_core(status_core_id)->env.arconnect.intrpt_status),
-                ~(1 << sender_core_id));
+            cpu->core_id, status_cpu->core_id, sender_core_id);
+    qatomic_and(&status_cpu->env.arconnect.intrpt_status,
+                ~(1ULL << sender_core_id));
 }
-static uint64_t arcon_status_read(CPUARCState *env, uint8_t core_id)
+static uint64_t arcon_status_read(CPUARCState *env, ARCCPU *status_cpu)
 {
     ARCCPU *cpu = env_archcpu(env);
-    uint64_t ret = qatomic_read(&(get_cpu_for_core(core_id)->env.arconnect.intrpt_status));
+    uint64_t ret = qatomic_read(&status_cpu->env.arconnect.intrpt_status);
     qemu_log_mask(CPU_LOG_INT,
-            "[ICI %d] Reading intrpt_status in core %d. (read: 0x%lx)\n",
-            cpu->core_id, core_id, ret);
+            "[ICI %d] Reading intrpt_status in core %d. (read: 0x%" PRIx64
+            ")\n", cpu->core_id, status_cpu->core_id, ret);
     return ret;
 }
 
@@ -160,33 +204,36 @@ static void arconnect_intercore_intr_unit_cmd(CPUARCState *env, enum arconnect_c
     case CMD_INTRPT_GENERATE_IRQ:
         {
           if(((param & 0x80) == 0) && ((param & 0x1f) != cpu->core_id)) {
-            uint8_t core_id = param & 0x1f;
-            arcon_status_set(env, core_id, cpu->core_id);
-            qemu_set_irq(get_cpu_for_core(core_id)->env.irq[MCIP_IRQ], 1);
+            ARCCPU *target = get_cpu_for_core(param & 0x1f);
+            if (target == NULL) {
+                qemu_log_mask(LOG_GUEST_ERROR,
+                              "[ICI %d] Interrupt for missing core %d\n",
+                              cpu->core_id, param & 0x1f);
+                break;
+            }
+            arcon_status_set(env, target, cpu->core_id);
+            arcon_irq_sync_schedule(target);
           }
-            //uint8_t core_id = CMD_COREID(cmd);
-            //CPUState *cs;
-            //CPU_FOREACH(cs) {
-            //    ARCCPU *cpu = ARC_CPU(cs);
-            //}
         }
         break;
     case CMD_INTRPT_GENERATE_ACK:
         {
             uint8_t core_id = param & 0x1f;
-            arcon_status_clr(env, cpu->core_id, core_id);
+            arcon_status_clr(env, cpu, core_id);
+            arcon_irq_sync_schedule(cpu);
         }
         break;
     case CMD_INTRPT_READ_STATUS:
         {
-            uint8_t core_id = param & 0x1f;
-            env->readback = (arcon_status_read(env, core_id) >> cpu->core_id) & 0x1;
+            ARCCPU *target = get_cpu_for_core(param & 0x1f);
+            env->readback = target == NULL ? 0 :
+                (arcon_status_read(env, target) >> cpu->core_id) & 0x1;
         }
         break;
 
     case CMD_INTRPT_CHECK_SOURCE:
         {
-            env->readback = arcon_status_read(env, cpu->core_id);
+            env->readback = arcon_status_read(env, cpu);
         }
 
         break;
@@ -231,7 +278,8 @@ static void arconnect_command_process(CPUARCState *env, uint32_t data)
         break;
 
     default:
-        assert(0);
+        qemu_log_mask(LOG_UNIMP, "[ICI %d] Unimplemented command 0x%x\n",
+                      cpu->core_id, cmd);
         break;
     };
 }
@@ -24,36 +24,11 @@
 #include "cpu-qom.h"
 #include "exec/cpu-defs.h"
 
-struct lpa_lf_entry {
-    QemuMutex mutex;
-    target_ulong lpa_lf;
-    uint64_t read_value;
-#ifdef TARGET_ARC32
-    uint64_t read_value1;
-#endif
-};
-
 struct arc_arcconnect_info {
-    uint64_t intrpt_status;
-
-    struct lpa_lf_entry *lpa_lf;
-    QemuMutex *locked_mutex;
+    uint64_t intrpt_status;     /* ICI mailbox, one bit per sender core. */
+    uint32_t irq_sync_pending;  /* MCIP line update queued on this core. */
 };
 
-#define LPA_LFS_ALIGNEMENT_BITS 2 /* Inforced alignement */
-#define LPA_LFS_ALIGNEMENT_MASK ((1 << LPA_LFS_ALIGNEMENT_BITS) - 1)
-#define LPA_LFS_SIZE_IN_BITS    8 /* Size for concurrent lpa_entries */
-#define LPA_LFS_SIZE            (1 << LPA_LFS_SIZE_IN_BITS)
-#define LPA_LFS_ENTRY_FOR_PA(PA) \
-    (((PA >> LPA_LFS_ALIGNEMENT_BITS)  \
-      ^ (PA >> (LPA_LFS_SIZE_IN_BITS + LPA_LFS_ALIGNEMENT_BITS))) \
-     & ((1 << LPA_LFS_SIZE_IN_BITS) - 1))
-
-#define LPA_LF_GET_ENTRY_FOR_VADDR(VADDR) \
-    
-    
-extern struct lpa_lf_entry lpa_lfs[LPA_LFS_SIZE];
-
 void arc_arconnect_init(ARCCPU *cpu);
 
 #endif /* __ARC_ARCONNECT_H__ */
@@ -182,6 +182,7 @@ static void arc_cpu_reset(DeviceState *dev)
 
     memset(env->r, 0, sizeof(env->r));
     env->lock_lf_var = 0;
+    env->exclusive_addr = -1;
 
     /*
      * kernel expects MPY support to check for presence of
@@ -35,6 +35,9 @@ typedef struct CPUArchState CPUARCState;
 
 #include "hw/registerfields.h"
 
+/* ARC memory is weakly ordered; DMB maps to explicit TCG barriers. */
+#define TCG_GUEST_DEFAULT_MO      (0)
+
 #define ARC_CPU_TYPE_SUFFIX "-" TYPE_ARC_CPU
 #define ARC_CPU_TYPE_NAME(name) (name ARC_CPU_TYPE_SUFFIX)
 #define CPU_RESOLVING_TYPE TYPE_ARC_CPU
@@ -193,8 +196,29 @@ typedef struct {
     target_ulong Cf;     /*  carry                   */
     target_ulong Nf;     /*  negative                */
     target_ulong Zf;     /*  zero                    */
+
+    /*
+     * Lazily evaluated carry and overflow.  When cc_op is not
+     * ARC_CC_OP_NONE, Cf and Vf are stale and must be derived from the
+     * result and operands of the last flag setting add/sub.
+     */
+    target_ulong cc_op;
+    target_ulong cc_dst;
+    target_ulong cc_src1;
+    target_ulong cc_src2;
 } ARCStatus;
 
+enum arc_cc_op {
+    ARC_CC_OP_NONE = 0,     /* Cf and Vf are up to date.  */
+    ARC_CC_OP_ADD,
+    ARC_CC_OP_ADD32,
+    ARC_CC_OP_SUB,
+    ARC_CC_OP_SUB32,
+    ARC_CC_OP_DYNAMIC,      /* Translation time only: check env.  */
+};
+
+void arc_status_compute_cv(ARCStatus *status_r);
+
 uint32_t pack_status32(ARCStatus *status_r);
 void unpack_status32(ARCStatus *status_r, uint32_t value);
 
@@ -202,7 +226,8 @@ void unpack_status32(ARCStatus *status_r, uint32_t value);
 typedef struct {
     target_ulong T_Cntrl;
     target_ulong T_Limit;
-    uint64_t last_clk;
+    uint64_t last_clk;  /* Virtual time at which COUNT was 0. */
+    int64_t deadline;   /* Virtual time the QEMUTimer is armed for. */
 } ARCTimer;
 
 /* ARC PIC interrupt bancked regs. */
@@ -445,12 +470,34 @@ static inline int cpu_mmu_index(const CPUARCState *env, bool ifetch)
     return GET_STATUS_BIT(env->stat, Uf) != 0 ? 1 : 0;
 }
 
+/*
+ * cs_base tells the translator where the current zero-overhead loop ends,
+ * as in target/xtensa: the offset of LP_END from the page of the TB, or 0
+ * when no instruction starting in this page can end at LP_END.  When
+ * LP_START is close enough, its distance back from LP_END is kept too so
+ * that the loop can be closed with a direct jump.
+ */
+#define ARC_CSBASE_LPE_MASK         0x0000ffff
+#define ARC_CSBASE_LPS_OFF_MASK     0xffff0000
+#define ARC_CSBASE_LPS_OFF_SHIFT    16
+#define ARC_MAX_INSN_SIZE           8
+
 static inline void cpu_get_tb_cpu_state(CPUARCState *env, target_ulong *pc,
                                         target_ulong *cs_base,
                                         uint32_t *pflags)
 {
+    target_ulong lpe_dist = env->lpe - (env->pc & TARGET_PAGE_MASK);
+
     *pc = env->pc;
     *cs_base = 0;
+    if (lpe_dist != 0 && lpe_dist <= TARGET_PAGE_SIZE + ARC_MAX_INSN_SIZE) {
+        target_ulong lps_off = env->lpe - env->lps;
+
+        *cs_base = lpe_dist;
+        if (lps_off <= (ARC_CSBASE_LPS_OFF_MASK >> ARC_CSBASE_LPS_OFF_SHIFT)) {
+            *cs_base |= lps_off << ARC_CSBASE_LPS_OFF_SHIFT;
+        }
+    }
 #ifndef CONFIG_USER_ONLY
     *pflags = cpu_mmu_index(env, 0);
 #else
@@ -480,6 +527,17 @@ int gdb_v3_core_write(CPUState *cpu, uint8_t *buf, int reg);
 void do_arc_semihosting(CPUARCState *env);
 void arc_sim_open_console(Chardev *chr);
 
+typedef enum ArcSemiFlush {
+    ARC_SEMI_FLUSH_NONE,            /* write through */
+    ARC_SEMI_FLUSH_LINE,            /* on newline, full buffer and exit */
+    ARC_SEMI_FLUSH_FULL,            /* on full buffer and exit */
+} ArcSemiFlush;
+
+const char *arc_semihosting_get_flush(void);
+void arc_semihosting_set_flush(const char *policy, Error **errp);
+size_t arc_semihosting_get_bufsize(void);
+void arc_semihosting_set_bufsize(size_t size, Error **errp);
+
 void QEMU_NORETURN arc_raise_exception(CPUARCState *env, uintptr_t host_pc, int32_t excp_idx);
 
 void arc_mmu_init(CPUARCState *env);
@@ -66,24 +66,23 @@
 
 
 
-static insn_t
+static bool
 load_insninfo_if_valid_v2(uint64_t insn,
                        uint8_t insn_len,
                        uint32_t isa_mask,
-                       bool *invalid,
-                       const struct arc_opcode *opcode)
+                       const struct arc_opcode *opcode,
+                       insn_t *ret)
 {
     const uint8_t *opidx;
     const uint8_t *flgidx;
     bool has_limm = false;
-    insn_t ret;
+    bool invalid = false;
 
-    *invalid = false;
     uint32_t noperands = 0;
 
     has_limm = false;
     noperands = 0;
-    memset(&ret, 0, sizeof(insn_t));
+    memset(ret, 0, sizeof(*ret));
 
     /* Possible candidate, check the operands. */
     for (opidx = opcode->operands; *opidx; ++opidx) {
@@ -95,7 +94,7 @@ load_insninfo_if_valid_v2(uint64_t insn,
         }
 
         if (operand->extract) {
-            value = (*operand->extract)(insn, invalid);
+            value = (*operand->extract)(insn, &invalid);
         } else {
             value = (insn >> operand->shift) & ((1 << operand->bits) - 1);
         }
@@ -109,7 +108,7 @@ load_insninfo_if_valid_v2(uint64_t insn,
             !(operand->flags & ARC_OPERAND_LIMM)) {
             if ((value == 0x3E && insn_len == 4) ||
                 (value == limmind && insn_len == 2)) {
-                *invalid = TRUE;
+                invalid = TRUE;
                 break;
             }
         }
@@ -118,7 +117,7 @@ load_insninfo_if_valid_v2(uint64_t insn,
             !(operand->flags & ARC_OPERAND_DUPLICATE)) {
             has_limm = true;
             if (operand->flags & ARC_OPERAND_16_SPLIT) {
-                ret.limm_split_16_p = true;
+                ret->limm_split_16_p = true;
             }
         } else {
             if (operand->flags & ARC_OPERAND_16_SPLIT) {
@@ -127,10 +126,10 @@ load_insninfo_if_valid_v2(uint64_t insn,
             }
         }
 
-        ret.operands[noperands].value = value;
-        ret.operands[noperands].type = operand->flags;
+        ret->operands[noperands].value = value;
+        ret->operands[noperands].type = operand->flags;
         noperands += 1;
-        ret.n_ops = noperands;
+        ret->n_ops = noperands;
     }
 
     /* Check the flags. */
@@ -150,11 +149,11 @@ load_insninfo_if_valid_v2(uint64_t insn,
             /* Check for the implicit flags. */
             if (cl_flags->flag_class & F_CLASS_IMPLICIT) {
                 if (cl_flags->flag_class & F_CLASS_COND) {
-                    ret.cc = flg_operand->code;
+                    ret->cc = flg_operand->code;
                 } else if (cl_flags->flag_class & F_CLASS_WB) {
-                    ret.aa = flg_operand->code;
+                    ret->aa = flg_operand->code;
                 } else if (cl_flags->flag_class & F_CLASS_ZZ) {
-                    ret.zz = flg_operand->code;
+                    ret->zz = flg_operand->code;
                 }
                 continue;
             }
@@ -171,14 +170,14 @@ load_insninfo_if_valid_v2(uint64_t insn,
                 if (cl_flags->flag_class & F_CLASS_ZZ) {
                     switch (flg_operand->name[0]) {
                     case 'b':
-                        ret.zz = 1;
+                        ret->zz = 1;
                         break;
                     case 'h':
                     case 'w':
-                        ret.zz = 2;
+                        ret->zz = 2;
                         break;
                     default:
-                        ret.zz = 4;
+                        ret->zz = 4;
                         break;
                     }
                 }
@@ -188,31 +187,31 @@ load_insninfo_if_valid_v2(uint64_t insn,
                  * sets this to true.
                  */
                 if (cl_flags->flag_class & F_CLASS_D) {
-                    ret.d = value ? true : false;
+                    ret->d = value ? true : false;
                     if (cl_flags->flags[0] == F_DFAKE) {
-                        ret.d = true;
+                        ret->d = true;
                     }
                 }
 
                 if (cl_flags->flag_class & F_CLASS_COND) {
-                    ret.cc = value;
+                    ret->cc = value;
                 }
 
                 if (cl_flags->flag_class & F_CLASS_WB
                     || cl_flags->flag_class & F_CLASS_AS) {
-                    ret.aa = value;
+                    ret->aa = value;
                 }
 
                 if (cl_flags->flag_class & F_CLASS_F) {
-                    ret.f = true;
+                    ret->f = true;
                 }
 
                 if (cl_flags->flag_class & F_CLASS_DI) {
-                    ret.di = true;
+                    ret->di = true;
                 }
 
                 if (cl_flags->flag_class & F_CLASS_X) {
-                    ret.x = true;
+                    ret->x = true;
                 }
 
                 foundA = true;
@@ -223,24 +222,24 @@ load_insninfo_if_valid_v2(uint64_t insn,
         }
 
         if (!foundA && foundB) {
-            *invalid = TRUE;
+            invalid = TRUE;
             break;
         }
     }
 
-    if (*invalid == TRUE) {
-        return ret;
+    if (invalid == TRUE) {
+        return false;
     }
 
     /* The instruction is valid. */
-    ret.limm_p = has_limm;
-    ret.class = (uint32_t) opcode->insn_class;
+    ret->limm_p = has_limm;
+    ret->class = (uint32_t) opcode->insn_class;
 
     /*
      * FIXME: here add extra info about the instruction
      * e.g. delay slot, data size, write back, etc.
      */
-    return ret;
+    return true;
 }
 
 /* Main entry point for this file. */
@@ -249,24 +248,33 @@ const struct arc_opcode *arc_find_format_v2(insn_t *insnd,
                                          uint8_t insn_len,
                                          uint32_t isa_mask)
 {
-    enum opcode multi_match[10];
-    const struct arc_opcode *ret = NULL;
+    enum opcode multi_match[ARC_DECODE_MAX_MATCHES];
 
-    unsigned char mcount = find_insn_for_opcode(insn, isa_mask, insn_len, multi_match);
+    unsigned char mcount = arc_decode_table_lookup(insn, isa_mask, insn_len,
+                                                   multi_match);
+#ifdef CONFIG_DEBUG_TCG
+    arc_decode_table_verify(insn, isa_mask, insn_len, multi_match, mcount);
+#endif
     /* TODO: This should eventually trigger invalid instruction exception */
     assert(mcount != 0);
 
-    for(unsigned char i = 0; i < mcount; i++) {
-        bool invalid = FALSE;
-        insn_t tmp = load_insninfo_if_valid_v2(insn, insn_len, isa_mask, &invalid, &arc_opcodes[multi_match[i]]);
+    /*
+     * The last valid candidate wins.  Walk them backwards, so that only
+     * the winner is fully decoded.  Rejected candidates leave a partial
+     * decode behind, keep it out of INSND.
+     */
+    while (mcount-- > 0) {
+        const struct arc_opcode *opcode = &arc_opcodes[multi_match[mcount]];
+        insn_t tmp;
 
-        if(invalid == FALSE) {
+        if (load_insninfo_if_valid_v2(insn, insn_len, isa_mask, opcode,
+                                      &tmp)) {
             *insnd = tmp;
-            ret = &arc_opcodes[multi_match[i]];
+            return opcode;
         }
     }
 
-    return ret;
+    return NULL;
 }
 
 /*
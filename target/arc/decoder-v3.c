@@ -113,26 +113,25 @@ arc_opcode_to_insn_type_v3 (const struct arc_opcode *opcode)
 
 static bool special_flag_p_v3(const char *opname, const char *flgname);
 
-static insn_t
+static bool
 load_insninfo_if_valid_v3(uint64_t insn,
                        uint8_t insn_len,
                        uint32_t isa_mask,
-                       bool *invalid,
-                       const struct arc_opcode *opcode)
+                       const struct arc_opcode *opcode,
+                       insn_t *ret)
 {
     const uint8_t *opidx;
     const uint8_t *flgidx;
     bool has_limm_signed = false;
     bool has_limm_unsigned = false;
-    insn_t ret;
+    bool invalid = false;
 
-    *invalid = false;
     uint32_t noperands = 0;
 
     has_limm_signed = false;
     has_limm_unsigned = false;
     noperands = 0;
-    memset(&ret, 0, sizeof (insn_t));
+    memset(ret, 0, sizeof(*ret));
 
     has_limm_signed = false;
     has_limm_unsigned = false;
@@ -147,7 +146,7 @@ load_insninfo_if_valid_v3(uint64_t insn,
         }
 
         if (operand->extract) {
-            value = (*operand->extract)(insn, invalid);
+            value = (*operand->extract)(insn, &invalid);
         }
         else {
             value = (insn >> operand->shift) & ((1 << operand->bits) - 1);
@@ -164,7 +163,7 @@ load_insninfo_if_valid_v3(uint64_t insn,
               || (isa_mask & ARC_OPCODE_ARC64
                   && (value == REG_S32) && (insn_len == 4)))
             {
-              *invalid = TRUE;
+              invalid = TRUE;
               break;
             }
 
@@ -181,7 +180,7 @@ load_insninfo_if_valid_v3(uint64_t insn,
         if (operand->flags & ARC_OPERAND_LIMM &&
             !(operand->flags & ARC_OPERAND_DUPLICATE)) {
             if (operand->flags & ARC_OPERAND_32_SPLIT) {
-                ret.limm_split_32_p = true;
+                ret->limm_split_32_p = true;
             }
         } else {
             if (operand->flags & ARC_OPERAND_32_SPLIT) {
@@ -201,10 +200,10 @@ load_insninfo_if_valid_v3(uint64_t insn,
             }
         }
 
-        ret.operands[noperands].value = value;
-        ret.operands[noperands].type = operand->flags;
+        ret->operands[noperands].value = value;
+        ret->operands[noperands].type = operand->flags;
         noperands += 1;
-        ret.n_ops = noperands;
+        ret->n_ops = noperands;
     }
 
     /* Preselect the insn class.  */
@@ -227,13 +226,13 @@ load_insninfo_if_valid_v3(uint64_t insn,
             /* Check for the implicit flags. */
             if (cl_flags->flag_class & F_CLASS_IMPLICIT) {
                 if (cl_flags->flag_class & F_CLASS_COND) {
-                    ret.cc = flg_operand->code;
+                    ret->cc = flg_operand->code;
                 }
                 else if (cl_flags->flag_class & F_CLASS_WB) {
-                    ret.aa = flg_operand->code;
+                    ret->aa = flg_operand->code;
                 }
                 else if (cl_flags->flag_class & F_CLASS_ZZ) {
-                    ret.zz_as_data_size = flg_operand->code;
+                    ret->zz_as_data_size = flg_operand->code;
                 }
                 continue;
             }
@@ -253,14 +252,14 @@ load_insninfo_if_valid_v3(uint64_t insn,
                 {
                     switch (flg_operand->name[0]) {
                     case 'b':
-                        ret.zz_as_data_size = 1;
+                        ret->zz_as_data_size = 1;
                         break;
                     case 'h':
                     case 'w':
-                        ret.zz_as_data_size = 2;
+                        ret->zz_as_data_size = 2;
                         break;
                     default:
-                        ret.zz_as_data_size = 0;
+                        ret->zz_as_data_size = 0;
                         break;
                     }
                 }
@@ -270,34 +269,34 @@ load_insninfo_if_valid_v3(uint64_t insn,
                  * sets this to true.
                  */
                 if (cl_flags->flag_class & F_CLASS_D) {
-                    ret.d = value ? true : false;
+                    ret->d = value ? true : false;
                     if (cl_flags->flags[0] == F_DFAKE) {
-                        ret.d = true;
+                        ret->d = true;
                     }
                 }
 	            if (flg_operand->name[0] == 'd'
                     && flg_operand->name[1] == 0)
-                    ret.d = true;
+                    ret->d = true;
 
                 if (cl_flags->flag_class & F_CLASS_COND) {
-                    ret.cc = value;
+                    ret->cc = value;
                 }
 
                 if (cl_flags->flag_class & F_CLASS_WB
                     || cl_flags->flag_class & F_CLASS_AS) {
-                    ret.aa = value;
+                    ret->aa = value;
                 }
 
                 if (cl_flags->flag_class & F_CLASS_F) {
-                    ret.f = true;
+                    ret->f = true;
                 }
 
                 if (cl_flags->flag_class & F_CLASS_DI) {
-                    ret.di = true;
+                    ret->di = true;
                 }
 
                 if (cl_flags->flag_class & F_CLASS_X) {
-                    ret.x = true;
+                    ret->x = true;
                 }
 
                 foundA = true;
@@ -308,21 +307,21 @@ load_insninfo_if_valid_v3(uint64_t insn,
         }
 
         if (!foundA && foundB) {
-            *invalid = TRUE;
+            invalid = TRUE;
             break;
         }
     }
 
-    if (*invalid == TRUE) {
-        return ret;
+    if (invalid == TRUE) {
+        return false;
     }
 
     /* The instruction is valid. */
-    ret.signed_limm_p = has_limm_signed;
-    ret.unsigned_limm_p = has_limm_unsigned;
-    ret.class = (uint32_t) opcode->insn_class;
+    ret->signed_limm_p = has_limm_signed;
+    ret->unsigned_limm_p = has_limm_unsigned;
+    ret->class = (uint32_t) opcode->insn_class;
 
-    return ret;
+    return true;
 }
 
 /* Helper to be used by the disassembler. */
@@ -331,24 +330,32 @@ const struct arc_opcode *arc_find_format_v3(insn_t *insnd,
                                          uint8_t insn_len,
                                          uint32_t isa_mask)
 {
-    enum opcode multi_match[10];
-    const struct arc_opcode *ret = NULL;
+    enum opcode multi_match[ARC_DECODE_MAX_MATCHES];
 
-    unsigned char mcount = find_insn_for_opcode(insn, isa_mask, insn_len, multi_match);
+    unsigned char mcount = arc_decode_table_lookup(insn, isa_mask, insn_len,
+                                                   multi_match);
+#ifdef CONFIG_DEBUG_TCG
+    arc_decode_table_verify(insn, isa_mask, insn_len, multi_match, mcount);
+#endif
     /* TODO: This should eventually trigger invalid instruction exception */
     assert(mcount != 0);
 
-    for(unsigned char i = 0; i < mcount; i++) {
-        bool invalid = FALSE;
-        insn_t tmp = load_insninfo_if_valid_v3(insn, insn_len, isa_mask, &invalid, &arc_opcodes[multi_match[i]]);
+    /*
+     * The first valid candidate wins.  Rejected candidates leave a
+     * partial decode behind, keep it out of INSND.
+     */
+    for (unsigned char i = 0; i < mcount; i++) {
+        const struct arc_opcode *opcode = &arc_opcodes[multi_match[i]];
+        insn_t tmp;
 
-        if(invalid == FALSE) {
+        if (load_insninfo_if_valid_v3(insn, insn_len, isa_mask, opcode,
+                                      &tmp)) {
             *insnd = tmp;
-            return &arc_opcodes[multi_match[i]];
+            return opcode;
         }
     }
 
-    return ret;
+    return NULL;
 }
 
 #define ARRANGE_ENDIAN(info, buf)                                       \
@@ -1323,3 +1323,169 @@ find_insn_for_opcode(uint64_t insn, uint16_t cpu_type, unsigned int len, enum op
 #undef MATCH_VALUE
 #undef RETURN_MATCH
 #undef MULTI_MATCH
+
+/*
+ * Flat decode tables, generated from the same opcode tables as the
+ * decision trees above (see decoder_fragments/arc_gen_decoder.py).
+ */
+struct arc_decode_node {
+    /* Bit field switched on by an inner node, BITS is zero for a leaf. */
+    uint8_t shift;
+    uint8_t bits;
+    /* First child of an inner node or first candidate of a leaf. */
+    uint16_t base;
+    /* Number of candidates of a leaf. */
+    uint8_t count;
+    /* Candidates must still be matched against their opcode mask. */
+    uint8_t check;
+};
+
+struct arc_decode_candidate {
+    /* Opcode and mask of arc_opcodes[INDEX], kept next to each other. */
+    uint32_t opcode;
+    uint32_t mask;
+    uint16_t index;
+};
+
+struct arc_decode_table {
+    const struct arc_decode_node *nodes;
+    const struct arc_decode_candidate *candidates;
+};
+
+#define DECODE_NODE(SHIFT, BITS, BASE, COUNT, CHECK) \
+    { SHIFT, BITS, BASE, COUNT, CHECK },
+#define DECODE_CANDIDATE(MATCH, OPCODE, MASK)
+#if defined TARGET_ARC32
+static const struct arc_decode_node arc_dtable_v2_hs_nodes[] = {
+#include "v2_hs_dtable.def"
+};
+static const struct arc_decode_node arc_dtable_v2_em_nodes[] = {
+#include "v2_em_dtable.def"
+};
+static const struct arc_decode_node arc_dtable_v3_hs5x_nodes[] = {
+#include "v3_hs5x_dtable.def"
+};
+#elif defined TARGET_ARC64
+static const struct arc_decode_node arc_dtable_v3_hs6x_nodes[] = {
+#include "v3_hs6x_dtable.def"
+};
+#endif
+#undef DECODE_NODE
+#undef DECODE_CANDIDATE
+
+#define DECODE_NODE(SHIFT, BITS, BASE, COUNT, CHECK)
+#define DECODE_CANDIDATE(MATCH, OPCODE, MASK) { OPCODE, MASK, MATCH },
+#if defined TARGET_ARC32
+static const struct arc_decode_candidate arc_dtable_v2_hs_candidates[] = {
+#include "v2_hs_dtable.def"
+};
+static const struct arc_decode_candidate arc_dtable_v2_em_candidates[] = {
+#include "v2_em_dtable.def"
+};
+static const struct arc_decode_candidate arc_dtable_v3_hs5x_candidates[] = {
+#include "v3_hs5x_dtable.def"
+};
+#elif defined TARGET_ARC64
+static const struct arc_decode_candidate arc_dtable_v3_hs6x_candidates[] = {
+#include "v3_hs6x_dtable.def"
+};
+#endif
+#undef DECODE_NODE
+#undef DECODE_CANDIDATE
+
+QEMU_BUILD_BUG_ON(OPCODE_SIZE > UINT16_MAX);
+
+static const struct arc_decode_table *arc_decode_table_for(uint16_t cpu_type)
+{
+#if defined TARGET_ARC32
+    static const struct arc_decode_table v2_hs = {
+        arc_dtable_v2_hs_nodes, arc_dtable_v2_hs_candidates
+    };
+    static const struct arc_decode_table v2_em = {
+        arc_dtable_v2_em_nodes, arc_dtable_v2_em_candidates
+    };
+    static const struct arc_decode_table v3_hs5x = {
+        arc_dtable_v3_hs5x_nodes, arc_dtable_v3_hs5x_candidates
+    };
+
+    switch (cpu_type) {
+    case ARC_OPCODE_ARCv2HS:
+        return &v2_hs;
+    case ARC_OPCODE_ARCv2EM:
+        return &v2_em;
+    case ARC_OPCODE_ARC32:
+        return &v3_hs5x;
+    }
+#elif defined TARGET_ARC64
+    static const struct arc_decode_table v3_hs6x = {
+        arc_dtable_v3_hs6x_nodes, arc_dtable_v3_hs6x_candidates
+    };
+
+    switch (cpu_type) {
+    case ARC_OPCODE_ARC64:
+        return &v3_hs6x;
+    }
+#else
+#error "TARGET macro not defined!"
+#endif
+    g_assert_not_reached();
+}
+
+/*
+ * Same contract as find_insn_for_opcode(), but walking the flat decode
+ * table: one shift, mask and indexed load per level instead of a chain
+ * of switches.
+ * Only candidates that match INSN are returned, in decision tree order.
+ */
+unsigned char
+arc_decode_table_lookup(uint64_t insn, uint16_t cpu_type, unsigned int len,
+                        enum opcode *multi_match)
+{
+    const struct arc_decode_table *table = arc_decode_table_for(cpu_type);
+    unsigned int shift = (len % 4);
+    uint32_t opcode = insn << (8 * shift);
+    const struct arc_decode_node *node = &table->nodes[0];
+    const struct arc_decode_candidate *cand;
+    unsigned char count = 0;
+    unsigned int i;
+
+    while (node->bits != 0) {
+        uint32_t field = (opcode >> node->shift) & ((1u << node->bits) - 1);
+
+        node = &table->nodes[node->base + field];
+    }
+
+    cand = &table->candidates[node->base];
+    if (!node->check) {
+        if (node->count == 1) {
+            multi_match[count++] = (enum opcode) cand[0].index;
+        }
+        return count;
+    }
+
+    /*
+     * Store every candidate and only advance past the matching ones.  The
+     * generator keeps leaves within ARC_DECODE_MAX_MATCHES candidates.
+     */
+    opcode >>= 8 * shift;
+    for (i = 0; i < node->count; i++) {
+        multi_match[count] = (enum opcode) cand[i].index;
+        count += (opcode & cand[i].mask) == cand[i].opcode;
+    }
+    return count;
+}
+
+#ifdef CONFIG_DEBUG_TCG
+/* Replay INSN through the decision tree and check both decoders agree. */
+void arc_decode_table_verify(uint64_t insn, uint16_t cpu_type,
+                             unsigned int len, const enum opcode *multi_match,
+                             unsigned char count)
+{
+    enum opcode tree_match[ARC_DECODE_MAX_MATCHES];
+    unsigned char tree_count;
+
+    tree_count = find_insn_for_opcode(insn, cpu_type, len, tree_match);
+    assert(tree_count == count);
+    assert(memcmp(tree_match, multi_match, count * sizeof(*tree_match)) == 0);
+}
+#endif
@@ -456,8 +456,23 @@ extern const struct arc_opcode arc_opcodes[];
 
 /* Common prototypes */
 
+/*
+ * Upper bound on the opcodes a single instruction word can match: the
+ * LIMM variants of DMACWHF and FDDIV alone give 16 for 0x36377fbe.
+ * arc_gen_decoder.py refuses to generate decoders that could exceed it.
+ */
+#define ARC_DECODE_MAX_MATCHES 40
+
 unsigned char
 find_insn_for_opcode(uint64_t insn, uint16_t cpu_type, unsigned int len, enum opcode *multi_match);
+unsigned char
+arc_decode_table_lookup(uint64_t insn, uint16_t cpu_type, unsigned int len,
+                        enum opcode *multi_match);
+#ifdef CONFIG_DEBUG_TCG
+void arc_decode_table_verify(uint64_t insn, uint16_t cpu_type,
+                             unsigned int len, const enum opcode *multi_match,
+                             unsigned char count);
+#endif
 const char *get_register_name(int value);
 const char *get_fpregister_name(int value);
 
@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 
 import opcode
+import os
 import re
 import sys
 import getopt
@@ -355,6 +356,273 @@ def print_as_macros(file, tree, level = 0):
     if level > 0:
         file.write(f"{'  '*level}END_MATCH_VALUE({hex(value)}) /* {format(value, 'b')} */\n")
 
+#
+# Flat decode tables.
+#
+# The decision tree above is flattened into two arrays per ISA: a node
+# array and a candidate array.  An inner node switches on one bit field
+# of the instruction, given by its shift and width, and holds the index
+# of its first child; its children are stored contiguously and are
+# indexed by the value of the field.  When the tree switches on bits that
+# are not contiguous, the field spans all of them and the children are
+# repeated for the bits in between; if that wastes too much, the switch
+# becomes one node per run of contiguous bits instead.  A leaf holds a
+# slice of the candidate array, each candidate carrying its opcode and
+# mask.  Leaves that the tree left with several candidates are split once
+# more on the bits where the candidates' masks disagree, so that fewer
+# candidates are compared against the instruction word.  The candidate
+# order of the tree is preserved, hence the decoders that walk the tables
+# pick the same opcode as the tree did.
+#
+# Neither the tree nor the table tells apart candidates that only differ
+# by their operands (e.g. a register field holding the LIMM marker):
+# load_insninfo_if_valid_*() still checks those one by one.
+#
+
+# Upper bound on the bits used to split a multi-candidate leaf.
+REFINE_MAX_BITS = 2
+
+# Most bits a switch may ignore inside the span of its mask before it
+# is split into one switch per field.
+SPLIT_MAX_HOLES = 3
+
+# ARC_DECODE_MAX_MATCHES in decoder.h.
+DECODE_MAX_MATCHES = 40
+
+def pext(value, mask):
+    ret = 0
+    bit = 0
+    while mask:
+        low = mask & -mask
+        if value & low:
+            ret |= 1 << bit
+        bit += 1
+        mask &= mask - 1
+    return ret
+
+
+def refine_candidates(elems, filter_mask):
+    """Split a multi-candidate leaf on the bits its candidates disagree on."""
+    score = {}
+    for opc in elems:
+        bits = opc['mask'] & ~filter_mask & ((1 << 32) - 1)
+        while bits:
+            low = bits & -bits
+            score[low] = score.get(low, 0) + 1
+            bits &= bits - 1
+
+    # The bits most candidates care about discriminate the best.
+    best = sorted(score, key=lambda b: (-score[b], -b))[:REFINE_MAX_BITS]
+    refine = 0
+    for bit in best:
+        refine |= bit
+
+    if refine == 0:
+        return None
+
+    children = []
+    for value in versions_for_mask(refine):
+        children.append([opc for opc in elems
+                         if opc['opcode'] & opc['mask'] & refine
+                            == value & opc['mask']])
+    return (refine, children)
+
+
+def mask_fields(mask):
+    """Split MASK into its runs of contiguous bits, highest first."""
+    fields = []
+    while mask:
+        shift = (mask & -mask).bit_length() - 1
+        bits = 0
+        while mask & (1 << (shift + bits)):
+            bits += 1
+        fields.insert(0, (shift, bits))
+        mask &= ~(((1 << bits) - 1) << shift)
+    return fields
+
+
+def flatten_tree(tree):
+    """Return the (nodes, candidates) arrays for TREE.
+
+    Each node is a tuple (shift, bits, base, count, check).  For inner
+    nodes COUNT is zero and BASE is the index of the first child; for
+    leaves BITS is zero and BASE/COUNT describe a slice of CANDIDATES.
+    CHECK is set when the candidates must still be compared against the
+    opcode mask at run time (the tree's MULTI_MATCH semantic).
+    """
+    nodes = [None]
+    candidates = []
+
+    def emit_leaf(idx, elems, check):
+        nodes[idx] = (0, 0, len(candidates), len(elems), check)
+        candidates.extend(elems)
+
+    def emit_switch(idx, mask):
+        """Switch node IDX on MASK.
+
+        Return, for each child in the order of the packed MASK bits, the
+        slots that must hold that child.
+        """
+        fields = mask_fields(mask)
+        (shift, bits) = fields[0]
+        low = fields[-1][0]
+        span = shift + bits - low
+        if span - bin(mask).count('1') <= SPLIT_MAX_HOLES:
+            # One field spanning the whole mask; the slots of the bits
+            # in between that the mask ignores all hold the same child.
+            base = len(nodes)
+            nodes.extend([None] * (1 << span))
+            nodes[idx] = (low, span, base, 0, False)
+            slots = [[] for _ in range(1 << bin(mask).count('1'))]
+            for i in range(1 << span):
+                slots[pext(i << low, mask)].append(base + i)
+            return slots
+        # Otherwise one node per field, highest first.
+        top = ((1 << bits) - 1) << shift
+        slots = []
+        for sub in emit_switch(idx, top):
+            slots.extend(emit_switch(sub[0], mask & ~top))
+        return slots
+
+    def emit_child(slots, emit):
+        emit(slots[0])
+        for slot in slots[1:]:
+            nodes[slot] = nodes[slots[0]]
+
+    def walk(idx, node):
+        data = node['data']
+        if 'subtrees' in node:
+            subtrees = list(node['subtrees'].values())
+            slots = emit_switch(idx, data['pattern_mask'])
+            for child, sub in zip(slots, subtrees):
+                emit_child(child, lambda slot: walk(slot, sub))
+        elif data['count'] <= 1:
+            # Either no match or the tree's RETURN_MATCH.
+            emit_leaf(idx, data['elems'], False)
+        else:
+            refined = refine_candidates(data['elems'], data['filter_mask'])
+            if refined is None:
+                emit_leaf(idx, data['elems'], True)
+                return
+            (mask, children) = refined
+            slots = emit_switch(idx, mask)
+            for child, elems in zip(slots, children):
+                emit_child(child, lambda slot: emit_leaf(slot, elems, True))
+
+    walk(0, tree)
+    return (nodes, candidates)
+
+
+def tree_max_matches(tree):
+    """Most opcodes the tree's MULTI_MATCH can return for one word."""
+    if 'subtrees' in tree:
+        return max(tree_max_matches(sub) for sub in tree['subtrees'].values())
+    return len(tree['data']['elems'])
+
+
+def print_table(file, arch, nodes, candidates):
+    # struct arc_decode_node stores BASE and COUNT in 16 and 8 bits.
+    if len(nodes) > 0xffff or len(candidates) > 0xffff:
+        error(0, f'{arch}: decode table too large')
+    if max(count for (_, _, _, count, _) in nodes) > DECODE_MAX_MATCHES:
+        error(0, f'{arch}: decode table leaf too large')
+
+    file.write(f'/* {arch}: {len(nodes)} nodes, {len(candidates)} candidates. */\n')
+    for i, (shift, bits, base, count, check) in enumerate(nodes):
+        file.write(f'DECODE_NODE({shift}, {bits}, {base}, {count}, {int(check)}) /* {i} */\n')
+    for i, opc in enumerate(candidates):
+        file.write(f'DECODE_CANDIDATE({enum_for_opcode(opc)}, '
+                   f'{opc["opcode_orig"]}, {opc["mask_orig"]}) /* {i} */\n')
+
+
+def tree_lookup(tree, word):
+    """Reference walk of the decision tree, as find_insn_for_opcode()."""
+    node = tree
+    while 'subtrees' in node:
+        mask = node['data']['pattern_mask']
+        node = node['subtrees'][word & mask]
+    elems = node['data']['elems']
+    if len(elems) == 1:
+        return elems
+    return [opc for opc in elems if word & opc['mask'] == opc['opcode']]
+
+
+def table_leaf(nodes, word):
+    """Leaf of the flat table reached by WORD."""
+    (shift, bits, base, count, check) = nodes[0]
+    while bits != 0:
+        field = (word >> shift) & ((1 << bits) - 1)
+        (shift, bits, base, count, check) = nodes[base + field]
+    return (base, count, check)
+
+
+def table_lookup(nodes, candidates, word):
+    """Reference walk of the flat table, as arc_decode_table_lookup()."""
+    (base, count, check) = table_leaf(nodes, word)
+    elems = candidates[base:base + count]
+    if not check:
+        return elems
+    return [opc for opc in elems if word & opc['mask'] == opc['opcode']]
+
+
+def build_corpus(arch, samples, rng):
+    """Encode every opcode of ARCH with random values in its free bits."""
+    corpus = []
+    for opc in opcode_input_data:
+        if opc['cpu'] != arch:
+            continue
+        free = ((1 << 32) - 1) & ~opc['mask']
+        if opc['size'] == 16:
+            free &= 0xffff0000
+        for _ in range(samples):
+            corpus.append(opc['opcode'] | (rng.getrandbits(32) & free))
+    return corpus
+
+
+def check_table(arch, tree, nodes, candidates, samples):
+    """Replay a corpus through both decoders and check they agree."""
+    import random
+
+    rng = random.Random(arch)
+    corpus = build_corpus(arch, samples, rng)
+
+    # Candidates handed to load_insninfo_if_valid_*() per word, by the
+    # tree, by the table, and at best: those matching the opcode mask,
+    # which only the operand checks tell apart.
+    tree_cands = 0
+    table_cands = 0
+    matches = 0
+    for word in corpus:
+        exp = tree_lookup(tree, word)
+        res = table_lookup(nodes, candidates, word)
+        if [enum_for_opcode(o) for o in exp] != [enum_for_opcode(o) for o in res]:
+            error(0, f'{arch}: decoders disagree on {hex(word)}')
+
+        node = tree
+        while 'subtrees' in node:
+            node = node['subtrees'][word & node['data']['pattern_mask']]
+        tree_cands += len(node['data']['elems'])
+        table_cands += table_leaf(nodes, word)[1]
+        matches += len(res)
+
+    print(f'{arch}: {len(corpus)} words agree; candidates/word: '
+          f'tree {tree_cands / len(corpus):.2f}, '
+          f'table {table_cands / len(corpus):.2f}, '
+          f'matching {matches / len(corpus):.2f}',
+          file=sys.stderr)
+
+
+def gen_table(arch, file, check_samples):
+    tree = traverse(0, 0, 0, arch)
+    if tree_max_matches(tree) > DECODE_MAX_MATCHES:
+        error(0, f'{arch}: decision tree leaf too large')
+    (nodes, candidates) = flatten_tree(tree)
+    if check_samples:
+        check_table(arch, tree, nodes, candidates, check_samples)
+    with open(file, "w") as of:
+        print_table(of, arch, nodes, candidates)
+
+
 def load_opcode_input_data():
     for opc in opcodes_cls:
         opcode = int(opc.opcode_orig, 16)
@@ -373,6 +641,8 @@ def load_opcode_input_data():
 
 def gen_tree(arch, file):
     tree = traverse(0, 0, 0, arch)
+    if tree_max_matches(tree) > DECODE_MAX_MATCHES:
+        error(0, f'{arch}: decision tree leaf too large')
     of = open(file, "w")
     print_as_macros(of, tree)
     of.close
@@ -388,7 +658,11 @@ def main():
     arcv2em_file = None
     arcv3hs6x_file = None
     arcv3hs5x_file = None
-    long_opts = ['opcodes=', 'arcv2hs=', 'arcv2em=', 'arcv3hs5x=', 'arcv3hs6x=']
+    tables = {}
+    check_samples = 0
+    long_opts = ['opcodes=', 'arcv2hs=', 'arcv2em=', 'arcv3hs5x=', 'arcv3hs6x=',
+                 'arcv2hs-table=', 'arcv2em-table=', 'arcv3hs5x-table=',
+                 'arcv3hs6x-table=', 'check=']
 
     try:
         (opts, args) = getopt.gnu_getopt(sys.argv[1:], 'o:a:b:c:d:', long_opts)
@@ -406,12 +680,28 @@ def main():
             arcv3hs6x_file = a
         elif o in ('-d', '--arcv3hs5x'):
             arcv3hs5x_file = a
+        elif o == '--arcv2hs-table':
+            tables['ARCv2HS'] = a
+        elif o == '--arcv2em-table':
+            tables['ARCv2EM'] = a
+        elif o == '--arcv3hs6x-table':
+            tables['ARC64'] = a
+        elif o == '--arcv3hs5x-table':
+            tables['ARC32'] = a
+        elif o == '--check':
+            check_samples = int(a)
         else:
             assert False, 'unhandled option'
     
     if len(args) < 1:
         error(0, 'missing input file')
 
+    # '--check N' alone is the self-test: check every ISA, write nothing.
+    if check_samples and not tables:
+        opcodes_file = os.devnull
+        for arch in ('ARCv2HS', 'ARCv2EM', 'ARC64', 'ARC32'):
+            tables[arch] = os.devnull
+
     with open_output(opcodes_file) as of:
         for filename in args:
             input_file = filename
@@ -445,6 +735,9 @@ def main():
     # ARCv3HS5x
     if arcv3hs5x_file:
         gen_tree('ARC32', arcv3hs5x_file)
+
+    for arch, file in tables.items():
+        gen_table(arch, file, check_samples)
             
 
 if __name__ == "__main__":
@@ -42,11 +42,6 @@ void arc_cpu_do_interrupt(CPUState *cs)
     uint32_t     vectno;
     const char  *name;
 
-    struct lpa_lf_entry *entry = env->arconnect.lpa_lf;
-    if(entry != NULL) {
-        qemu_mutex_unlock(&(entry->mutex));
-        entry->lpa_lf = 0;
-    }
     /*
      * NOTE: Special LP_END exception. Immediately return code execution to
      * lp_start.
@@ -62,6 +57,9 @@ void arc_cpu_do_interrupt(CPUState *cs)
         return;
     }
 
+    /* Taking an exception clears the exclusive monitor. */
+    env->exclusive_addr = -1;
+
     /*
      * NOTE: Special handling of the SWI exception when having
      * semihosting enabled.
@@ -34,6 +34,7 @@ DEF_HELPER_3(set_status32_bit, void, env, tl, tl)
 DEF_HELPER_FLAGS_3(carry_add_flag, TCG_CALL_NO_RWG_SE, tl, tl, tl, tl)
 DEF_HELPER_FLAGS_3(overflow_add_flag, TCG_CALL_NO_RWG_SE, tl, tl, tl, tl)
 DEF_HELPER_FLAGS_3(overflow_sub_flag, TCG_CALL_NO_RWG_SE, tl, tl, tl, tl)
+DEF_HELPER_1(compute_cv, void, env)
 DEF_HELPER_FLAGS_3(mpymu, TCG_CALL_NO_RWG_SE, tl, env, tl, tl)
 DEF_HELPER_FLAGS_3(mpym, TCG_CALL_NO_RWG_SE, tl, env, tl, tl)
 DEF_HELPER_FLAGS_3(repl_mask, TCG_CALL_NO_RWG_SE, tl, tl, tl, tl)
@@ -54,13 +55,3 @@ DEF_HELPER_FLAGS_2(asr_32, TCG_CALL_NO_RWG_SE, i64, i64, i64)
 DEF_HELPER_2(norml, i64, env, i64)
 #endif
 
-DEF_HELPER_2(llock, tl, env, tl)
-DEF_HELPER_3(scond, tl, env, tl, tl)
-#if defined(TARGET_ARC64)
-DEF_HELPER_2(llockl, tl, env, tl)
-DEF_HELPER_3(scondl, tl, env, tl, tl)
-#elif defined(TARGET_ARC32)
-DEF_HELPER_2(llockd, i64, env, tl)
-DEF_HELPER_3(scondd, tl, env, tl, i64)
-#endif
-
@@ -55,6 +55,8 @@ uint32_t pack_status32(ARCStatus *status_r)
 {
     uint32_t res = 0x0;
 
+    arc_status_compute_cv(status_r);
+
     res |= status_r->pstate & PSTATE_MASK;
     res = FIELD_DP32(res, STATUS32, Zf,  status_r->Zf);
     res = FIELD_DP32(res, STATUS32, Nf,  status_r->Nf);
@@ -72,6 +74,7 @@ void unpack_status32(ARCStatus *status_r, uint32_t value)
     status_r->Nf  = FIELD_EX32(value, STATUS32, Nf);
     status_r->Cf  = FIELD_EX32(value, STATUS32, Cf);
     status_r->Vf  = FIELD_EX32(value, STATUS32, Vf);
+    status_r->cc_op = ARC_CC_OP_NONE;
 }
 
 /* Return from fast interrupts. */
@@ -241,6 +244,7 @@ static void arc_enter_firq(ARCCPU *cpu, uint32_t vector)
     SET_STATUS_BIT(env->stat, PREVIOUS_IS_DELAYSLOTf, 0);
     env->in_delayslot_instruction = 0;
     env->lock_lf_var = 0;
+    env->exclusive_addr = -1;
 
     /* Set .RB to 1 if additional register banks are specified. */
     if (cpu->cfg.rgf_num_banks > 0) {
@@ -347,6 +351,7 @@ static void arc_enter_irq(ARCCPU *cpu, uint32_t vector)
     SET_STATUS_BIT(env->stat, PREVIOUS_IS_DELAYSLOTf, 0);
     SET_STATUS_BIT(env->stat, Uf, 0);
     env->lock_lf_var = 0;
+    env->exclusive_addr = -1;
 }
 
 /* Function implementation for reading the IRQ related aux regs. */
@@ -279,6 +279,11 @@ static bool pte_is_invalid(char pte, char level)
 }
 #endif
 
+void arc_mmuv6_pwc_flush(struct arc_mmuv6 *mmu)
+{
+    memset(mmu->pwc, 0, sizeof(mmu->pwc));
+}
+
 enum MMUv6_TLBCOMMAND {
     TLBInvalidateAll = 0x1,
     TLBRead,
@@ -301,6 +306,7 @@ mmuv6_tlb_command(CPUARCState *env, enum MMUv6_TLBCOMMAND command)
     case TLBInvalidateRegionASID:
         /* For now we flush all entries all the time. */
         qemu_log_mask(CPU_LOG_MMU, "\n[MMUV3] TLB Flush cmd %d\n\n", command);
+        arc_mmuv6_pwc_flush(&env->mmu.v6);
         tlb_flush(cs);
         break;
 
@@ -370,24 +376,32 @@ arc_mmuv6_aux_set(const struct arc_aux_reg_detail *aux_reg_detail,
     case AUX_ID_mmu_rtp0:
         qemu_log_mask(CPU_LOG_MMU, "\n[MMUV3] RTP0 update %lx"
                       " ==> " TARGET_FMT_lx "\n\n", mmu_rtp0, val);
-        if (mmu_rtp0 != u64_val)
+        if (mmu_rtp0 != u64_val) {
+            arc_mmuv6_pwc_flush(&env->mmu.v6);
             tlb_flush(cs);
+        }
         mmu_rtp0 =  u64_val;
         break;
     case AUX_ID_mmu_rtp0hi:
-        if ((mmu_rtp0 >> 32) != u64_val)
+        if ((mmu_rtp0 >> 32) != u64_val) {
+            arc_mmuv6_pwc_flush(&env->mmu.v6);
             tlb_flush(cs);
+        }
         mmu_rtp0 &= ~0xffffffff00000000;
         mmu_rtp0 |= (u64_val << 32);
         break;
     case AUX_ID_mmu_rtp1:
-        if (mmu_rtp1 != u64_val)
+        if (mmu_rtp1 != u64_val) {
+            arc_mmuv6_pwc_flush(&env->mmu.v6);
             tlb_flush(cs);
+        }
         mmu_rtp1 =  u64_val;
         break;
     case AUX_ID_mmu_rtp1hi:
-        if ((mmu_rtp1 >> 32) != u64_val)
+        if ((mmu_rtp1 >> 32) != u64_val) {
+            arc_mmuv6_pwc_flush(&env->mmu.v6);
             tlb_flush(cs);
+        }
         mmu_rtp1 &= ~0xffffffff00000000;
         mmu_rtp1 |= (u64_val << 32);
         break;
@@ -398,6 +412,9 @@ arc_mmuv6_aux_set(const struct arc_aux_reg_detail *aux_reg_detail,
         qemu_log_mask(CPU_LOG_MMU, "mmu_ctrl = 0x" TARGET_FMT_lx "\n", val);
         break;
     case AUX_ID_mmu_ttbcr:
+        if (mmu_ttbcr != val) {
+            arc_mmuv6_pwc_flush(&env->mmu.v6);
+        }
         mmu_ttbcr = val;
         break;
     case AUX_ID_mmuv6_tlbcommand:
@@ -559,6 +576,56 @@ get_prot_for_pte(CPUARCState *env, uint64_t pte,
     return ret;
 }
 
+/*
+ * Look for the deepest cached table descriptor for VADDR under ROOT. On a
+ * hit the walk resumes at the returned level, with ROOT, REMAINIG_BITS and
+ * PERMS set up as if the upper levels had just been read from memory.
+ */
+static int
+pwc_lookup(struct arc_mmuv6 *mmu, target_ulong vaddr, uint64_t *root,
+           unsigned char *remainig_bits, int *perms)
+{
+    unsigned char shift[MMUV6_PWC_LEVELS];
+    unsigned char bits = VADDR_SIZE();
+    int l;
+
+    for (l = 0; l < NLEVELS() - 1; l++) {
+        bits -= N_BITS_ON_LEVEL(l);
+        shift[l] = bits;
+    }
+
+    for (l = NLEVELS() - 2; l >= 0; l--) {
+        uint64_t prefix = vaddr >> shift[l];
+        struct mmuv6_pwc_entry *e = &mmu->pwc[l][prefix % MMUV6_PWC_SIZE];
+
+        if (e->valid && e->root == *root && e->prefix == prefix) {
+            mmu->pwc_hits++;
+            *root = e->next;
+            *remainig_bits = shift[l];
+            *perms = e->perms;
+            return l + 1;
+        }
+    }
+
+    mmu->pwc_misses++;
+    return 0;
+}
+
+static void
+pwc_insert(struct arc_mmuv6 *mmu, uint64_t root, int level,
+           target_ulong vaddr, unsigned char remainig_bits,
+           uint64_t next, int perms)
+{
+    uint64_t prefix = vaddr >> remainig_bits;
+    struct mmuv6_pwc_entry *e = &mmu->pwc[level][prefix % MMUV6_PWC_SIZE];
+
+    e->root = root;
+    e->prefix = prefix;
+    e->next = next;
+    e->perms = perms;
+    e->valid = true;
+}
+
 static target_ulong
 page_table_traverse(CPUARCState *env,
 		   target_ulong vaddr, enum mmu_access_type rwe,
@@ -571,8 +638,11 @@ page_table_traverse(CPUARCState *env,
     int overwrite_permitions = 0;
     bool valid_root = true;
     uint64_t root = root_ptr_for_vaddr(vaddr, &valid_root);
+    uint64_t root_table = root;
     ARCCPU *cpu = env_archcpu (env);
     unsigned char remainig_bits = VADDR_SIZE();
+    /* Debug translations (gdbstub, monitor) always read the tables. */
+    bool use_pwc = (rwe != MMU_MEM_IRRELEVANT_TYPE);
 
     if(rwe != MMU_MEM_IRRELEVANT_TYPE) {
         qemu_log_mask(CPU_LOG_MMU, "[MMUV3] [PC " TARGET_FMT_lx
@@ -589,7 +659,13 @@ page_table_traverse(CPUARCState *env,
         }
     }
 
-    for(l = 0; l < NLEVELS(); l++) {
+    l = 0;
+    if (use_pwc) {
+        l = pwc_lookup(&env->mmu.v6, vaddr, &root, &remainig_bits,
+                       &overwrite_permitions);
+    }
+
+    for(; l < NLEVELS(); l++) {
         unsigned char bits_to_compare = N_BITS_ON_LEVEL(l);
         remainig_bits = remainig_bits - bits_to_compare;
         unsigned offset = (vaddr >> remainig_bits) & ((1<<bits_to_compare)-1);
@@ -663,6 +739,11 @@ page_table_traverse(CPUARCState *env,
         }
 
         root = pte_tbl_next_level_table_address(l, pte);
+
+        if (use_pwc && l < MMUV6_PWC_LEVELS) {
+            pwc_insert(&env->mmu.v6, root_table, l, vaddr, remainig_bits,
+                       root, overwrite_permitions);
+        }
     }
 
     if(found_block_descriptor) {
@@ -720,6 +801,10 @@ void arc_mmu_init_v6(CPUARCState *env)
         break;
     }
 
+    arc_mmuv6_pwc_flush(&env->mmu.v6);
+    env->mmu.v6.pwc_hits = 0;
+    env->mmu.v6.pwc_misses = 0;
+
     return;
 }
 
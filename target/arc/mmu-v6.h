@@ -23,15 +23,37 @@
 
 #include "target/arc/mmu-common.h"
 
+/*
+ * Page-walk cache for intermediate table descriptors. Entries are keyed by
+ * the root table address, the level and the virtual address bits consumed
+ * down to that level, and hold the next level table address together with
+ * the permission restrictions accumulated on the way.
+ */
+#define MMUV6_PWC_LEVELS 3
+#define MMUV6_PWC_SIZE   16
+
+struct mmuv6_pwc_entry {
+    uint64_t root;
+    uint64_t prefix;
+    uint64_t next;
+    int perms;
+    bool valid;
+};
+
 struct arc_mmuv6 {
     struct mmuv6_exception {
       int32_t number;
       uint8_t causecode;
       uint8_t parameter;
     } exception;
+
+    struct mmuv6_pwc_entry pwc[MMUV6_PWC_LEVELS][MMUV6_PWC_SIZE];
+    uint64_t pwc_hits;
+    uint64_t pwc_misses;
 };
 
 int mmuv6_enabled(void);
+void arc_mmuv6_pwc_flush(struct arc_mmuv6 *mmu);
 
 
 #endif /* ARC64_MMUV6_H */
@@ -29,6 +29,19 @@
 
 unsigned char mmu_v3_page_size = 13;
 
+/* vaddr can't have top bit */
+#define VPN(addr) ((addr) & (MMU_V3_PAGE_MASK & (~0x80000000)))
+#define PFN(addr) ((addr) & MMU_V3_PAGE_MASK)
+
+/*
+ * Private pages to drop one by one when the PID changes. Past this it is
+ * cheaper to flush the whole softmmu TLB.
+ */
+#define ASID_FLUSH_MAX_PAGES 64
+
+static void arc_mmu_flush_asid(CPUState *cs, struct arc_mmu *mmu,
+                               uint32_t asid);
+
 target_ulong
 arc_mmu_aux_get(const struct arc_aux_reg_detail *aux_reg_detail, void *data)
 {
@@ -106,15 +119,28 @@ arc_mmu_aux_set(const struct arc_aux_reg_detail *aux_reg_detail,
     case AUX_ID_scratch_data0:
         mmu->scratch_data0 = val;
         break;
-    case AUX_ID_pid:
+    case AUX_ID_pid: {
+        uint32_t enabled = (val >> 31) & 1;
+        uint32_t asid = val & 0xff;
+
         qemu_log_mask(CPU_LOG_MMU,
                       "[MMU] Writing PID_ASID with value 0x" TARGET_FMT_lx
                       " at 0x" TARGET_FMT_lx "\n",
                       val, env->pc);
-        mmu->enabled = (val >> 31);
-        mmu->pid_asid = val & 0xff;
-        tlb_flush(cs);
+        /*
+         * With the MMU enabled on both sides only the pages private to the
+         * old ASID can be stale: global and shared library pages don't
+         * depend on the PID.
+         */
+        if (enabled != mmu->enabled) {
+            tlb_flush(cs);
+        } else if (enabled && asid != mmu->pid_asid) {
+            arc_mmu_flush_asid(cs, mmu, mmu->pid_asid);
+        }
+        mmu->enabled = enabled;
+        mmu->pid_asid = asid;
         break;
+    }
     case AUX_ID_sasid0:
         mmu->sasid0 = val;
         break;
@@ -126,10 +152,6 @@ arc_mmu_aux_set(const struct arc_aux_reg_detail *aux_reg_detail,
     }
 }
 
-/* vaddr can't have top bit */
-#define VPN(addr) ((addr) & (MMU_V3_PAGE_MASK & (~0x80000000)))
-#define PFN(addr) ((addr) & MMU_V3_PAGE_MASK)
-
 static void
 arc_mmu_debug_tlb_for_set(CPUARCState *env, int set)
 {
@@ -193,6 +215,72 @@ arc_mmu_get_tlb_at_index(uint32_t index, struct arc_mmu *mmu)
     return &mmu->nTLB[set][bank];
 }
 
+/* Refresh the pre-decoded compare key, must follow every PD0 update. */
+static void
+arc_mmu_tlb_predecode(struct arc_tlb_e *tlb)
+{
+    uint32_t mask = VPN(PD0_VPN) | PD0_V;
+
+    tlb->shared = false;
+    if ((tlb->pd0 & PD0_G) == 0) {
+        if ((tlb->pd0 & PD0_S) != 0) {
+            tlb->shared = true;
+        } else {
+            mask |= PD0_PID_MATCH;
+        }
+    }
+    tlb->mask = mask;
+    tlb->key = tlb->pd0 & mask;
+}
+
+/*
+ * Drop the softmmu pages a valid TLB entry may have filled, using the
+ * super page size for PD0_SZ entries.  Without a usable super page size
+ * the whole softmmu TLB is flushed.
+ */
+static void
+arc_mmu_flush_tlb_entry(CPUState *cs, struct arc_tlb_e *tlb)
+{
+    unsigned bits = MMU_V3_PAGE_BITS;
+    target_ulong addr;
+
+    if ((tlb->pd0 & PD0_V) == 0) {
+        return;
+    }
+    if ((tlb->pd0 & PD0_SZ) != 0) {
+        bits = ARC_CPU(cs)->cfg.mmu_page_size_sel1;
+        if (bits < MMU_V3_PAGE_BITS || bits >= 31) {
+            tlb_flush(cs);
+            return;
+        }
+    }
+    addr = VPN(tlb->pd0) & ~((target_ulong)(1u << bits) - 1);
+    tlb_flush_range_by_mmuidx(cs, addr, (target_ulong)1 << bits, 3,
+                              TARGET_LONG_BITS);
+}
+
+static void
+arc_mmu_flush_asid(CPUState *cs, struct arc_mmu *mmu, uint32_t asid)
+{
+    int i, j, n = 0;
+
+    for (i = 0; i < N_SETS; i++) {
+        for (j = 0; j < N_WAYS; j++) {
+            struct arc_tlb_e *tlb = &mmu->nTLB[i][j];
+
+            if ((tlb->pd0 & (PD0_V | PD0_G | PD0_S)) != PD0_V
+                || (tlb->pd0 & PD0_PID_MATCH) != asid) {
+                continue;
+            }
+            if (++n > ASID_FLUSH_MAX_PAGES) {
+                tlb_flush(cs);
+                return;
+            }
+            arc_mmu_flush_tlb_entry(cs, tlb);
+        }
+    }
+}
+
 static inline bool
 match_sasid(struct arc_tlb_e *tlb, struct arc_mmu *mmu)
 {
@@ -249,15 +337,52 @@ arc_mmu_lookup_tlb(uint32_t vaddr, uint32_t compare_mask, struct arc_mmu *mmu,
     }
 
     if (ret == NULL) {
+        /* Replace a free way if there is one, round-robin otherwise. */
         uint32_t way = mmu->way_sel[set];
-        ret = &mmu->nTLB[set][way];
 
-        /* TODO: Replace by something more significant. */
+        for (w = 0; w < N_WAYS; w++) {
+            if ((mmu->nTLB[set][w].pd0 & PD0_V) == 0) {
+                way = w;
+                break;
+            }
+        }
+        if (w == N_WAYS) {
+            mmu->way_sel[set] = (way + 1) & (N_WAYS - 1);
+        }
+
+        ret = &mmu->nTLB[set][way];
         if (index != NULL) {
             *index = (set * N_WAYS) + way;
         }
+    }
+
+    return ret;
+}
 
-        mmu->way_sel[set] = (mmu->way_sel[set] + 1) & (N_WAYS - 1);
+/*
+ * Translation lookup: one masked compare per way against the pre-decoded
+ * keys. Returns the last matching entry, or NULL on a miss.
+ */
+static struct arc_tlb_e *
+arc_mmu_lookup_vaddr(uint32_t vaddr, struct arc_mmu *mmu,
+                     int *num_finds, uint32_t *index)
+{
+    uint32_t set = (vaddr >> MMU_V3_PAGE_BITS) & (N_SETS - 1);
+    uint32_t key = VPN(vaddr) | PD0_V | (mmu->pid_asid & PD0_PID_MATCH);
+    struct arc_tlb_e *tlb = &mmu->nTLB[set][0];
+    struct arc_tlb_e *ret = NULL;
+    int w;
+
+    *num_finds = 0;
+    for (w = 0; w < N_WAYS; w++, tlb++) {
+        if ((key & tlb->mask) == tlb->key
+            && (!tlb->shared || match_sasid(tlb, mmu))) {
+            ret = tlb;
+            *num_finds += 1;
+            if (index != NULL) {
+                *index = (set * N_WAYS) + w;
+            }
+        }
     }
 
     return ret;
@@ -302,6 +427,7 @@ arc_mmu_aux_set_tlbcmd(const struct arc_aux_reg_detail *aux_reg_detail,
         tlb = arc_mmu_get_tlb_at_index(mmu->tlbindex & TLBINDEX_INDEX, mmu);
         tlb->pd0 = mmu->tlbpd0;
         tlb->pd1 = mmu->tlbpd1;
+        arc_mmu_tlb_predecode(tlb);
 
         /*
          * don't try to optimize this: upon ASID rollover the entire TLB is
@@ -340,7 +466,9 @@ arc_mmu_aux_set_tlbcmd(const struct arc_aux_reg_detail *aux_reg_detail,
             mmu->tlbindex = 0x80000000; /* No entry to delete */
         } else if (num_finds == 1) {
             mmu->tlbindex = index; /* Entry is deleted set index */
+            arc_mmu_flush_tlb_entry(cs, tlb);
             tlb->pd0 &= ~PD0_V;
+            arc_mmu_tlb_predecode(tlb);
             num_finds--;
             qemu_log_mask(CPU_LOG_MMU,
                           "[MMU] Delete at 0x" TARGET_FMT_lx
@@ -348,7 +476,9 @@ arc_mmu_aux_set_tlbcmd(const struct arc_aux_reg_detail *aux_reg_detail,
                           env->pc, tlb->pd0, tlb->pd1);
         } else {
             while (num_finds > 0) {
+                arc_mmu_flush_tlb_entry(cs, tlb);
                 tlb->pd0 &= ~PD0_V;
+                arc_mmu_tlb_predecode(tlb);
                 qemu_log_mask(CPU_LOG_MMU,
                               "[MMU] Delete at 0x" TARGET_FMT_lx
                               ", pd0 = 0x%08x, pd1 = 0x%08x\n",
@@ -365,8 +495,15 @@ arc_mmu_aux_set_tlbcmd(const struct arc_aux_reg_detail *aux_reg_detail,
         if ((pd0 & PD0_V) == 0) {
             mmu->tlbindex = 0x80000000;
         } else {
+            /*
+             * The way may have been taken from a valid entry by
+             * round-robin: its pages must not outlive it, whichever ASID
+             * it belonged to.
+             */
+            arc_mmu_flush_tlb_entry(cs, tlb);
             tlb->pd0 = pd0;
             tlb->pd1 = pd1;
+            arc_mmu_tlb_predecode(tlb);
 
             /* Set index for latest inserted element. */
             mmu->tlbindex |= index;
@@ -460,9 +597,7 @@ arc_mmu_translate(CPUARCState *env,
                       env->pc, vaddr, mmu->pid_asid, RWE_STRING(rwe));
     }
 
-    uint32_t match_pd0 = (VPN(vaddr) | PD0_V);
-    tlb = arc_mmu_lookup_tlb(match_pd0, (VPN(PD0_VPN) | PD0_V), mmu,
-                              &num_matching_tlb, index);
+    tlb = arc_mmu_lookup_vaddr(vaddr, mmu, &num_matching_tlb, index);
 
     /*
      * Check for multiple matches in nTLB, and return machine check
@@ -477,32 +612,7 @@ arc_mmu_translate(CPUARCState *env,
     }
 
 
-    bool match = true;
-
-    if (num_matching_tlb == 0) {
-        match = false;
-    }
-
-    /* Check if entry if related to this address */
-    if (VPN(vaddr) != VPN(tlb->pd0) || (tlb->pd0 & PD0_V) == 0) {
-        /* Call the interrupt. */
-        match = false;
-    }
-
-    if (match == true) {
-        if ((tlb->pd0 & PD0_G) == 0) {
-            if ((tlb->pd0 & PD0_S) != 0) {
-                /* Match to a shared library. */
-                if (match_sasid(tlb, mmu) == false) {
-                    match = false;
-                }
-            } else if ((tlb->pd0 & PD0_PID_MATCH) !=
-                       (mmu->pid_asid & PD0_PID_MATCH)) {
-                /* Match to a process. */
-                      match = false;
-            }
-        }
-    }
+    bool match = (num_matching_tlb != 0);
 
     if (match == true && !arc_mmu_have_permission(env, tlb, rwe)) {
   protv_exception:
@@ -540,20 +650,14 @@ arc_mmu_translate(CPUARCState *env,
             if (rwe == MMU_MEM_FETCH) {
                 qemu_log_mask(CPU_LOG_MMU,
                               "[MMU] TLB_MissI exception at 0x"
-                              TARGET_FMT_lx ". rwe = %s, "
-                              "vaddr = %08x, tlb->pd0 = %08x, tlb->pd1 = %08x\n",
-                              env->pc,
-                              RWE_STRING(rwe),
-                              vaddr, tlb->pd0, tlb->pd1);
+                              TARGET_FMT_lx ". rwe = %s, vaddr = %08x\n",
+                              env->pc, RWE_STRING(rwe), vaddr);
                 SET_MEM_EXCEPTION(*excp, EXCP_TLB_MISS_I, 0x00, 0x00);
             } else {
                 qemu_log_mask(CPU_LOG_MMU,
                               "[MMU] TLB_MissD exception at 0x" TARGET_FMT_lx
-                              ". rwe = %s, "
-                              "vaddr = %08x, tlb->pd0 = %08x, tlb->pd1 = %08x\n",
-                              env->pc,
-                              RWE_STRING(rwe),
-                              vaddr, tlb->pd0, tlb->pd1);
+                              ". rwe = %s, vaddr = %08x\n",
+                              env->pc, RWE_STRING(rwe), vaddr);
                 SET_MEM_EXCEPTION(*excp, EXCP_TLB_MISS_D, CAUSE_CODE(rwe),
                                   0x00);
             }
@@ -706,6 +810,7 @@ static int decide_action(const CPUARCState *env,
 void arc_mmu_init_v3(CPUARCState *env)
 {
     ARCCPU *cpu = env_archcpu(env);
+    int i, j;
 
     env->mmu.v3.enabled = 0;
     env->mmu.v3.pid_asid = 0;
@@ -725,6 +830,11 @@ void arc_mmu_init_v3(CPUARCState *env)
     }
 
     memset(env->mmu.v3.nTLB, 0, sizeof(env->mmu.v3.nTLB));
+    for (i = 0; i < N_SETS; i++) {
+        for (j = 0; j < N_WAYS; j++) {
+            arc_mmu_tlb_predecode(&env->mmu.v3.nTLB[i][j]);
+        }
+    }
 }
 
 bool
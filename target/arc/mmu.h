@@ -75,6 +75,14 @@ struct arc_tlb_e {
      * flags includes both PD0 flags and PD1 permissions.
      */
     uint32_t pd0, pd1;
+
+    /*
+     * Compare key pre-decoded from PD0: an address matches when
+     * ((VPN | V | PID) & mask) == key. Shared library entries ignore the
+     * PID and must also match SASID.
+     */
+    uint32_t key, mask;
+    bool shared;
 };
 
 struct arc_mmu {
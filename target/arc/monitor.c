@@ -0,0 +1,65 @@
+/*
+ * QEMU ARC monitor commands
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see
+ * http://www.gnu.org/licenses/lgpl-2.1.html
+ */
+
+#include "qemu/osdep.h"
+#include "cpu.h"
+#include "monitor/monitor.h"
+#include "monitor/hmp-target.h"
+#include "mmu-common.h"
+
+static void arc_mmuv6_info_tlb(Monitor *mon, CPUARCState *env)
+{
+    struct arc_mmuv6 *mmu = &env->mmu.v6;
+    uint64_t walks = mmu->pwc_hits + mmu->pwc_misses;
+    int l, i, n;
+
+    monitor_printf(mon, "MMUv6 %s\n", mmuv6_enabled() ? "enabled" : "disabled");
+    monitor_printf(mon, "page-walk cache: %d levels x %d entries\n",
+                   MMUV6_PWC_LEVELS, MMUV6_PWC_SIZE);
+    for (l = 0; l < MMUV6_PWC_LEVELS; l++) {
+        for (i = 0, n = 0; i < MMUV6_PWC_SIZE; i++) {
+            n += mmu->pwc[l][i].valid;
+        }
+        monitor_printf(mon, "  level %d: %d valid\n", l, n);
+    }
+    monitor_printf(mon, "  hits   %" PRIu64 "\n", mmu->pwc_hits);
+    monitor_printf(mon, "  misses %" PRIu64 "\n", mmu->pwc_misses);
+    if (walks != 0) {
+        monitor_printf(mon, "  hit rate %.1f%%\n",
+                       100.0 * mmu->pwc_hits / walks);
+    }
+}
+
+void hmp_info_tlb(Monitor *mon, const QDict *qdict)
+{
+    CPUArchState *env = mon_get_cpu_env(mon);
+
+    if (!env) {
+        monitor_printf(mon, "No CPU available\n");
+        return;
+    }
+
+    switch (get_mmu_version(env)) {
+    case MMU_VERSION_6:
+        arc_mmuv6_info_tlb(mon, env);
+        break;
+    default:
+        monitor_printf(mon, "No TLB statistics for this MMU\n");
+        break;
+    }
+}
@@ -237,6 +237,8 @@ void arc_mpu_init(ARCCPU *cpu)
         mpu->reg_perm[idx].mask       = 0xffffffff;
         mpu->reg_perm[idx].permission = INITIAL_PERMS;
     }
+
+    mpu->nr_subpages = 0;
 }
 
 /* Checking the sanity of situation before accessing MPU registers */
@@ -353,6 +355,8 @@ static void log_mpu_data(const struct ARCMPU *mpu)
             "--------------------^--------------^------------'\n");
 }
 
+static void mpu_rebuild_subpages(struct ARCMPU *mpu);
+
 /* Extern function: Setter for MPU registers */
 void
 arc_mpu_aux_set(const struct arc_aux_reg_detail *aux_reg_detail,
@@ -381,6 +385,7 @@ arc_mpu_aux_set(const struct arc_aux_reg_detail *aux_reg_detail,
     default:
         g_assert_not_reached();
     }
+    mpu_rebuild_subpages(mpu);
     /* Invalidate the entries in qemu's translation buffer */
     tlb_flush(env_cpu((CPUARCState *) data));
     /* If MPU is enabled, log its data */
@@ -490,9 +495,8 @@ static void set_exception(CPUARCState *env, uint32_t addr,
  * Since regions with lower index has higher priority, the first match
  * is the correct one even if there is overlap among regions.
  */
-static uint8_t get_matching_region(const struct ARCMPU *mpu, uint32_t addr)
+static uint8_t mpu_region_at(const struct ARCMPU *mpu, uint32_t addr)
 {
-    qemu_log_mask(CPU_LOG_MMU, "[MPU] looking up: addr=0x%08x\n", addr);
     for (uint8_t r = 0; r < mpu->reg_bcr.regions; ++r) {
         if (!mpu->reg_base[r].valid) {
             continue;
@@ -500,17 +504,87 @@ static uint8_t get_matching_region(const struct ARCMPU *mpu, uint32_t addr)
         const uint32_t mask = mpu->reg_perm[r].mask;
         /* 'addr' falls under the current region? */
         if ((mpu->reg_base[r].addr & mask) == (addr & mask)) {
-            qemu_log_mask(CPU_LOG_MMU,
-                    "[MPU] region match: region=%u, base=0x%08x\n",
-                    r, mpu->reg_base[r].addr);
             return r;
         }
     }
     /* If we are here, then no corresponding region is found */
-    qemu_log_mask(CPU_LOG_MMU, "[MPU] default region will be used.\n");
     return MPU_DEFAULT_REGION_NR;
 }
 
+static uint8_t get_matching_region(const struct ARCMPU *mpu, uint32_t addr)
+{
+    uint8_t r;
+
+    qemu_log_mask(CPU_LOG_MMU, "[MPU] looking up: addr=0x%08x\n", addr);
+    r = mpu_region_at(mpu, addr);
+    if (r != MPU_DEFAULT_REGION_NR) {
+        qemu_log_mask(CPU_LOG_MMU,
+                "[MPU] region match: region=%u, base=0x%08x\n",
+                r, mpu->reg_base[r].addr);
+    } else {
+        qemu_log_mask(CPU_LOG_MMU, "[MPU] default region will be used.\n");
+    }
+    return r;
+}
+
+/*
+ * Precompute the matching region of every granule of the pages that
+ * hold a region smaller than a page.
+ */
+static void mpu_rebuild_subpages(struct ARCMPU *mpu)
+{
+    mpu->nr_subpages = 0;
+
+    /* An undefined region size is matched bytewise, leave it to the walk */
+    for (uint8_t r = 0; r < mpu->reg_bcr.regions; ++r) {
+        if (mpu->reg_base[r].valid && mpu->reg_perm[r].size_bits < 4) {
+            return;
+        }
+    }
+
+    for (uint8_t r = 0; r < mpu->reg_bcr.regions; ++r) {
+        const MPUPermReg *rp = &mpu->reg_perm[r];
+        uint32_t page;
+        MPUSubPage *sp;
+        uint8_t i;
+
+        if (!mpu->reg_base[r].valid || rp->size >= TARGET_PAGE_SIZE) {
+            continue;
+        }
+
+        page = (mpu->reg_base[r].addr & rp->mask) & TARGET_PAGE_MASK;
+        for (i = 0; i < mpu->nr_subpages; ++i) {
+            if (mpu->subpage[i].page == page) {
+                break;
+            }
+        }
+        if (i < mpu->nr_subpages) {
+            continue;
+        }
+
+        sp = &mpu->subpage[mpu->nr_subpages++];
+        sp->page = page;
+        for (uint32_t g = 0; g < ARC_MPU_SUBPAGE_GRANULES; ++g) {
+            sp->region[g] = mpu_region_at(mpu,
+                                          page + (g << ARC_MPU_GRANULE_BITS));
+        }
+    }
+}
+
+/* The precomputed regions of the page 'addr' is in, if it is split up */
+static const MPUSubPage *mpu_find_subpage(const struct ARCMPU *mpu,
+                                          uint32_t addr)
+{
+    const uint32_t page = addr & TARGET_PAGE_MASK;
+
+    for (uint8_t i = 0; i < mpu->nr_subpages; ++i) {
+        if (mpu->subpage[i].page == page) {
+            return &mpu->subpage[i];
+        }
+    }
+    return NULL;
+}
+
 /*
  * Returns the corresponding permission for the given 'region'.
  * If 'region' is MPU_DEFAULT_REGION_NR, then the default permission
@@ -589,13 +663,14 @@ static bool is_overlap_free(const struct ARCMPU *mpu, target_ulong addr,
  * memory demanding for host process.
  */
 static void update_tlb_page(CPUARCState *env, uint8_t region,
-                            target_ulong addr, int mmu_idx)
+                            target_ulong addr, int mmu_idx, bool subpage)
 {
     CPUState *cs = env_cpu(env);
     /* By default, only add entry for 'addr' */
     target_ulong tlb_addr = addr;
     target_ulong tlb_size = 1;
-    bool check_for_overlap = true;
+    /* A split up page is never entered in the TLB as a whole */
+    bool check_for_overlap = !subpage;
     int prot = 0;
 
     if (region != MPU_DEFAULT_REGION_NR) {
@@ -607,7 +682,7 @@ static void update_tlb_page(CPUARCState *env, uint8_t region,
          * Later if we find no overlap, then we add the permission for
          * the whole page to qemu's tlb.
          */
-        check_for_overlap = (perm->size >= TARGET_PAGE_SIZE);
+        check_for_overlap &= (perm->size >= TARGET_PAGE_SIZE);
     }
     /* Default region */
     else {
@@ -640,14 +715,21 @@ arc_mpu_translate(CPUARCState *env, target_ulong addr,
                   struct mem_exception *excp)
 {
     struct ARCMPU *mpu = &env->mpu;
+    const MPUSubPage *sp = mpu_find_subpage(mpu, addr);
+    uint8_t region;
+
+    if (sp != NULL) {
+        region = sp->region[(addr & ~TARGET_PAGE_MASK) >> ARC_MPU_GRANULE_BITS];
+    } else {
+        region = get_matching_region(mpu, addr);
+    }
 
-    uint8_t region = get_matching_region(mpu, addr);
     const MPUPermissions *perms = get_permission(mpu, region);
     if (!allowed(access, is_user_mode(env), perms)) {
         set_exception(env, addr, region, access, excp);
         return MPU_FAULT;
     }
-    update_tlb_page(env, region, addr, mmu_idx);
+    update_tlb_page(env, region, addr, mmu_idx, sp != NULL);
 
     return MPU_SUCCESS;
 }
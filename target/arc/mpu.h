@@ -90,6 +90,19 @@ typedef struct MPUPermReg {
     MPUPermissions permission; /* region's permissions */
 } MPUPermReg;
 
+/*
+ * Regions are at least 32 bytes and aligned to their size, so a page
+ * split up by regions smaller than itself is uniform in 32-byte granules.
+ */
+#define ARC_MPU_GRANULE_BITS     5
+#define ARC_MPU_SUBPAGE_GRANULES (1 << (TARGET_PAGE_BITS - ARC_MPU_GRANULE_BITS))
+
+/* Matching region of every granule of such a page */
+typedef struct MPUSubPage {
+    uint32_t page;
+    uint8_t  region[ARC_MPU_SUBPAGE_GRANULES];
+} MPUSubPage;
+
 struct ARCMPU {
     bool         enabled;
 
@@ -99,6 +112,14 @@ struct ARCMPU {
     /* Base and permission registers are paired */
     MPUBaseReg   reg_base[ARC_MPU_MAX_NR_REGIONS];
     MPUPermReg   reg_perm[ARC_MPU_MAX_NR_REGIONS];
+
+    /*
+     * Pages holding a region smaller than a page, rebuilt on every
+     * region register write.  Accesses to them cannot be cached in
+     * QEMU's TLB, so they are resolved here instead of by region walk.
+     */
+    uint8_t      nr_subpages;
+    MPUSubPage   subpage[ARC_MPU_MAX_NR_REGIONS];
 };
 
 enum ARCMPUVerifyRet {
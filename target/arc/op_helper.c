@@ -32,7 +32,6 @@
 #include "irq.h"
 #include "sysemu/sysemu.h"
 #include "exec/exec-all.h"
-#include "target/arc/arconnect.h"
 #include "qemu/log.h"
 
 
@@ -76,147 +75,6 @@ static void set_status32(CPUARCState *env, target_ulong value)
 #endif
 }
 
-target_ulong helper_llock(CPUARCState *env, target_ulong addr)
-{
-    assert((addr & 0x3) == 0);
-    hwaddr haddr;
-    CPUState *cs = env_cpu(env);
-    arc_get_physical_addr(cs, &haddr, addr, MMU_MEM_READ, false, GETPC());
-    struct lpa_lf_entry *entry = &lpa_lfs[LPA_LFS_ENTRY_FOR_PA(haddr)];
-    qemu_log_mask(LOG_UNIMP, "0x" TARGET_FMT_lx "LLOCK at addr 0x" TARGET_FMT_lx " at index %d\n",
-                  env->pc,
-                  (target_ulong) haddr, (int) LPA_LFS_ENTRY_FOR_PA(haddr));
-    qemu_mutex_lock(&entry->mutex);
-    env->arconnect.locked_mutex = &entry->mutex;
-    target_ulong ret = cpu_ldl_data(env, addr);
-    env->arconnect.lpa_lf = entry;
-    entry->lpa_lf = (haddr & (~LPA_LFS_ALIGNEMENT_MASK));
-    entry->lpa_lf += 1;     /* least significant bit is LF flag */
-    entry->read_value = ret;
-    qemu_mutex_unlock(&entry->mutex);
-    return ret;
-}
-target_ulong helper_scond(CPUARCState *env, target_ulong addr, target_ulong value)
-{
-    assert((addr & 0x3) == 0);
-    hwaddr haddr;
-    CPUState *cs = env_cpu(env);
-    arc_get_physical_addr(cs, &haddr, addr, MMU_MEM_WRITE, false, GETPC());
-    qemu_log_mask(LOG_UNIMP, "0x" TARGET_FMT_lx "SCOND at addr 0x" TARGET_FMT_lx " at index %d\n",
-                  env->pc,
-                  (target_ulong) haddr, (int) LPA_LFS_ENTRY_FOR_PA(haddr));
-    qemu_mutex_lock(env->arconnect.locked_mutex);
-    struct lpa_lf_entry *entry = env->arconnect.lpa_lf;
-    haddr = (haddr & (~LPA_LFS_ALIGNEMENT_MASK));
-    target_ulong ret = 1;
-    target_ulong rvalue = cpu_ldl_data(env, addr);
-    if(entry->lpa_lf == (haddr + 1) && (entry->read_value == rvalue)) {
-        ret  = 0;
-        cpu_stl_data(env, addr, value);
-        entry->lpa_lf = 0;
-        qemu_log_mask(LOG_UNIMP, "SCOND success with value 0x" TARGET_FMT_lx "\n", value);
-    }
-    else
-        {
-          qemu_log_mask(LOG_UNIMP, "SCOND fail with value 0x" TARGET_FMT_lx "\n", value);
-
-        }
-    qemu_mutex_unlock(&entry->mutex);
-    return ret;
-}
-
-#if defined(TARGET_ARC64)
-target_ulong helper_llockl(CPUARCState *env, target_ulong addr)
-{
-    assert((addr & 0x3) == 0);
-    target_ulong haddr;
-    CPUState *cs = env_cpu(env);
-    arc_get_physical_addr(cs, &haddr, addr, MMU_MEM_READ, false, GETPC());
-    struct lpa_lf_entry *entry = &lpa_lfs[LPA_LFS_ENTRY_FOR_PA(haddr)];
-    qemu_log_mask(LOG_UNIMP, "0x" TARGET_FMT_lx "LLOCKL at addr 0x" TARGET_FMT_lx " at index %d\n",
-                  env->pc,
-                  (target_ulong) haddr, (int) LPA_LFS_ENTRY_FOR_PA(haddr));
-    qemu_mutex_lock(&entry->mutex);
-    env->arconnect.locked_mutex = &entry->mutex;
-    target_ulong ret = cpu_ldq_data(env, addr);
-    env->arconnect.lpa_lf = entry;
-    entry->lpa_lf = (haddr & (~LPA_LFS_ALIGNEMENT_MASK));
-    entry->lpa_lf += 1;     /* least significant bit is LF flag */
-    entry->read_value = ret;
-    qemu_mutex_unlock(&entry->mutex);
-    return ret;
-}
-target_ulong helper_scondl(CPUARCState *env, target_ulong addr, target_ulong value)
-{
-    assert((addr & 0x3) == 0);
-    target_ulong haddr;
-    CPUState *cs = env_cpu(env);
-    arc_get_physical_addr(cs, &haddr, addr, MMU_MEM_WRITE, false, GETPC());
-    qemu_log_mask(LOG_UNIMP, "0x" TARGET_FMT_lx "SCONDL at addr 0x" TARGET_FMT_lx " at index %d\n",
-                  env->pc,
-                  (target_ulong) haddr, (int) LPA_LFS_ENTRY_FOR_PA(haddr));
-    struct lpa_lf_entry *entry = env->arconnect.lpa_lf;
-    qemu_mutex_lock(env->arconnect.locked_mutex);
-    target_ulong ret = 1;
-    haddr = (haddr & (~LPA_LFS_ALIGNEMENT_MASK));
-    target_ulong rvalue = cpu_ldq_data(env, addr);
-    if(entry->lpa_lf == (haddr + 1) && (entry->read_value == rvalue)) {
-        ret = 0;
-        cpu_stq_data(env, addr, value);
-        entry->lpa_lf = 0;
-        qemu_log_mask(LOG_UNIMP, "SCONDL success\n");
-    }
-    qemu_mutex_unlock(&entry->mutex);
-    return ret;
-}
-
-#elif defined(TARGET_ARC32)
-
-uint64_t helper_llockd(CPUARCState *env, target_ulong addr)
-{
-    assert((addr & 0x7) == 0);
-    hwaddr haddr;
-    CPUState *cs = env_cpu(env);
-    arc_get_physical_addr(cs, &haddr, addr, MMU_MEM_READ, false, GETPC());
-    struct lpa_lf_entry *entry = &lpa_lfs[LPA_LFS_ENTRY_FOR_PA(haddr)];
-    qemu_mutex_lock(&entry->mutex);
-    env->arconnect.locked_mutex = &entry->mutex;
-    target_ulong read1 = cpu_ldl_data(env, addr);
-    target_ulong read2 = cpu_ldl_data(env, addr+4);
-    target_ulong ret = ((uint64_t ) read1) | (((uint64_t) read2) << 32);
-    env->arconnect.lpa_lf = entry;
-    entry->lpa_lf = (haddr & (~LPA_LFS_ALIGNEMENT_MASK));
-    entry->lpa_lf += 1;     /* least significant bit is LF flag */
-    entry->read_value = read1;
-    entry->read_value1 = read2;
-    qemu_mutex_unlock(&entry->mutex);
-    return ret;
-}
-target_ulong helper_scondd(CPUARCState *env, target_ulong addr, uint64_t value)
-{
-    assert((addr & 0x7) == 0);
-    hwaddr haddr;
-    CPUState *cs = env_cpu(env);
-    arc_get_physical_addr(cs, &haddr, addr, MMU_MEM_WRITE, false, GETPC());
-    struct lpa_lf_entry *entry = env->arconnect.lpa_lf;
-    qemu_mutex_lock(env->arconnect.locked_mutex);
-    target_ulong ret = !(entry->lpa_lf & 0x1);
-    addr = (addr & (~LPA_LFS_ALIGNEMENT_MASK));
-    target_ulong rvalue = cpu_ldl_data(env, addr);
-    target_ulong rvalue1 = cpu_ldl_data(env, addr+4);
-    if(entry->lpa_lf == (haddr + 1)
-       && entry->read_value == rvalue
-       && entry->read_value1 == rvalue1
-       ) {
-        cpu_stl_data(env, addr, (value & 0xffffffff));
-        cpu_stl_data(env, addr+4, (value >> 32));
-        entry->lpa_lf = 0;
-    }
-    qemu_mutex_unlock(&entry->mutex);
-    return ret;
-}
-#endif
-
 static void report_aux_reg_error(target_ulong aux)
 {
     if (((aux >= ARC_BCR1_START) && (aux <= ARC_BCR1_END)) ||
@@ -473,6 +331,59 @@ target_ulong helper_overflow_sub_flag(target_ulong dest, target_ulong b,
     return overflow_sub_flag(dest, b, c, TARGET_LONG_BITS);
 }
 
+static inline target_ulong
+carry_sub_flag(target_ulong dest, target_ulong b, target_ulong c, uint8_t size)
+{
+    target_ulong t1, t2, t3;
+
+    t1 = ~b;
+    t2 = t1 & c;
+    t3 = (t1 | c) & dest;
+    t2 = t2 | t3;
+    return (t2 >> (size - 1)) & 1;
+}
+
+/*
+ * Bring Cf and Vf up to date when they were left pending by a flag
+ * setting add/sub.  The 32 bit variants only look at the low word.
+ */
+void arc_status_compute_cv(ARCStatus *status_r)
+{
+    target_ulong dest = status_r->cc_dst;
+    target_ulong b = status_r->cc_src1;
+    target_ulong c = status_r->cc_src2;
+
+    switch (status_r->cc_op) {
+    case ARC_CC_OP_NONE:
+        return;
+    case ARC_CC_OP_ADD:
+        status_r->Cf = carry_add_flag(dest, b, c, TARGET_LONG_BITS);
+        status_r->Vf = overflow_add_flag(dest, b, c, TARGET_LONG_BITS);
+        break;
+    case ARC_CC_OP_ADD32:
+        status_r->Cf = carry_add_flag(dest, b, c, 32);
+        status_r->Vf = overflow_add_flag(dest, b, c, 32);
+        break;
+    case ARC_CC_OP_SUB:
+        status_r->Cf = carry_sub_flag(dest, b, c, TARGET_LONG_BITS);
+        status_r->Vf = overflow_sub_flag(dest, b, c, TARGET_LONG_BITS);
+        break;
+    case ARC_CC_OP_SUB32:
+        status_r->Cf = carry_sub_flag(dest, b, c, 32);
+        status_r->Vf = overflow_sub_flag(dest & 0xffffffff, b & 0xffffffff,
+                                         c & 0xffffffff, 32);
+        break;
+    default:
+        g_assert_not_reached();
+    }
+    status_r->cc_op = ARC_CC_OP_NONE;
+}
+
+void helper_compute_cv(CPUARCState *env)
+{
+    arc_status_compute_cv(&env->stat);
+}
+
 target_ulong helper_repl_mask(target_ulong dest, target_ulong src,
                               target_ulong mask)
 {
@@ -19,6 +19,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/host-utils.h"
 #include "qemu/log.h"
 #include "qemu/error-report.h"
 #include "target/arc/regs.h"
@@ -71,10 +72,59 @@ const char *arc_aux_reg_name[ARC_AUX_REGS_DETAIL_LAST] = {
 };
 
 
+/*
+ * Per CPU family map from aux register address to its detail, with the
+ * ARC_OPCODE_DEFAULT fallback already resolved.  Indexed by the bit
+ * number of the family in enum arc_cpu_family.
+ */
+#define ARC_AUX_REG_FAMILIES    7
+#define ARC_AUX_REG_MAP_SIZE    0x800
+
+static struct arc_aux_reg_detail *
+arc_aux_reg_map[ARC_AUX_REG_FAMILIES][ARC_AUX_REG_MAP_SIZE];
+
+static void arc_aux_reg_map_init(void)
+{
+    int i, family;
+
+    for (i = 0; i < ARC_AUX_REGS_DETAIL_LAST; i++) {
+        struct arc_aux_reg_detail *detail = &arc_aux_regs_detail[i];
+
+        if (detail->address < 0 ||
+            detail->address >= ARC_AUX_REG_MAP_SIZE) {
+            continue;
+        }
+
+        for (family = 0; family < ARC_AUX_REG_FAMILIES; family++) {
+            struct arc_aux_reg_detail **slot =
+                &arc_aux_reg_map[family][detail->address];
+
+            if (detail->cpu == ARC_OPCODE_DEFAULT) {
+                /* The last default wins, and only over other defaults. */
+                if (*slot == NULL || (*slot)->cpu == ARC_OPCODE_DEFAULT) {
+                    *slot = detail;
+                }
+            } else if ((detail->cpu & (1 << family)) != 0) {
+                /* The first family specific entry wins. */
+                if (*slot == NULL || (*slot)->cpu == ARC_OPCODE_DEFAULT) {
+                    *slot = detail;
+                }
+            }
+        }
+    }
+}
+
 void arc_aux_regs_init(void)
 {
+    static bool initialized;
     int i;
 
+    /* Called for every CPU instance, but the tables are global. */
+    if (initialized) {
+        return;
+    }
+    initialized = true;
+
     for (i = 0; i < ARC_AUX_REGS_DETAIL_LAST; i++) {
         enum arc_aux_reg_enum id = arc_aux_regs_detail[i].id;
         struct arc_aux_reg_detail *next = arc_aux_regs[id].first;
@@ -82,6 +132,8 @@ void arc_aux_regs_init(void)
         arc_aux_regs_detail[i].aux_reg = &(arc_aux_regs[id]);
         arc_aux_regs[id].first = &(arc_aux_regs_detail[i]);
     }
+
+    arc_aux_reg_map_init();
 }
 
 int
@@ -102,14 +154,13 @@ arc_aux_reg_address_for(enum arc_aux_reg_enum aux_reg_def,
     return 0;
 }
 
-struct arc_aux_reg_detail *
-arc_aux_reg_struct_for_address(int address, int isa_mask)
+static struct arc_aux_reg_detail *
+arc_aux_reg_struct_for_address_slow(int address, int isa_mask)
 {
     int i;
     bool has_default = false;
     struct arc_aux_reg_detail *default_ret = NULL;
 
-    /* TODO: Make this a binary search or something faster. */
     for (i = 0; i < ARC_AUX_REGS_DETAIL_LAST; i++) {
         if (arc_aux_regs_detail[i].address == address) {
             if (arc_aux_regs_detail[i].cpu == ARC_OPCODE_DEFAULT) {
@@ -128,6 +179,22 @@ arc_aux_reg_struct_for_address(int address, int isa_mask)
     return NULL;
 }
 
+struct arc_aux_reg_detail *
+arc_aux_reg_struct_for_address(int address, int isa_mask)
+{
+    /*
+     * A CPU has exactly one family bit set, any other mask (or an
+     * address outside of the map) takes the linear scan.
+     */
+    if (likely(address >= 0 && address < ARC_AUX_REG_MAP_SIZE &&
+               is_power_of_2(isa_mask) &&
+               isa_mask < (1 << ARC_AUX_REG_FAMILIES))) {
+        return arc_aux_reg_map[ctz32(isa_mask)][address];
+    }
+
+    return arc_aux_reg_struct_for_address_slow(address, isa_mask);
+}
+
 #define AUX_REG_GETTER(GET_FUNC) \
     target_ulong __attribute__((weak)) \
     GET_FUNC(const struct arc_aux_reg_detail *a, void *b) { \
@@ -35,6 +35,10 @@ void arc_gen_verifyCCFlag(const DisasCtxt *ctx, TCGv ret)
     TCGv nV = tcg_temp_new();
     TCGv nC = tcg_temp_new();
 
+    /* arc_decode() brings C and V up to date before the semfunc runs. */
+    tcg_debug_assert(!arc_cond_uses_cv(ctx->insn.cc)
+                     || ctx->cc_op == ARC_CC_OP_NONE);
+
     switch (ctx->insn.cc) {
     /* AL, RA */
     case ARC_COND_AL:
@@ -125,6 +129,92 @@ void arc_gen_verifyCCFlag(const DisasCtxt *ctx, TCGv ret)
     tcg_temp_free(nC);
 }
 
+bool arc_cond_uses_cv(int cond)
+{
+    switch (cond) {
+    case ARC_COND_CS:
+    case ARC_COND_CC:
+    case ARC_COND_VS:
+    case ARC_COND_VC:
+    case ARC_COND_GT:
+    case ARC_COND_GE:
+    case ARC_COND_LT:
+    case ARC_COND_LE:
+    case ARC_COND_HI:
+    case ARC_COND_LS:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Derive cpu_Cf and cpu_Vf from the recorded add/sub of kind OP. */
+static void arc_gen_cv_from_cc(enum arc_cc_op op)
+{
+    TCGv t1 = tcg_temp_new();
+    TCGv t2 = tcg_temp_new();
+    int msb = (op == ARC_CC_OP_ADD32 || op == ARC_CC_OP_SUB32)
+              ? 31 : TARGET_LONG_BITS - 1;
+
+    if (op == ARC_CC_OP_ADD || op == ARC_CC_OP_ADD32) {
+        /* C = (b & c) | ((b | c) & ~dest) */
+        tcg_gen_and_tl(t1, cpu_cc_src1, cpu_cc_src2);
+        tcg_gen_or_tl(t2, cpu_cc_src1, cpu_cc_src2);
+        tcg_gen_andc_tl(t2, t2, cpu_cc_dst);
+        tcg_gen_or_tl(t1, t1, t2);
+        /* V = (dest ^ b) & (dest ^ c) */
+        tcg_gen_xor_tl(t2, cpu_cc_dst, cpu_cc_src1);
+        tcg_gen_xor_tl(cpu_Vf, cpu_cc_dst, cpu_cc_src2);
+        tcg_gen_and_tl(cpu_Vf, cpu_Vf, t2);
+    } else {
+        /* C = (~b & c) | ((~b | c) & dest) */
+        tcg_gen_andc_tl(t1, cpu_cc_src2, cpu_cc_src1);
+        tcg_gen_orc_tl(t2, cpu_cc_src2, cpu_cc_src1);
+        tcg_gen_and_tl(t2, t2, cpu_cc_dst);
+        tcg_gen_or_tl(t1, t1, t2);
+        /* V = (b ^ c) & (b ^ dest) */
+        tcg_gen_xor_tl(t2, cpu_cc_src1, cpu_cc_src2);
+        tcg_gen_xor_tl(cpu_Vf, cpu_cc_src1, cpu_cc_dst);
+        tcg_gen_and_tl(cpu_Vf, cpu_Vf, t2);
+    }
+    tcg_gen_extract_tl(cpu_Cf, t1, msb, 1);
+    tcg_gen_extract_tl(cpu_Vf, cpu_Vf, msb, 1);
+
+    tcg_temp_free(t2);
+    tcg_temp_free(t1);
+}
+
+/*
+ * Make cpu_Cf and cpu_Vf valid.  When the pending operation is known at
+ * translation time the flags are computed inline, otherwise env decides.
+ */
+void arc_gen_compute_cv(DisasCtxt *ctx)
+{
+    switch (ctx->cc_op) {
+    case ARC_CC_OP_NONE:
+        return;
+    case ARC_CC_OP_DYNAMIC:
+        gen_helper_compute_cv(cpu_env);
+        break;
+    default:
+        arc_gen_cv_from_cc(ctx->cc_op);
+        tcg_gen_movi_tl(cpu_cc_op, ARC_CC_OP_NONE);
+        break;
+    }
+    ctx->cc_op = ARC_CC_OP_NONE;
+}
+
+/* Record a flag setting add/sub; C and V are derived on demand. */
+void arc_gen_set_cv_lazy(DisasCtxt *ctx, enum arc_cc_op op,
+                         TCGv dest, TCGv b, TCGv c)
+{
+    tcg_gen_mov_tl(cpu_cc_dst, dest);
+    tcg_gen_mov_tl(cpu_cc_src1, b);
+    tcg_gen_mov_tl(cpu_cc_src2, c);
+    tcg_gen_movi_tl(cpu_cc_op, op);
+    ctx->cc_op = op;
+}
+
 #define MEMIDX (ctx->mem_idx)
 
 #ifdef TARGET_ARC32
@@ -163,6 +253,80 @@ void arc_gen_get_memory(const DisasCtxt *ctx, TCGv dest, TCGv vaddr,
                        memop_for_size_sign[sign_extend][size]);
 }
 
+/*
+ * LLOCK/SCOND keep an exclusive monitor like target/arm: LLOCK records
+ * the address and the value it loaded, SCOND stores with a host
+ * compare-and-swap against that value and sets Z when the store happened.
+ * Exceptions and interrupts clear the monitor.
+ */
+void arc_gen_llock(const DisasCtxt *ctx, TCGv dest, TCGv addr, MemOp mop)
+{
+    tcg_gen_qemu_ld_tl(cpu_exclusive_val, addr, MEMIDX, mop | MO_ALIGN);
+    tcg_gen_mov_tl(cpu_exclusive_addr, addr);
+    tcg_gen_mov_tl(dest, cpu_exclusive_val);
+}
+
+void arc_gen_scond(const DisasCtxt *ctx, TCGv addr, TCGv value, MemOp mop)
+{
+    TCGLabel *fail_label = gen_new_label();
+    TCGLabel *done_label = gen_new_label();
+    TCGv tmp = tcg_temp_new();
+
+    tcg_gen_brcond_tl(TCG_COND_NE, addr, cpu_exclusive_addr, fail_label);
+    tcg_gen_atomic_cmpxchg_tl(tmp, cpu_exclusive_addr, cpu_exclusive_val,
+                              value, MEMIDX, mop | MO_ALIGN);
+    tcg_gen_setcond_tl(TCG_COND_EQ, cpu_Zf, tmp, cpu_exclusive_val);
+    tcg_gen_br(done_label);
+
+    gen_set_label(fail_label);
+    tcg_gen_movi_tl(cpu_Zf, 0);
+    gen_set_label(done_label);
+    tcg_gen_movi_tl(cpu_exclusive_addr, -1);
+
+    tcg_temp_free(tmp);
+}
+
+#ifdef TARGET_ARC32
+/* 64 bit variants working on the register pair DEST/PAIR. */
+void arc_gen_llockd(const DisasCtxt *ctx, TCGv dest, TCGv pair, TCGv addr)
+{
+    TCGv_i64 val = tcg_temp_new_i64();
+
+    tcg_gen_qemu_ld_i64(val, addr, MEMIDX, MO_UQ | MO_ALIGN);
+    tcg_gen_mov_tl(cpu_exclusive_addr, addr);
+    tcg_gen_extr_i64_tl(cpu_exclusive_val, cpu_exclusive_val_hi, val);
+    tcg_gen_mov_tl(dest, cpu_exclusive_val);
+    tcg_gen_mov_tl(pair, cpu_exclusive_val_hi);
+
+    tcg_temp_free_i64(val);
+}
+
+void arc_gen_scondd(const DisasCtxt *ctx, TCGv addr, TCGv value, TCGv pair)
+{
+    TCGLabel *fail_label = gen_new_label();
+    TCGLabel *done_label = gen_new_label();
+    TCGv_i64 cmp = tcg_temp_new_i64();
+    TCGv_i64 val = tcg_temp_new_i64();
+
+    tcg_gen_brcond_tl(TCG_COND_NE, addr, cpu_exclusive_addr, fail_label);
+    tcg_gen_concat_tl_i64(cmp, cpu_exclusive_val, cpu_exclusive_val_hi);
+    tcg_gen_concat_tl_i64(val, value, pair);
+    tcg_gen_atomic_cmpxchg_i64(val, cpu_exclusive_addr, cmp, val,
+                               MEMIDX, MO_UQ | MO_ALIGN);
+    tcg_gen_setcond_i64(TCG_COND_EQ, val, val, cmp);
+    tcg_gen_trunc_i64_tl(cpu_Zf, val);
+    tcg_gen_br(done_label);
+
+    gen_set_label(fail_label);
+    tcg_gen_movi_tl(cpu_Zf, 0);
+    gen_set_label(done_label);
+    tcg_gen_movi_tl(cpu_exclusive_addr, -1);
+
+    tcg_temp_free_i64(val);
+    tcg_temp_free_i64(cmp);
+}
+#endif
+
 void arc_gen_no_further_loads_pending(const DisasCtxt *ctx, TCGv ret)
 {
     /* TODO: To complete on SMP support. */
@@ -268,14 +432,20 @@ void arc_gen_get_register(TCGv ret, enum arc_registers reg)
 }
 
 
-void arc_gen_set_register(enum arc_registers reg, TCGv value)
+void arc_gen_set_register(DisasCtxt *ctx, enum arc_registers reg, TCGv value)
 {
     switch (reg) {
     case R_SP:
         tcg_gen_mov_tl(cpu_sp, value);
         break;
     case R_STATUS32:
+        /*
+         * The helper overwrites C and V and drops any pending add/sub, so
+         * later instructions must not derive them from cc_dst/cc_src again.
+         */
+        arc_gen_compute_cv(ctx);
         gen_helper_set_status32(cpu_env, value);
+        ctx->cc_op = ARC_CC_OP_NONE;
         break;
     case R_ACCLO:
         tcg_gen_mov_tl(cpu_acclo, value);
@@ -350,6 +520,128 @@ bool arc_is_instruction_operand_a_register(const DisasCtxt *ctx, int nop)
     return (operand.type & ARC_OPERAND_IR) != 0;
 }
 
+/*
+ * Detail of the aux register addressed by ADDR if its address is known
+ * at translate time, NULL otherwise.
+ */
+static const struct arc_aux_reg_detail *
+arc_gen_const_aux_reg(const DisasCtxt *ctx, TCGv addr)
+{
+    ARCCPU *cpu = env_archcpu(ctx->env);
+    target_ulong aux;
+
+    /* With icount, LR/SR are I/O and must stay the last insn of the TB. */
+    if (tb_cflags(ctx->base.tb) & CF_USE_ICOUNT) {
+        return NULL;
+    }
+    if (!arc_operand_is_const(ctx, addr, &aux)) {
+        return NULL;
+    }
+    return arc_aux_reg_struct_for_address(aux, cpu->family);
+}
+
+/*
+ * LR.  Aux registers that are constant for a given CPU model, or that are
+ * a plain CPUARCState field, are read in place instead of calling the lr
+ * helper.  IDENTITY is not one of them: TBs are shared between cores and
+ * ARCNUM differs per core.
+ */
+void arc_gen_read_aux_reg(const DisasCtxt *ctx, TCGv ret, TCGv addr)
+{
+    const struct arc_aux_reg_detail *detail =
+        arc_gen_const_aux_reg(ctx, addr);
+
+    if (detail != NULL &&
+        detail->aux_reg->get_func == arc_general_regs_get) {
+        switch (detail->id) {
+        case AUX_ID_aux_volatile:
+        case AUX_ID_exec_ctrl:
+        case AUX_ID_debug:
+        case AUX_ID_mpy_build:
+        case AUX_ID_isa_config:
+        case AUX_ID_hw_pf_ctrl:
+            tcg_gen_movi_tl(ret, arc_general_regs_get(detail, ctx->env));
+            return;
+        case AUX_ID_eret:
+            tcg_gen_mov_tl(ret, cpu_eret);
+            return;
+        case AUX_ID_erbta:
+            tcg_gen_mov_tl(ret, cpu_erbta);
+            return;
+        case AUX_ID_efa:
+            tcg_gen_mov_tl(ret, cpu_efa);
+            return;
+        case AUX_ID_bta:
+            tcg_gen_mov_tl(ret, cpu_bta);
+            return;
+        case AUX_ID_ecr:
+            tcg_gen_ld_tl(ret, cpu_env, offsetof(CPUARCState, ecr));
+            return;
+        case AUX_ID_bta_l1:
+            tcg_gen_ld_tl(ret, cpu_env, offsetof(CPUARCState, bta_l1));
+            return;
+        case AUX_ID_bta_l2:
+            tcg_gen_ld_tl(ret, cpu_env, offsetof(CPUARCState, bta_l2));
+            return;
+        case AUX_ID_lp_start:
+#if defined(TARGET_ARC32)
+            tcg_gen_mov_tl(ret, cpu_lps);
+#else
+            tcg_gen_ld_tl(ret, cpu_env, offsetof(CPUARCState, lps));
+#endif
+            return;
+        case AUX_ID_lp_end:
+#if defined(TARGET_ARC32)
+            tcg_gen_mov_tl(ret, cpu_lpe);
+#else
+            tcg_gen_ld_tl(ret, cpu_env, offsetof(CPUARCState, lpe));
+#endif
+            return;
+        default:
+            break;
+        }
+    }
+
+    gen_helper_lr(ret, cpu_env, addr);
+}
+
+/*
+ * SR.  Returns true if the translation block must end after the write,
+ * which is the case for anything going through the sr helper: the write
+ * may change how code is translated (MMU, MPU, loop registers...).
+ */
+bool arc_gen_write_aux_reg(const DisasCtxt *ctx, TCGv addr, TCGv val)
+{
+    const struct arc_aux_reg_detail *detail =
+        arc_gen_const_aux_reg(ctx, addr);
+
+    if (detail != NULL &&
+        detail->aux_reg->set_func == arc_general_regs_set) {
+        switch (detail->id) {
+        case AUX_ID_eret:
+            tcg_gen_mov_tl(cpu_eret, val);
+            return false;
+        case AUX_ID_erbta:
+            tcg_gen_mov_tl(cpu_erbta, val);
+            return false;
+        case AUX_ID_efa:
+            tcg_gen_mov_tl(cpu_efa, val);
+            return false;
+        case AUX_ID_bta:
+            tcg_gen_mov_tl(cpu_bta, val);
+            return false;
+        case AUX_ID_ecr:
+            tcg_gen_st_tl(val, cpu_env, offsetof(CPUARCState, ecr));
+            return false;
+        default:
+            break;
+        }
+    }
+
+    gen_helper_sr(cpu_env, val, addr);
+    return true;
+}
+
 
 /*-*-indent-tabs-mode:nil;tab-width:4;indent-line-function:'insert-tab'-*-*/
 /* vim: set ts=4 sw=4 et: */
@@ -106,6 +106,13 @@ void arc_gen_get_memory(
 #define getAAFlag() (ctx->insn.aa)
 
 #define SignExtend(VALUE, SIZE) VALUE
+void arc_gen_llock(const DisasCtxt *ctx, TCGv dest, TCGv addr, MemOp mop);
+void arc_gen_scond(const DisasCtxt *ctx, TCGv addr, TCGv value, MemOp mop);
+#ifdef TARGET_ARC32
+void arc_gen_llockd(const DisasCtxt *ctx, TCGv dest, TCGv pair, TCGv addr);
+void arc_gen_scondd(const DisasCtxt *ctx, TCGv addr, TCGv value, TCGv pair);
+#endif
+
 void arc_gen_no_further_loads_pending(const DisasCtxt *ctx, TCGv ret);
 #define NoFurtherLoadsPending(R)    arc_gen_no_further_loads_pending(ctx, R)
 void arc_gen_set_debug(const DisasCtxt *ctx, bool value);
@@ -130,10 +137,41 @@ void arc_gen_set_debug(const DisasCtxt *ctx, bool value);
     tcg_temp_free(_tmp); \
 }
 
-#define setCFlag(ELEM)  tcg_gen_andi_tl(cpu_Cf, ELEM, 1)
-#define getCFlag(R)     tcg_gen_mov_tl(R, cpu_Cf)
+/*
+ * C and V are evaluated lazily: flag setting add/sub only record their
+ * result and operands, and cpu_Cf/cpu_Vf are brought up to date right
+ * before something reads or partially overwrites them.
+ */
+bool arc_cond_uses_cv(int cond);
+void arc_gen_compute_cv(DisasCtxt *ctx);
+void arc_gen_set_cv_lazy(DisasCtxt *ctx, enum arc_cc_op op,
+                         TCGv dest, TCGv b, TCGv c);
+
+#define setCFlag(ELEM)                                  \
+    do {                                                \
+        arc_gen_compute_cv(ctx);                        \
+        tcg_gen_andi_tl(cpu_Cf, ELEM, 1);               \
+    } while (0)
+#define getCFlag(R)                                     \
+    do {                                                \
+        arc_gen_compute_cv(ctx);                        \
+        tcg_gen_mov_tl(R, cpu_Cf);                      \
+    } while (0)
+
+#define setVFlag(ELEM)                                  \
+    do {                                                \
+        arc_gen_compute_cv(ctx);                        \
+        tcg_gen_andi_tl(cpu_Vf, ELEM, 1);               \
+    } while (0)
 
-#define setVFlag(ELEM)  tcg_gen_andi_tl(cpu_Vf, ELEM, 1)
+#define setCVFlagsADD(D, B, C)   arc_gen_set_cv_lazy(ctx, ARC_CC_OP_ADD, D, B, C)
+#define setCVFlagsSUB(D, B, C)   arc_gen_set_cv_lazy(ctx, ARC_CC_OP_SUB, D, B, C)
+#ifdef TARGET_ARC64
+#define setCVFlagsADD32(D, B, C) \
+    arc_gen_set_cv_lazy(ctx, ARC_CC_OP_ADD32, D, B, C)
+#define setCVFlagsSUB32(D, B, C) \
+    arc_gen_set_cv_lazy(ctx, ARC_CC_OP_SUB32, D, B, C)
+#endif
 
 #define setZFlag(ELEM)  \
     tcg_gen_setcondi_tl(TCG_COND_EQ, cpu_Zf, ELEM, 0);
@@ -222,7 +260,10 @@ void arc_gen_get_bit(TCGv ret, TCGv a, TCGv pos);
 
 #define getRegIndex(R, ID)  tcg_gen_movi_tl(R, (int) ID)
 
-#define readAuxReg(R, A)    gen_helper_lr(R, cpu_env, A)
+void arc_gen_read_aux_reg(const DisasCtxt *ctx, TCGv ret, TCGv addr);
+bool arc_gen_write_aux_reg(const DisasCtxt *ctx, TCGv addr, TCGv val);
+
+#define readAuxReg(R, A)    arc_gen_read_aux_reg(ctx, R, A)
 /*
  * Here, by returning DISAS_UPDATE we are making SR the end
  * of a Translation Block (TB). This is necessary because
@@ -230,12 +271,14 @@ void arc_gen_get_bit(TCGv ret, TCGv a, TCGv pos);
  * handled, like enabling MMU/MPU. If SR is not marked as the
  * end, the next instructions are fetched and generated and
  * the updated outcome (page/region permissions) is not taken
- * into account.
+ * into account.  Plain register writes resolved at translate
+ * time don't need it.
  */
-#define writeAuxReg(NAME, B)             \
-    do {                                 \
-        gen_helper_sr(cpu_env, B, NAME); \
-        ret = DISAS_UPDATE;              \
+#define writeAuxReg(NAME, B)                       \
+    do {                                           \
+        if (arc_gen_write_aux_reg(ctx, NAME, B)) { \
+            ret = DISAS_UPDATE;                    \
+        }                                          \
     } while (0)
 
 /*
@@ -288,9 +331,9 @@ void arc_gen_extract_bits(TCGv ret, TCGv a, TCGv start, TCGv end);
     arc_gen_extract_bits(R, ELEM, START, END)
 void arc_gen_get_register(TCGv ret, enum arc_registers reg);
 #define getRegister(R, REG) arc_gen_get_register(R, REG)
-void arc_gen_set_register(enum arc_registers reg, TCGv value);
+void arc_gen_set_register(DisasCtxt *ctx, enum arc_registers reg, TCGv value);
 #define setRegister(REG, VALUE) \
-    arc_gen_set_register(REG, VALUE); \
+    arc_gen_set_register(ctx, REG, VALUE); \
     if (REG == R_STATUS32) { \
         ret = DISAS_NORETURN; \
     } \
@@ -476,8 +476,7 @@ arc_gen_KFLAG(DisasCtxt *ctx, TCGv src)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarryADD (@a, lb, lc));
- *           setVFlag (OverflowADD (@a, lb, lc));
+ *           setCVFlagsADD (@a, lb, lc);
  *         };
  *     };
  * }
@@ -493,10 +492,6 @@ arc_gen_ADD(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv lc = tcg_temp_local_new();
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -512,12 +507,7 @@ arc_gen_ADD(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarryADD(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowADD(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsADD(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -526,10 +516,6 @@ arc_gen_ADD(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(lc);
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -552,8 +538,7 @@ arc_gen_ADD(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarryADD (@a, lb, lc));
- *           setVFlag (OverflowADD (@a, lb, lc));
+ *           setCVFlagsADD (@a, lb, lc);
  *         };
  *     };
  * }
@@ -569,10 +554,6 @@ arc_gen_ADD1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv lc = tcg_temp_local_new();
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -586,12 +567,7 @@ arc_gen_ADD1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarryADD(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowADD(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsADD(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -600,10 +576,6 @@ arc_gen_ADD1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(lc);
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -626,8 +598,7 @@ arc_gen_ADD1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarryADD (@a, lb, lc));
- *           setVFlag (OverflowADD (@a, lb, lc));
+ *           setCVFlagsADD (@a, lb, lc);
  *         };
  *     };
  * }
@@ -643,10 +614,6 @@ arc_gen_ADD2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv lc = tcg_temp_local_new();
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -660,12 +627,7 @@ arc_gen_ADD2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarryADD(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowADD(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsADD(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -674,10 +636,6 @@ arc_gen_ADD2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(lc);
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -700,8 +658,7 @@ arc_gen_ADD2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarryADD (@a, lb, lc));
- *           setVFlag (OverflowADD (@a, lb, lc));
+ *           setCVFlagsADD (@a, lb, lc);
  *         };
  *     };
  * }
@@ -717,10 +674,6 @@ arc_gen_ADD3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv lc = tcg_temp_local_new();
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -734,12 +687,7 @@ arc_gen_ADD3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarryADD(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowADD(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsADD(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -748,10 +696,6 @@ arc_gen_ADD3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(lc);
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -776,8 +720,7 @@ arc_gen_ADD3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarryADD (@a, lb, lc));
- *           setVFlag (OverflowADD (@a, lb, lc));
+ *           setCVFlagsADD (@a, lb, lc);
  *         };
  *     };
  * }
@@ -796,10 +739,6 @@ arc_gen_ADC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_4 = tcg_temp_local_new();
     TCGv temp_6 = tcg_temp_local_new();
     TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_8 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_10 = tcg_temp_local_new();
-    TCGv temp_9 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -818,12 +757,7 @@ arc_gen_ADC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarryADD(temp_8, a, lb, lc);
-        tcg_gen_mov_tl(temp_7, temp_8);
-        setCFlag(temp_7);
-        OverflowADD(temp_10, a, lb, lc);
-        tcg_gen_mov_tl(temp_9, temp_10);
-        setVFlag(temp_9);
+        setCVFlagsADD(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -835,10 +769,6 @@ arc_gen_ADC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_4);
     tcg_temp_free(temp_6);
     tcg_temp_free(temp_5);
-    tcg_temp_free(temp_8);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_10);
-    tcg_temp_free(temp_9);
 
     return ret;
 }
@@ -863,8 +793,7 @@ arc_gen_ADC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarrySUB (@a, lb, lc));
- *           setVFlag (OverflowSUB (@a, lb, lc));
+ *           setCVFlagsSUB (@a, lb, lc);
  *         };
  *     };
  * }
@@ -883,10 +812,6 @@ arc_gen_SBC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_4 = tcg_temp_local_new();
     TCGv temp_6 = tcg_temp_local_new();
     TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_8 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_10 = tcg_temp_local_new();
-    TCGv temp_9 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -905,12 +830,7 @@ arc_gen_SBC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarrySUB(temp_8, a, lb, lc);
-        tcg_gen_mov_tl(temp_7, temp_8);
-        setCFlag(temp_7);
-        OverflowSUB(temp_10, a, lb, lc);
-        tcg_gen_mov_tl(temp_9, temp_10);
-        setVFlag(temp_9);
+        setCVFlagsSUB(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -922,10 +842,6 @@ arc_gen_SBC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_4);
     tcg_temp_free(temp_6);
     tcg_temp_free(temp_5);
-    tcg_temp_free(temp_8);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_10);
-    tcg_temp_free(temp_9);
 
     return ret;
 }
@@ -948,8 +864,7 @@ arc_gen_SBC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarrySUB (@a, 0, lb));
- *           setVFlag (OverflowSUB (@a, 0, lb));
+ *           setCVFlagsSUB (@a, 0, lb);
  *         };
  *     };
  * }
@@ -965,11 +880,6 @@ arc_gen_NEG(DisasCtxt *ctx, TCGv b, TCGv a)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv temp_6 = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_9 = tcg_temp_local_new();
-    TCGv temp_8 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -984,13 +894,7 @@ arc_gen_NEG(DisasCtxt *ctx, TCGv b, TCGv a)
         setZFlag(a);
         setNFlag(a);
         tcg_gen_movi_tl(temp_6, 0);
-        CarrySUB(temp_5, a, temp_6, lb);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        tcg_gen_movi_tl(temp_9, 0);
-        OverflowSUB(temp_8, a, temp_9, lb);
-        tcg_gen_mov_tl(temp_7, temp_8);
-        setVFlag(temp_7);
+        setCVFlagsSUB(a, temp_6, lb);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -999,11 +903,6 @@ arc_gen_NEG(DisasCtxt *ctx, TCGv b, TCGv a)
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(temp_6);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_9);
-    tcg_temp_free(temp_8);
-    tcg_temp_free(temp_7);
 
     return ret;
 }
@@ -1027,8 +926,7 @@ arc_gen_NEG(DisasCtxt *ctx, TCGv b, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarrySUB (@a, lb, lc));
- *           setVFlag (OverflowSUB (@a, lb, lc));
+ *           setCVFlagsSUB (@a, lb, lc);
  *         };
  *     };
  * }
@@ -1044,10 +942,6 @@ arc_gen_SUB(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv lc = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -1062,12 +956,7 @@ arc_gen_SUB(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarrySUB(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowSUB(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsSUB(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -1076,10 +965,6 @@ arc_gen_SUB(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(lc);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -1103,8 +988,7 @@ arc_gen_SUB(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarrySUB (@a, lb, lc));
- *           setVFlag (OverflowSUB (@a, lb, lc));
+ *           setCVFlagsSUB (@a, lb, lc);
  *         };
  *     };
  * }
@@ -1120,10 +1004,6 @@ arc_gen_SUB1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv lc = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -1138,12 +1018,7 @@ arc_gen_SUB1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarrySUB(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowSUB(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsSUB(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -1152,10 +1027,6 @@ arc_gen_SUB1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(lc);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -1179,8 +1050,7 @@ arc_gen_SUB1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarrySUB (@a, lb, lc));
- *           setVFlag (OverflowSUB (@a, lb, lc));
+ *           setCVFlagsSUB (@a, lb, lc);
  *         };
  *     };
  * }
@@ -1196,10 +1066,6 @@ arc_gen_SUB2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv lc = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -1214,12 +1080,7 @@ arc_gen_SUB2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarrySUB(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowSUB(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsSUB(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -1228,10 +1089,6 @@ arc_gen_SUB2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(lc);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -1255,8 +1112,7 @@ arc_gen_SUB2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarrySUB (@a, lb, lc));
- *           setVFlag (OverflowSUB (@a, lb, lc));
+ *           setCVFlagsSUB (@a, lb, lc);
  *         };
  *     };
  * }
@@ -1272,10 +1128,6 @@ arc_gen_SUB3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv lc = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -1290,12 +1142,7 @@ arc_gen_SUB3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarrySUB(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowSUB(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsSUB(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -1304,10 +1151,6 @@ arc_gen_SUB3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(lc);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -1339,8 +1182,7 @@ arc_gen_SUB3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (alu);
  *           setNFlag (alu);
- *           setCFlag (CarrySUB (@a, lb, lc));
- *           setVFlag (OverflowSUB (@a, lb, lc));
+ *           setCVFlagsSUB (@a, lb, lc);
  *         };
  *     };
  * }
@@ -1359,10 +1201,6 @@ arc_gen_MAX(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv alu = tcg_temp_local_new();
     TCGv temp_3 = tcg_temp_local_new();
     TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
-    TCGv temp_9 = tcg_temp_local_new();
-    TCGv temp_8 = tcg_temp_local_new();
     getCCFlag(temp_5);
     tcg_gen_mov_tl(cc_flag, temp_5);
     tcg_gen_mov_tl(lb, b);
@@ -1388,12 +1226,7 @@ arc_gen_MAX(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(alu);
         setNFlag(alu);
-        CarrySUB(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setCFlag(temp_6);
-        OverflowSUB(temp_9, a, lb, lc);
-        tcg_gen_mov_tl(temp_8, temp_9);
-        setVFlag(temp_8);
+        setCVFlagsSUB(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_5);
@@ -1405,10 +1238,6 @@ arc_gen_MAX(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(alu);
     tcg_temp_free(temp_3);
     tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
-    tcg_temp_free(temp_9);
-    tcg_temp_free(temp_8);
 
     return ret;
 }
@@ -1440,8 +1269,7 @@ arc_gen_MAX(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (alu);
  *           setNFlag (alu);
- *           setCFlag (CarrySUB (@a, lb, lc));
- *           setVFlag (OverflowSUB (@a, lb, lc));
+ *           setCVFlagsSUB (@a, lb, lc);
  *         };
  *     };
  * }
@@ -1460,10 +1288,6 @@ arc_gen_MIN(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv alu = tcg_temp_local_new();
     TCGv temp_3 = tcg_temp_local_new();
     TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
-    TCGv temp_9 = tcg_temp_local_new();
-    TCGv temp_8 = tcg_temp_local_new();
     getCCFlag(temp_5);
     tcg_gen_mov_tl(cc_flag, temp_5);
     tcg_gen_mov_tl(lb, b);
@@ -1489,12 +1313,7 @@ arc_gen_MIN(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(alu);
         setNFlag(alu);
-        CarrySUB(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setCFlag(temp_6);
-        OverflowSUB(temp_9, a, lb, lc);
-        tcg_gen_mov_tl(temp_8, temp_9);
-        setVFlag(temp_8);
+        setCVFlagsSUB(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_5);
@@ -1506,10 +1325,6 @@ arc_gen_MIN(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(alu);
     tcg_temp_free(temp_3);
     tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
-    tcg_temp_free(temp_9);
-    tcg_temp_free(temp_8);
 
     return ret;
 }
@@ -1528,8 +1343,7 @@ arc_gen_MIN(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *       alu = (@b - @c);
  *       setZFlag (alu);
  *       setNFlag (alu);
- *       setCFlag (CarrySUB (alu, @b, @c));
- *       setVFlag (OverflowSUB (alu, @b, @c));
+ *       setCVFlagsSUB (alu, @b, @c);
  *     };
  * }
  */
@@ -1543,10 +1357,6 @@ arc_gen_CMP(DisasCtxt *ctx, TCGv b, TCGv c)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv alu = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     TCGLabel *done_1 = gen_new_label();
@@ -1557,22 +1367,13 @@ arc_gen_CMP(DisasCtxt *ctx, TCGv b, TCGv c)
     tcg_gen_sub_tl(alu, b, c);
     setZFlag(alu);
     setNFlag(alu);
-    CarrySUB(temp_5, alu, b, c);
-    tcg_gen_mov_tl(temp_4, temp_5);
-    setCFlag(temp_4);
-    OverflowSUB(temp_7, alu, b, c);
-    tcg_gen_mov_tl(temp_6, temp_7);
-    setVFlag(temp_6);
+    setCVFlagsSUB(alu, b, c);
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
     tcg_temp_free(cc_flag);
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(alu);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -7541,12 +7342,6 @@ arc_gen_EX (DisasCtxt *ctx, TCGv b, TCGv c)
 }
 
 
-//#define ARM_LIKE_LLOCK_SCOND
-
-extern TCGv cpu_exclusive_addr;
-extern TCGv cpu_exclusive_val;
-extern TCGv cpu_exclusive_val_hi;
-
 /*
  * LLOCK -- CODED BY HAND
  */
@@ -7555,13 +7350,8 @@ int
 arc_gen_LLOCK(DisasCtxt *ctx, TCGv dest, TCGv src)
 {
     int ret = DISAS_NEXT;
-#ifndef ARM_LIKE_LLOCK_SCOND
-    gen_helper_llock(dest, cpu_env, src);
-#else
-    tcg_gen_qemu_ld_tl(cpu_exclusive_val, src, ctx->mem_idx, MO_UL);
-    tcg_gen_mov_tl(dest, cpu_exclusive_val);
-    tcg_gen_mov_tl(cpu_exclusive_addr, src);
-#endif
+
+    arc_gen_llock(ctx, dest, src, MO_UL);
 
     return ret;
 }
@@ -7577,27 +7367,7 @@ arc_gen_LLOCKD(DisasCtxt *ctx, TCGv dest, TCGv src)
     int ret = DISAS_NEXT;
     TCGv pair = nextReg (dest);
 
-    TCGv_i64 temp_1 = tcg_temp_local_new_i64();
-    TCGv_i64 temp_2 = tcg_temp_local_new_i64();
-
-#ifndef ARM_LIKE_LLOCK_SCOND
-    gen_helper_llockd(temp_1, cpu_env, src);
-#else
-    tcg_gen_qemu_ld_i64(temp_1, src, ctx->mem_idx, MO_UQ);
-    tcg_gen_mov_tl(cpu_exclusive_addr, src);
-
-    tcg_gen_shri_i64(temp_2, temp_1, 32);
-    tcg_gen_trunc_i64_tl(cpu_exclusive_val_hi, temp_2);
-    tcg_gen_trunc_i64_tl(cpu_exclusive_val, temp_1);
-#endif
-
-    tcg_gen_shri_i64(temp_2, temp_1, 32);
-    tcg_gen_trunc_i64_tl(pair, temp_2);
-    tcg_gen_trunc_i64_tl(dest, temp_1);
-
-    tcg_temp_free_i64(temp_1);
-    tcg_temp_free_i64(temp_2);
-
+    arc_gen_llockd(ctx, dest, pair, src);
 
     return ret;
 }
@@ -7611,34 +7381,8 @@ int
 arc_gen_SCOND(DisasCtxt *ctx, TCGv addr, TCGv value)
 {
     int ret = DISAS_NEXT;
-#ifndef ARM_LIKE_LLOCK_SCOND
-    TCGv temp_4 = tcg_temp_local_new();
-    gen_helper_scond(temp_4, cpu_env, addr, value);
-    setZFlag(temp_4);
-    tcg_temp_free(temp_4);
-#else
-    TCGLabel *fail_label = gen_new_label();
-    TCGLabel *done_label = gen_new_label();
-    TCGv tmp;
-
-    tcg_gen_brcond_tl(TCG_COND_NE, addr, cpu_exclusive_addr, fail_label);
-    tmp = tcg_temp_new();
-
-    tcg_gen_atomic_cmpxchg_tl(tmp, cpu_exclusive_addr, cpu_exclusive_val,
-                               value, ctx->mem_idx,
-                               MO_UL | MO_ALIGN);
-    tcg_gen_setcond_tl(TCG_COND_NE, tmp, tmp, cpu_exclusive_val);
-
-    setZFlag(tmp);
-
-    tcg_temp_free(tmp);
-    tcg_gen_br(done_label);
 
-    gen_set_label(fail_label);
-    tcg_gen_movi_tl(cpu_Zf, 1);
-    gen_set_label(done_label);
-    tcg_gen_movi_tl(cpu_exclusive_addr, -1);
-#endif
+    arc_gen_scond(ctx, addr, value, MO_UL);
 
     return ret;
 }
@@ -7652,63 +7396,9 @@ int
 arc_gen_SCONDD(DisasCtxt *ctx, TCGv addr, TCGv value)
 {
     int ret = DISAS_NEXT;
-    TCGv pair = NULL;
-    pair = nextReg (value);
-
-    TCGv_i64 temp_1 = tcg_temp_local_new_i64();
-    TCGv_i64 temp_2 = tcg_temp_local_new_i64();
-
-    TCGv_i64 temp_3 = tcg_temp_local_new_i64();
-    TCGv_i64 temp_4 = tcg_temp_local_new_i64();
-    TCGv_i64 exclusive_val = tcg_temp_local_new_i64();
-
-    tcg_gen_ext_i32_i64(temp_1, pair);
-    tcg_gen_ext_i32_i64(temp_2, value);
-    tcg_gen_shli_i64(temp_1, temp_1, 32);
-    tcg_gen_or_i64(temp_1, temp_1, temp_2);
-
-#ifndef ARM_LIKE_LLOCK_SCOND
-    TCGv temp_5 = tcg_temp_local_new();
-    gen_helper_scondd(temp_5, cpu_env, addr, temp_1);
-    setZFlag(temp_5);
-    tcg_temp_free(temp_5);
-#else
-    TCGLabel *fail_label = gen_new_label();
-    TCGLabel *done_label = gen_new_label();
-
-    tcg_gen_ext_i32_i64(temp_3, cpu_exclusive_val_hi);
-    tcg_gen_ext_i32_i64(temp_4, cpu_exclusive_val);
-    tcg_gen_shli_i64(temp_3, temp_3, 32);
-
-    tcg_gen_brcond_tl(TCG_COND_NE, addr, cpu_exclusive_addr, fail_label);
-
-    TCGv_i64 tmp = tcg_temp_new_i64();
-    TCGv tmp1 = tcg_temp_new();
-
-    tcg_gen_or_i64(exclusive_val, temp_3, temp_4);
-
-    tcg_gen_atomic_cmpxchg_i64(tmp, cpu_exclusive_addr, exclusive_val,
-                               temp_1, ctx->mem_idx,
-                               MO_UL | MO_ALIGN);
-    tcg_gen_setcond_i64(TCG_COND_NE, tmp, tmp, exclusive_val);
-    tcg_gen_trunc_i64_tl(tmp1, tmp);
-    setZFlag(tmp1);
+    TCGv pair = nextReg (value);
 
-    tcg_temp_free_i64(tmp);
-    tcg_temp_free(tmp1);
-    tcg_gen_br(done_label);
-
-    gen_set_label(fail_label);
-    tcg_gen_movi_tl(cpu_Zf, 1);
-    gen_set_label(done_label);
-    tcg_gen_movi_tl(cpu_exclusive_addr, -1);
-#endif
-
-    tcg_temp_free_i64(temp_1);
-    tcg_temp_free_i64(temp_2);
-    tcg_temp_free_i64(temp_3);
-    tcg_temp_free_i64(temp_4);
-    tcg_temp_free_i64(exclusive_val);
+    arc_gen_scondd(ctx, addr, value, pair);
 
     return ret;
 }
@@ -8783,45 +8473,19 @@ arc_gen_VSUB4H(DisasCtxt *ctx, TCGv dest, TCGv b, TCGv c)
  * VADDSUB and VSUBADD operations
  */
 
-static void
-arc_gen_cmpl2_i32(TCGv_i32 ret, TCGv_i32 arg1,
-                  unsigned int ofs, unsigned int len)
-{
-    TCGv_i32 t1 = tcg_temp_new_i32();
-    TCGv_i32 t2 = tcg_temp_new_i32();
-
-    tcg_gen_mov_i32(t1, arg1);
-    tcg_gen_extract_i32(t2, t1, ofs, len);
-    tcg_gen_not_i32(t2, t2);
-    tcg_gen_addi_i32(t2, t2, 1);
-    tcg_gen_deposit_i32(t1, t1, t2, ofs, len);
-    tcg_gen_mov_i32(ret, t1);
-
-    tcg_temp_free_i32(t2);
-	tcg_temp_free_i32(t1);
-}
-
-#define ARC_GEN_CMPL2_H0_I32(RET, ARG1)     arc_gen_cmpl2_i32(RET, ARG1, 0, 16)
-#define ARC_GEN_CMPL2_H1_I32(RET, ARG1)     arc_gen_cmpl2_i32(RET, ARG1, 16, 16)
-
-#define VEC_VADDSUB_VSUBADD_OP(NAME, FIELD, OP, TL)             \
+#define VEC_VADDSUB_VSUBADD_OP(NAME, LANES, OP, TL)             \
 static void                                                     \
 arc_gen_##NAME##_op(TCGv_##TL dest, TCGv_##TL b, TCGv_##TL c)   \
 {                                                               \
-    TCGv_##TL t1 = tcg_temp_new_##TL();                         \
-                                                                \
-    ARC_GEN_CMPL2_##FIELD(t1, c);                               \
-    tcg_gen_vec_##OP##_##TL(dest, b, t1);                       \
-                                                                \
-    tcg_temp_free_##TL(t1);                                     \
-}
-
-VEC_VADDSUB_VSUBADD_OP(vaddsub, W1_I64, add32, i64)
-VEC_VADDSUB_VSUBADD_OP(vaddsub2h, H1_I32, add16, i32)
-VEC_VADDSUB_VSUBADD_OP(vaddsub4h, H1_H3_I64, add16, i64)
-VEC_VADDSUB_VSUBADD_OP(vsubadd, W0_I64, add32, i64)
-VEC_VADDSUB_VSUBADD_OP(vsubadd2h, H0_I32, add16, i32)
-VEC_VADDSUB_VSUBADD_OP(vsubadd4h, H0_H2_I64, add16, i64)
+    arc_gen_vec_##OP##_##TL(dest, b, c, ARC_VEC_LANES_##LANES); \
+}
+
+VEC_VADDSUB_VSUBADD_OP(vaddsub, W1, addsub32, i64)
+VEC_VADDSUB_VSUBADD_OP(vaddsub2h, H1, addsub16, i32)
+VEC_VADDSUB_VSUBADD_OP(vaddsub4h, H1_H3, addsub16, i64)
+VEC_VADDSUB_VSUBADD_OP(vsubadd, W0, addsub32, i64)
+VEC_VADDSUB_VSUBADD_OP(vsubadd2h, H0, addsub16, i32)
+VEC_VADDSUB_VSUBADD_OP(vsubadd4h, H0_H2, addsub16, i64)
 
 /*
  * VADDSUB: VADDSUB, VADDSUB2H, VADDSUB4H
@@ -439,8 +439,7 @@ arc_gen_KFLAG (DisasCtxt *ctx, TCGv src)
         {
           setZFlag (@a);
           setNFlag32 (@a);
-          setCFlag (CarryADD32 (@a, lb, lc));
-          setVFlag (OverflowADD32 (@a, lb, lc));
+          setCVFlagsADD32 (@a, lb, lc);
         };
     };
 }
@@ -459,10 +458,6 @@ arc_gen_ADD (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_1 = tcg_temp_local_new();
   TCGv temp_2 = tcg_temp_local_new();
   TCGv temp_6 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   se32to64(temp_4, b);
@@ -480,12 +475,7 @@ arc_gen_ADD (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag32(a);
-  CarryADD32(temp_8, a, lb, lc);
-  tcg_gen_mov_tl(temp_7, temp_8);
-  setCFlag(temp_7);
-  OverflowADD32(temp_10, a, lb, lc);
-  tcg_gen_mov_tl(temp_9, temp_10);
-  setVFlag(temp_9);
+  setCVFlagsADD32(a, lb, lc);
 ;
     }
   else
@@ -502,10 +492,6 @@ arc_gen_ADD (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_1);
   tcg_temp_free(temp_2);
   tcg_temp_free(temp_6);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_10);
-  tcg_temp_free(temp_9);
 
   return ret;
 }
@@ -530,8 +516,7 @@ arc_gen_ADD (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag32 (@a);
- *           setCFlag (CarryADD32 (@a, lb, lc));
- *           setVFlag (OverflowADD32 (@a, lb, lc));
+ *           setCVFlagsADD32 (@a, lb, lc);
  *         };
  *     };
  * }
@@ -549,8 +534,6 @@ arc_gen_ADD1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     se32to64(lb, b);
@@ -566,10 +549,7 @@ arc_gen_ADD1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag32(a);
-        CarryADD32(temp_6, a, lb, lc);
-        setCFlag(temp_6);
-        OverflowADD32(temp_7, a, lb, lc);
-        setVFlag(temp_7);
+        setCVFlagsADD32(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -580,8 +560,6 @@ arc_gen_ADD1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(temp_5);
-    tcg_temp_free(temp_6);
-    tcg_temp_free(temp_7);
 
     return ret;
 }
@@ -605,8 +583,7 @@ arc_gen_ADD1(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag32 (@a);
- *           setCFlag (CarryADD32 (@a, lb, lc));
- *           setVFlag (OverflowADD32 (@a, lb, lc));
+ *           setCVFlagsADD32 (@a, lb, lc);
  *         };
  *     };
  * }
@@ -624,8 +601,6 @@ arc_gen_ADD2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     se32to64(lb, b);
@@ -641,10 +616,7 @@ arc_gen_ADD2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag32(a);
-        CarryADD32(temp_6, a, lb, lc);
-        setCFlag(temp_6);
-        OverflowADD32(temp_7, a, lb, lc);
-        setVFlag(temp_7);
+        setCVFlagsADD32(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -655,8 +627,6 @@ arc_gen_ADD2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(temp_5);
-    tcg_temp_free(temp_6);
-    tcg_temp_free(temp_7);
 
     return ret;
 }
@@ -681,8 +651,7 @@ arc_gen_ADD2(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag32 (@a);
- *           setCFlag (CarryADD32 (@a, lb, lc));
- *           setVFlag (OverflowADD32 (@a, lb, lc));
+ *           setCVFlagsADD32 (@a, lb, lc);
  *         };
  *     };
  * }
@@ -700,8 +669,6 @@ arc_gen_ADD3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
     TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     se32to64(lb, b);
@@ -717,10 +684,7 @@ arc_gen_ADD3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag32(a);
-        CarryADD32(temp_6, a, lb, lc);
-        setCFlag(temp_6);
-        OverflowADD32(temp_7, a, lb, lc);
-        setVFlag(temp_7);
+        setCVFlagsADD32(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -731,8 +695,6 @@ arc_gen_ADD3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
     tcg_temp_free(temp_5);
-    tcg_temp_free(temp_6);
-    tcg_temp_free(temp_7);
 
     return ret;
 }
@@ -760,8 +722,7 @@ arc_gen_ADD3(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag32 (@a);
-          setCFlag (CarryADD32 (@a, lb, lc));
-          setVFlag (OverflowADD32 (@a, lb, lc));
+          setCVFlagsADD32 (@a, lb, lc);
         };
     };
 }
@@ -782,10 +743,6 @@ arc_gen_ADC (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_6 = tcg_temp_local_new();
   TCGv temp_8 = tcg_temp_local_new();
   TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_12 = tcg_temp_local_new();
-  TCGv temp_11 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   se32to64(temp_4, b);
@@ -806,12 +763,7 @@ arc_gen_ADC (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag32(a);
-  CarryADD32(temp_10, a, lb, lc);
-  tcg_gen_mov_tl(temp_9, temp_10);
-  setCFlag(temp_9);
-  OverflowADD32(temp_12, a, lb, lc);
-  tcg_gen_mov_tl(temp_11, temp_12);
-  setVFlag(temp_11);
+  setCVFlagsADD32(a, lb, lc);
 ;
     }
   else
@@ -830,10 +782,6 @@ arc_gen_ADC (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_6);
   tcg_temp_free(temp_8);
   tcg_temp_free(temp_7);
-  tcg_temp_free(temp_10);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_12);
-  tcg_temp_free(temp_11);
 
   return ret;
 }
@@ -859,8 +807,7 @@ arc_gen_ADC (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag32 (@a);
-          setCFlag (CarrySUB32 (@a, lb, lc));
-          setVFlag (OverflowSUB32 (@a, lb, lc));
+          setCVFlagsSUB32 (@a, lb, lc);
         };
     };
 }
@@ -881,10 +828,6 @@ arc_gen_SBC (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_6 = tcg_temp_local_new();
   TCGv temp_8 = tcg_temp_local_new();
   TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_12 = tcg_temp_local_new();
-  TCGv temp_11 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   se32to64(temp_4, b);
@@ -905,12 +848,7 @@ arc_gen_SBC (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag32(a);
-  CarrySUB32(temp_10, a, lb, lc);
-  tcg_gen_mov_tl(temp_9, temp_10);
-  setCFlag(temp_9);
-  OverflowSUB32(temp_12, a, lb, lc);
-  tcg_gen_mov_tl(temp_11, temp_12);
-  setVFlag(temp_11);
+  setCVFlagsSUB32(a, lb, lc);
 ;
     }
   else
@@ -929,10 +867,6 @@ arc_gen_SBC (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_6);
   tcg_temp_free(temp_8);
   tcg_temp_free(temp_7);
-  tcg_temp_free(temp_10);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_12);
-  tcg_temp_free(temp_11);
 
   return ret;
 }
@@ -956,8 +890,7 @@ arc_gen_SBC (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag32 (@a);
-          setCFlag (CarrySUB32 (@a, 0, lb));
-          setVFlag (OverflowSUB32 (@a, 0, lb));
+          setCVFlagsSUB32 (@a, 0, lb);
         };
     };
 }
@@ -974,11 +907,6 @@ arc_gen_NEG (DisasCtxt *ctx, TCGv b, TCGv a)
   TCGv temp_1 = tcg_temp_local_new();
   TCGv temp_2 = tcg_temp_local_new();
   TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
-  TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   se32to64(temp_4, b);
@@ -994,13 +922,7 @@ arc_gen_NEG (DisasCtxt *ctx, TCGv b, TCGv a)
     setZFlag(a);
   setNFlag32(a);
   tcg_gen_movi_tl(temp_7, 0);
-  CarrySUB32(temp_6, a, temp_7, lb);
-  tcg_gen_mov_tl(temp_5, temp_6);
-  setCFlag(temp_5);
-  tcg_gen_movi_tl(temp_10, 0);
-  OverflowSUB32(temp_9, a, temp_10, lb);
-  tcg_gen_mov_tl(temp_8, temp_9);
-  setVFlag(temp_8);
+  setCVFlagsSUB32(a, temp_7, lb);
 ;
     }
   else
@@ -1015,11 +937,6 @@ arc_gen_NEG (DisasCtxt *ctx, TCGv b, TCGv a)
   tcg_temp_free(temp_1);
   tcg_temp_free(temp_2);
   tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
-  tcg_temp_free(temp_5);
-  tcg_temp_free(temp_10);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_8);
 
   return ret;
 }
@@ -1044,8 +961,7 @@ arc_gen_NEG (DisasCtxt *ctx, TCGv b, TCGv a)
         {
           setZFlag (@a);
           setNFlag32 (@a);
-          setCFlag (CarrySUB32 (@a, lb, lc));
-          setVFlag (OverflowSUB32 (@a, lb, lc));
+          setCVFlagsSUB32 (@a, lb, lc);
         };
     };
 }
@@ -1064,10 +980,6 @@ arc_gen_SUB (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_5 = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
   TCGv temp_6 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   se32to64(temp_4, b);
@@ -1085,12 +997,7 @@ arc_gen_SUB (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag32(a);
-  CarrySUB32(temp_8, a, lb, lc);
-  tcg_gen_mov_tl(temp_7, temp_8);
-  setCFlag(temp_7);
-  OverflowSUB32(temp_10, a, lb, lc);
-  tcg_gen_mov_tl(temp_9, temp_10);
-  setVFlag(temp_9);
+  setCVFlagsSUB32(a, lb, lc);
 ;
     }
   else
@@ -1107,10 +1014,6 @@ arc_gen_SUB (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_5);
   tcg_temp_free(lc);
   tcg_temp_free(temp_6);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_10);
-  tcg_temp_free(temp_9);
 
   return ret;
 }
@@ -1135,8 +1038,7 @@ arc_gen_SUB (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag32 (@a);
-          setCFlag (CarrySUB32 (@a, lb, lc));
-          setVFlag (OverflowSUB32 (@a, lb, lc));
+          setCVFlagsSUB32 (@a, lb, lc);
         };
     };
 }
@@ -1156,10 +1058,6 @@ arc_gen_SUB1 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_5 = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
   TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_11 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   se32to64(temp_4, b);
@@ -1178,12 +1076,7 @@ arc_gen_SUB1 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag32(a);
-  CarrySUB32(temp_9, a, lb, lc);
-  tcg_gen_mov_tl(temp_8, temp_9);
-  setCFlag(temp_8);
-  OverflowSUB32(temp_11, a, lb, lc);
-  tcg_gen_mov_tl(temp_10, temp_11);
-  setVFlag(temp_10);
+  setCVFlagsSUB32(a, lb, lc);
 ;
     }
   else
@@ -1201,10 +1094,6 @@ arc_gen_SUB1 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_5);
   tcg_temp_free(lc);
   tcg_temp_free(temp_7);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_11);
-  tcg_temp_free(temp_10);
 
   return ret;
 }
@@ -1229,8 +1118,7 @@ arc_gen_SUB1 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag32 (@a);
-          setCFlag (CarrySUB32 (@a, lb, lc));
-          setVFlag (OverflowSUB32 (@a, lb, lc));
+          setCVFlagsSUB32 (@a, lb, lc);
         };
     };
 }
@@ -1250,10 +1138,6 @@ arc_gen_SUB2 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_5 = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
   TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_11 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   se32to64(temp_4, b);
@@ -1272,12 +1156,7 @@ arc_gen_SUB2 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag32(a);
-  CarrySUB32(temp_9, a, lb, lc);
-  tcg_gen_mov_tl(temp_8, temp_9);
-  setCFlag(temp_8);
-  OverflowSUB32(temp_11, a, lb, lc);
-  tcg_gen_mov_tl(temp_10, temp_11);
-  setVFlag(temp_10);
+  setCVFlagsSUB32(a, lb, lc);
 ;
     }
   else
@@ -1295,10 +1174,6 @@ arc_gen_SUB2 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_5);
   tcg_temp_free(lc);
   tcg_temp_free(temp_7);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_11);
-  tcg_temp_free(temp_10);
 
   return ret;
 }
@@ -1323,8 +1198,7 @@ arc_gen_SUB2 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag32 (@a);
-          setCFlag (CarrySUB32 (@a, lb, lc));
-          setVFlag (OverflowSUB32 (@a, lb, lc));
+          setCVFlagsSUB32 (@a, lb, lc);
         };
     };
 }
@@ -1344,10 +1218,6 @@ arc_gen_SUB3 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_5 = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
   TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_11 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   se32to64(temp_4, b);
@@ -1366,12 +1236,7 @@ arc_gen_SUB3 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag32(a);
-  CarrySUB32(temp_9, a, lb, lc);
-  tcg_gen_mov_tl(temp_8, temp_9);
-  setCFlag(temp_8);
-  OverflowSUB32(temp_11, a, lb, lc);
-  tcg_gen_mov_tl(temp_10, temp_11);
-  setVFlag(temp_10);
+  setCVFlagsSUB32(a, lb, lc);
 ;
     }
   else
@@ -1389,10 +1254,6 @@ arc_gen_SUB3 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_5);
   tcg_temp_free(lc);
   tcg_temp_free(temp_7);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_11);
-  tcg_temp_free(temp_10);
 
   return ret;
 }
@@ -1425,8 +1286,7 @@ arc_gen_SUB3 (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (alu);
           setNFlag32 (alu);
-          setCFlag (CarrySUB32 (@a, lb, lc));
-          setVFlag (OverflowSUB32 (@a, lb, lc));
+          setCVFlagsSUB32 (@a, lb, lc);
         };
     };
 }
@@ -1447,10 +1307,6 @@ arc_gen_MAX (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv alu = tcg_temp_local_new();
   TCGv temp_3 = tcg_temp_local_new();
   TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_11 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
   getCCFlag(temp_5);
   tcg_gen_mov_tl(cc_flag, temp_5);
   se32to64(temp_6, b);
@@ -1477,12 +1333,7 @@ arc_gen_MAX (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(alu);
   setNFlag32(alu);
-  CarrySUB32(temp_9, a, lb, lc);
-  tcg_gen_mov_tl(temp_8, temp_9);
-  setCFlag(temp_8);
-  OverflowSUB32(temp_11, a, lb, lc);
-  tcg_gen_mov_tl(temp_10, temp_11);
-  setVFlag(temp_10);
+  setCVFlagsSUB32(a, lb, lc);
 ;
     }
   else
@@ -1501,10 +1352,6 @@ arc_gen_MAX (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(alu);
   tcg_temp_free(temp_3);
   tcg_temp_free(temp_4);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_11);
-  tcg_temp_free(temp_10);
 
   return ret;
 }
@@ -1537,8 +1384,7 @@ arc_gen_MAX (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (alu);
           setNFlag32 (alu);
-          setCFlag (CarrySUB32 (@a, lb, lc));
-          setVFlag (OverflowSUB32 (@a, lb, lc));
+          setCVFlagsSUB32 (@a, lb, lc);
         };
     };
 }
@@ -1559,10 +1405,6 @@ arc_gen_MIN (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv alu = tcg_temp_local_new();
   TCGv temp_3 = tcg_temp_local_new();
   TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_11 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
   getCCFlag(temp_5);
   tcg_gen_mov_tl(cc_flag, temp_5);
   se32to64(temp_6, b);
@@ -1589,12 +1431,7 @@ arc_gen_MIN (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(alu);
   setNFlag32(alu);
-  CarrySUB32(temp_9, a, lb, lc);
-  tcg_gen_mov_tl(temp_8, temp_9);
-  setCFlag(temp_8);
-  OverflowSUB32(temp_11, a, lb, lc);
-  tcg_gen_mov_tl(temp_10, temp_11);
-  setVFlag(temp_10);
+  setCVFlagsSUB32(a, lb, lc);
 ;
     }
   else
@@ -1613,10 +1450,6 @@ arc_gen_MIN (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(alu);
   tcg_temp_free(temp_3);
   tcg_temp_free(temp_4);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_11);
-  tcg_temp_free(temp_10);
 
   return ret;
 }
@@ -1640,8 +1473,7 @@ arc_gen_MIN (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
       alu = (alu & 4294967295);
       setZFlag (alu);
       setNFlag32 (alu);
-      setCFlag (CarrySUB32 (alu, lb, lc));
-      setVFlag (OverflowSUB32 (alu, lb, lc));
+      setCVFlagsSUB32 (alu, lb, lc);
     };
 }
  */
@@ -1658,10 +1490,6 @@ arc_gen_CMP (DisasCtxt *ctx, TCGv b, TCGv c)
   TCGv lb = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
   TCGv alu = tcg_temp_local_new();
-  TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   TCGLabel *done_1 = gen_new_label();
@@ -1675,12 +1503,7 @@ arc_gen_CMP (DisasCtxt *ctx, TCGv b, TCGv c)
   tcg_gen_andi_tl(alu, alu, 4294967295);
   setZFlag(alu);
   setNFlag32(alu);
-  CarrySUB32(temp_5, alu, lb, lc);
-  tcg_gen_mov_tl(temp_4, temp_5);
-  setCFlag(temp_4);
-  OverflowSUB32(temp_7, alu, lb, lc);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setVFlag(temp_6);
+  setCVFlagsSUB32(alu, lb, lc);
   gen_set_label(done_1);
   tcg_temp_free(temp_3);
   tcg_temp_free(cc_flag);
@@ -1690,10 +1513,6 @@ arc_gen_CMP (DisasCtxt *ctx, TCGv b, TCGv c)
   tcg_temp_free(lb);
   tcg_temp_free(lc);
   tcg_temp_free(alu);
-  tcg_temp_free(temp_5);
-  tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
 
   return ret;
 }
@@ -5359,6 +5178,7 @@ arc_gen_MAC(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
 
         setNFlag(cpu64_acc);
 
+        arc_gen_compute_cv(ctx);
         tcg_gen_mov_tl(vf_temp, cpu_Vf);
         OverflowADD(cpu_Vf, cpu64_acc, old_acc, mul_bc);        
         tcg_gen_brcondi_tl(TCG_COND_EQ, vf_temp, 0, vf_done);
@@ -5405,6 +5225,7 @@ arc_gen_MACU(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         TCGLabel *vf_done = gen_new_label();
         TCGv vf_temp = tcg_temp_new();
 
+        arc_gen_compute_cv(ctx);
         tcg_gen_mov_tl(vf_temp, cpu_Vf);
         CarryADD(cpu_Vf, cpu64_acc, old_acc, mul_bc);
         tcg_gen_brcondi_tl(TCG_COND_EQ, vf_temp, 0, vf_done);
@@ -5453,6 +5274,7 @@ arc_gen_MACD(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
 
         setNFlag(cpu64_acc);
 
+        arc_gen_compute_cv(ctx);
         tcg_gen_mov_tl(vf_temp, cpu_Vf);
         OverflowADD(cpu_Vf, cpu64_acc, old_acc, mul_bc);        
         tcg_gen_brcondi_tl(TCG_COND_EQ, vf_temp, 0, vf_done);
@@ -5499,6 +5321,7 @@ arc_gen_MACDU(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         TCGLabel *vf_done = gen_new_label();
         TCGv vf_temp = tcg_temp_new();
 
+        arc_gen_compute_cv(ctx);
         tcg_gen_mov_tl(vf_temp, cpu_Vf);
         CarryADD(cpu_Vf, cpu64_acc, old_acc, mul_bc);
         tcg_gen_brcondi_tl(TCG_COND_EQ, vf_temp, 0, vf_done);
@@ -7908,11 +7731,6 @@ arc_gen_EX (DisasCtxt *ctx, TCGv b, TCGv c)
 }
 
 
-#undef ARM_LIKE_LLOCK_SCOND
-
-extern TCGv cpu_exclusive_addr;
-extern TCGv cpu_exclusive_val;
-
 /*
  * LLOCK -- CODED BY HAND
  */
@@ -7921,13 +7739,8 @@ int
 arc_gen_LLOCK(DisasCtxt *ctx, TCGv dest, TCGv src)
 {
     int ret = DISAS_NEXT;
-#ifndef ARM_LIKE_LLOCK_SCOND
-    gen_helper_llock(dest, cpu_env, src);
-#else
-    tcg_gen_qemu_ld_tl(cpu_exclusive_val, src, ctx->mem_idx, MO_UL);
-    tcg_gen_mov_tl(dest, cpu_exclusive_val);
-    tcg_gen_mov_tl(cpu_exclusive_addr, src);
-#endif
+
+    arc_gen_llock(ctx, dest, src, MO_UL);
 
     return ret;
 }
@@ -7940,13 +7753,8 @@ int
 arc_gen_LLOCKL(DisasCtxt *ctx, TCGv dest, TCGv src)
 {
     int ret = DISAS_NEXT;
-#ifndef ARM_LIKE_LLOCK_SCOND
-    gen_helper_llockl(dest, cpu_env, src);
-#else
-    tcg_gen_qemu_ld_tl(cpu_exclusive_val, src, ctx->mem_idx, MO_UQ);
-    tcg_gen_mov_tl(dest, cpu_exclusive_val);
-    tcg_gen_mov_tl(cpu_exclusive_addr, src);
-#endif
+
+    arc_gen_llock(ctx, dest, src, MO_UQ);
 
     return ret;
 }
@@ -7960,34 +7768,8 @@ int
 arc_gen_SCOND(DisasCtxt *ctx, TCGv addr, TCGv value)
 {
     int ret = DISAS_NEXT;
-#ifndef ARM_LIKE_LLOCK_SCOND
-    TCGv temp_4 = tcg_temp_local_new();
-    gen_helper_scond(temp_4, cpu_env, addr, value);
-    setZFlag(temp_4);
-    tcg_temp_free(temp_4);
-#else
-    TCGLabel *fail_label = gen_new_label();
-    TCGLabel *done_label = gen_new_label();
-    TCGv tmp;
-
-    tcg_gen_brcond_tl(TCG_COND_NE, addr, cpu_exclusive_addr, fail_label);
-    tmp = tcg_temp_new();
-
-    tcg_gen_atomic_cmpxchg_tl(tmp, cpu_exclusive_addr, cpu_exclusive_val,
-                               value, ctx->mem_idx,
-                               MO_UL | MO_ALIGN);
-    tcg_gen_setcond_tl(TCG_COND_NE, tmp, tmp, cpu_exclusive_val);
-
-    setZFlag(tmp);
 
-    tcg_temp_free(tmp);
-    tcg_gen_br(done_label);
-
-    gen_set_label(fail_label);
-    tcg_gen_movi_tl(cpu_Zf, 1);
-    gen_set_label(done_label);
-    tcg_gen_movi_tl(cpu_exclusive_addr, -1);
-#endif
+    arc_gen_scond(ctx, addr, value, MO_UL);
 
     return ret;
 }
@@ -8001,34 +7783,8 @@ int
 arc_gen_SCONDL(DisasCtxt *ctx, TCGv addr, TCGv value)
 {
     int ret = DISAS_NEXT;
-#ifndef ARM_LIKE_LLOCK_SCOND
-    TCGv temp_4 = tcg_temp_local_new();
-    gen_helper_scondl(temp_4, cpu_env, addr, value);
-    setZFlag(temp_4);
-    tcg_temp_free(temp_4);
-#else
-    TCGLabel *fail_label = gen_new_label();
-    TCGLabel *done_label = gen_new_label();
-    TCGv tmp;
-
-    tcg_gen_brcond_tl(TCG_COND_NE, addr, cpu_exclusive_addr, fail_label);
-    tmp = tcg_temp_new();
 
-    tcg_gen_atomic_cmpxchg_tl(tmp, cpu_exclusive_addr, cpu_exclusive_val,
-                               value, ctx->mem_idx,
-                               MO_Q | MO_ALIGN);
-    tcg_gen_setcond_tl(TCG_COND_NE, tmp, tmp, cpu_exclusive_val);
-
-    setZFlag(tmp);
-
-    tcg_temp_free(tmp);
-    tcg_gen_br(done_label);
-
-    gen_set_label(fail_label);
-    tcg_gen_movi_tl(cpu_Zf, 1);
-    gen_set_label(done_label);
-    tcg_gen_movi_tl(cpu_exclusive_addr, -1);
-#endif
+    arc_gen_scond(ctx, addr, value, MO_UQ);
 
     return ret;
 }
@@ -8922,8 +8678,7 @@ arc_gen_FFS(DisasCtxt *ctx, TCGv src, TCGv dest)
         {
           setZFlag (@a);
           setNFlag (@a);
-          setCFlag (CarryADD (@a, lb, lc));
-          setVFlag (OverflowADD (@a, lb, lc));
+          setCVFlagsADD (@a, lb, lc);
         };
     };
 }
@@ -8939,10 +8694,6 @@ arc_gen_ADDL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv lc = tcg_temp_local_new();
   TCGv temp_1 = tcg_temp_local_new();
   TCGv temp_2 = tcg_temp_local_new();
-  TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   tcg_gen_mov_tl(lb, b);
@@ -8958,12 +8709,7 @@ arc_gen_ADDL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag(a);
-  CarryADD(temp_5, a, lb, lc);
-  tcg_gen_mov_tl(temp_4, temp_5);
-  setCFlag(temp_4);
-  OverflowADD(temp_7, a, lb, lc);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setVFlag(temp_6);
+  setCVFlagsADD(a, lb, lc);
 ;
     }
   else
@@ -8977,10 +8723,6 @@ arc_gen_ADDL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(lc);
   tcg_temp_free(temp_1);
   tcg_temp_free(temp_2);
-  tcg_temp_free(temp_5);
-  tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
 
   return ret;
 }
@@ -9005,8 +8747,7 @@ arc_gen_ADDL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarryADD (@a, lb, lc));
- *           setVFlag (OverflowADD (@a, lb, lc));
+ *           setCVFlagsADD (@a, lb, lc);
  *         };
  *     };
  * }
@@ -9022,10 +8763,6 @@ arc_gen_ADD1L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv lc = tcg_temp_local_new();
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -9039,12 +8776,7 @@ arc_gen_ADD1L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarryADD(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowADD(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsADD(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -9053,10 +8785,6 @@ arc_gen_ADD1L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(lc);
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -9077,8 +8805,7 @@ arc_gen_ADD1L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarryADD (@a, lb, lc));
- *           setVFlag (OverflowADD (@a, lb, lc));
+ *           setCVFlagsADD (@a, lb, lc);
  *         };
  *     };
  * }
@@ -9094,10 +8821,6 @@ arc_gen_ADD2L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv lc = tcg_temp_local_new();
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -9111,12 +8834,7 @@ arc_gen_ADD2L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarryADD(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowADD(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsADD(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -9125,10 +8843,6 @@ arc_gen_ADD2L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(lc);
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -9153,8 +8867,7 @@ arc_gen_ADD2L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
  *         {
  *           setZFlag (@a);
  *           setNFlag (@a);
- *           setCFlag (CarryADD (@a, lb, lc));
- *           setVFlag (OverflowADD (@a, lb, lc));
+ *           setCVFlagsADD (@a, lb, lc);
  *         };
  *     };
  * }
@@ -9170,10 +8883,6 @@ arc_gen_ADD3L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     TCGv lc = tcg_temp_local_new();
     TCGv temp_1 = tcg_temp_local_new();
     TCGv temp_2 = tcg_temp_local_new();
-    TCGv temp_5 = tcg_temp_local_new();
-    TCGv temp_4 = tcg_temp_local_new();
-    TCGv temp_7 = tcg_temp_local_new();
-    TCGv temp_6 = tcg_temp_local_new();
     getCCFlag(temp_3);
     tcg_gen_mov_tl(cc_flag, temp_3);
     tcg_gen_mov_tl(lb, b);
@@ -9187,12 +8896,7 @@ arc_gen_ADD3L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     if ((getFFlag () == true)) {
         setZFlag(a);
         setNFlag(a);
-        CarryADD(temp_5, a, lb, lc);
-        tcg_gen_mov_tl(temp_4, temp_5);
-        setCFlag(temp_4);
-        OverflowADD(temp_7, a, lb, lc);
-        tcg_gen_mov_tl(temp_6, temp_7);
-        setVFlag(temp_6);
+        setCVFlagsADD(a, lb, lc);
     }
     gen_set_label(done_1);
     tcg_temp_free(temp_3);
@@ -9201,10 +8905,6 @@ arc_gen_ADD3L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     tcg_temp_free(lc);
     tcg_temp_free(temp_1);
     tcg_temp_free(temp_2);
-    tcg_temp_free(temp_5);
-    tcg_temp_free(temp_4);
-    tcg_temp_free(temp_7);
-    tcg_temp_free(temp_6);
 
     return ret;
 }
@@ -9231,8 +8931,7 @@ arc_gen_ADD3L(DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag (@a);
-          setCFlag (CarryADD (@a, lb, lc));
-          setVFlag (OverflowADD (@a, lb, lc));
+          setCVFlagsADD (@a, lb, lc);
         };
     };
 }
@@ -9251,10 +8950,6 @@ arc_gen_ADCL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_4 = tcg_temp_local_new();
   TCGv temp_6 = tcg_temp_local_new();
   TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   tcg_gen_mov_tl(lb, b);
@@ -9273,12 +8968,7 @@ arc_gen_ADCL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag(a);
-  CarryADD(temp_8, a, lb, lc);
-  tcg_gen_mov_tl(temp_7, temp_8);
-  setCFlag(temp_7);
-  OverflowADD(temp_10, a, lb, lc);
-  tcg_gen_mov_tl(temp_9, temp_10);
-  setVFlag(temp_9);
+  setCVFlagsADD(a, lb, lc);
 ;
     }
   else
@@ -9295,10 +8985,6 @@ arc_gen_ADCL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_4);
   tcg_temp_free(temp_6);
   tcg_temp_free(temp_5);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_10);
-  tcg_temp_free(temp_9);
 
   return ret;
 }
@@ -9324,8 +9010,7 @@ arc_gen_ADCL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag (@a);
-          setCFlag (CarrySUB (@a, lb, lc));
-          setVFlag (OverflowSUB (@a, lb, lc));
+          setCVFlagsSUB (@a, lb, lc);
         };
     };
 }
@@ -9344,10 +9029,6 @@ arc_gen_SBCL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_4 = tcg_temp_local_new();
   TCGv temp_6 = tcg_temp_local_new();
   TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_10 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   tcg_gen_mov_tl(lb, b);
@@ -9366,12 +9047,7 @@ arc_gen_SBCL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag(a);
-  CarrySUB(temp_8, a, lb, lc);
-  tcg_gen_mov_tl(temp_7, temp_8);
-  setCFlag(temp_7);
-  OverflowSUB(temp_10, a, lb, lc);
-  tcg_gen_mov_tl(temp_9, temp_10);
-  setVFlag(temp_9);
+  setCVFlagsSUB(a, lb, lc);
 ;
     }
   else
@@ -9388,10 +9064,6 @@ arc_gen_SBCL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_4);
   tcg_temp_free(temp_6);
   tcg_temp_free(temp_5);
-  tcg_temp_free(temp_8);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_10);
-  tcg_temp_free(temp_9);
 
   return ret;
 }
@@ -9416,8 +9088,7 @@ arc_gen_SBCL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag (@a);
-          setCFlag (CarrySUB (@a, lb, lc));
-          setVFlag (OverflowSUB (@a, lb, lc));
+          setCVFlagsSUB (@a, lb, lc);
         };
     };
 }
@@ -9433,10 +9104,6 @@ arc_gen_SUBL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_1 = tcg_temp_local_new();
   TCGv temp_2 = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
-  TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   tcg_gen_mov_tl(lb, b);
@@ -9451,12 +9118,7 @@ arc_gen_SUBL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag(a);
-  CarrySUB(temp_5, a, lb, lc);
-  tcg_gen_mov_tl(temp_4, temp_5);
-  setCFlag(temp_4);
-  OverflowSUB(temp_7, a, lb, lc);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setVFlag(temp_6);
+  setCVFlagsSUB(a, lb, lc);
 ;
     }
   else
@@ -9470,10 +9132,6 @@ arc_gen_SUBL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_1);
   tcg_temp_free(temp_2);
   tcg_temp_free(lc);
-  tcg_temp_free(temp_5);
-  tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
 
   return ret;
 }
@@ -9498,8 +9156,7 @@ arc_gen_SUBL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag (@a);
-          setCFlag (CarrySUB (@a, lb, lc));
-          setVFlag (OverflowSUB (@a, lb, lc));
+          setCVFlagsSUB (@a, lb, lc);
         };
     };
 }
@@ -9515,10 +9172,6 @@ arc_gen_SUB1L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_1 = tcg_temp_local_new();
   TCGv temp_2 = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
-  TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   tcg_gen_mov_tl(lb, b);
@@ -9533,12 +9186,7 @@ arc_gen_SUB1L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag(a);
-  CarrySUB(temp_5, a, lb, lc);
-  tcg_gen_mov_tl(temp_4, temp_5);
-  setCFlag(temp_4);
-  OverflowSUB(temp_7, a, lb, lc);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setVFlag(temp_6);
+  setCVFlagsSUB(a, lb, lc);
 ;
     }
   else
@@ -9552,10 +9200,6 @@ arc_gen_SUB1L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_1);
   tcg_temp_free(temp_2);
   tcg_temp_free(lc);
-  tcg_temp_free(temp_5);
-  tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
 
   return ret;
 }
@@ -9580,8 +9224,7 @@ arc_gen_SUB1L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag (@a);
-          setCFlag (CarrySUB (@a, lb, lc));
-          setVFlag (OverflowSUB (@a, lb, lc));
+          setCVFlagsSUB (@a, lb, lc);
         };
     };
 }
@@ -9597,10 +9240,6 @@ arc_gen_SUB2L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_1 = tcg_temp_local_new();
   TCGv temp_2 = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
-  TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   tcg_gen_mov_tl(lb, b);
@@ -9615,12 +9254,7 @@ arc_gen_SUB2L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag(a);
-  CarrySUB(temp_5, a, lb, lc);
-  tcg_gen_mov_tl(temp_4, temp_5);
-  setCFlag(temp_4);
-  OverflowSUB(temp_7, a, lb, lc);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setVFlag(temp_6);
+  setCVFlagsSUB(a, lb, lc);
 ;
     }
   else
@@ -9634,10 +9268,6 @@ arc_gen_SUB2L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_1);
   tcg_temp_free(temp_2);
   tcg_temp_free(lc);
-  tcg_temp_free(temp_5);
-  tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
 
   return ret;
 }
@@ -9662,8 +9292,7 @@ arc_gen_SUB2L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (@a);
           setNFlag (@a);
-          setCFlag (CarrySUB (@a, lb, lc));
-          setVFlag (OverflowSUB (@a, lb, lc));
+          setCVFlagsSUB (@a, lb, lc);
         };
     };
 }
@@ -9679,10 +9308,6 @@ arc_gen_SUB3L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv temp_1 = tcg_temp_local_new();
   TCGv temp_2 = tcg_temp_local_new();
   TCGv lc = tcg_temp_local_new();
-  TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   tcg_gen_mov_tl(lb, b);
@@ -9697,12 +9322,7 @@ arc_gen_SUB3L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(a);
   setNFlag(a);
-  CarrySUB(temp_5, a, lb, lc);
-  tcg_gen_mov_tl(temp_4, temp_5);
-  setCFlag(temp_4);
-  OverflowSUB(temp_7, a, lb, lc);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setVFlag(temp_6);
+  setCVFlagsSUB(a, lb, lc);
 ;
     }
   else
@@ -9716,10 +9336,6 @@ arc_gen_SUB3L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(temp_1);
   tcg_temp_free(temp_2);
   tcg_temp_free(lc);
-  tcg_temp_free(temp_5);
-  tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
 
   return ret;
 }
@@ -9752,8 +9368,7 @@ arc_gen_SUB3L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (alu);
           setNFlag (alu);
-          setCFlag (CarrySUB (@a, lb, lc));
-          setVFlag (OverflowSUB (@a, lb, lc));
+          setCVFlagsSUB (@a, lb, lc);
         };
     };
 }
@@ -9772,10 +9387,6 @@ arc_gen_MAXL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv alu = tcg_temp_local_new();
   TCGv temp_3 = tcg_temp_local_new();
   TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
   getCCFlag(temp_5);
   tcg_gen_mov_tl(cc_flag, temp_5);
   tcg_gen_mov_tl(lb, b);
@@ -9800,12 +9411,7 @@ arc_gen_MAXL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(alu);
   setNFlag(alu);
-  CarrySUB(temp_7, a, lb, lc);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setCFlag(temp_6);
-  OverflowSUB(temp_9, a, lb, lc);
-  tcg_gen_mov_tl(temp_8, temp_9);
-  setVFlag(temp_8);
+  setCVFlagsSUB(a, lb, lc);
 ;
     }
   else
@@ -9822,10 +9428,6 @@ arc_gen_MAXL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(alu);
   tcg_temp_free(temp_3);
   tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_8);
 
   return ret;
 }
@@ -9858,8 +9460,7 @@ arc_gen_MAXL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
         {
           setZFlag (alu);
           setNFlag (alu);
-          setCFlag (CarrySUB (@a, lb, lc));
-          setVFlag (OverflowSUB (@a, lb, lc));
+          setCVFlagsSUB (@a, lb, lc);
         };
     };
 }
@@ -9878,10 +9479,6 @@ arc_gen_MINL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   TCGv alu = tcg_temp_local_new();
   TCGv temp_3 = tcg_temp_local_new();
   TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
-  TCGv temp_9 = tcg_temp_local_new();
-  TCGv temp_8 = tcg_temp_local_new();
   getCCFlag(temp_5);
   tcg_gen_mov_tl(cc_flag, temp_5);
   tcg_gen_mov_tl(lb, b);
@@ -9906,12 +9503,7 @@ arc_gen_MINL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
     {
     setZFlag(alu);
   setNFlag(alu);
-  CarrySUB(temp_7, a, lb, lc);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setCFlag(temp_6);
-  OverflowSUB(temp_9, a, lb, lc);
-  tcg_gen_mov_tl(temp_8, temp_9);
-  setVFlag(temp_8);
+  setCVFlagsSUB(a, lb, lc);
 ;
     }
   else
@@ -9928,10 +9520,6 @@ arc_gen_MINL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
   tcg_temp_free(alu);
   tcg_temp_free(temp_3);
   tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
-  tcg_temp_free(temp_9);
-  tcg_temp_free(temp_8);
 
   return ret;
 }
@@ -9951,8 +9539,7 @@ arc_gen_MINL (DisasCtxt *ctx, TCGv b, TCGv c, TCGv a)
       alu = (@b - @c);
       setZFlag (alu);
       setNFlag (alu);
-      setCFlag (CarrySUB (alu, @b, @c));
-      setVFlag (OverflowSUB (alu, @b, @c));
+      setCVFlagsSUB (alu, @b, @c);
     };
 }
  */
@@ -9966,10 +9553,6 @@ arc_gen_CMPL (DisasCtxt *ctx, TCGv b, TCGv c)
   TCGv temp_1 = tcg_temp_local_new();
   TCGv temp_2 = tcg_temp_local_new();
   TCGv alu = tcg_temp_local_new();
-  TCGv temp_5 = tcg_temp_local_new();
-  TCGv temp_4 = tcg_temp_local_new();
-  TCGv temp_7 = tcg_temp_local_new();
-  TCGv temp_6 = tcg_temp_local_new();
   getCCFlag(temp_3);
   tcg_gen_mov_tl(cc_flag, temp_3);
   TCGLabel *done_1 = gen_new_label();
@@ -9979,22 +9562,13 @@ arc_gen_CMPL (DisasCtxt *ctx, TCGv b, TCGv c)
   tcg_gen_sub_tl(alu, b, c);
   setZFlag(alu);
   setNFlag(alu);
-  CarrySUB(temp_5, alu, b, c);
-  tcg_gen_mov_tl(temp_4, temp_5);
-  setCFlag(temp_4);
-  OverflowSUB(temp_7, alu, b, c);
-  tcg_gen_mov_tl(temp_6, temp_7);
-  setVFlag(temp_6);
+  setCVFlagsSUB(alu, b, c);
   gen_set_label(done_1);
   tcg_temp_free(temp_3);
   tcg_temp_free(cc_flag);
   tcg_temp_free(temp_1);
   tcg_temp_free(temp_2);
   tcg_temp_free(alu);
-  tcg_temp_free(temp_5);
-  tcg_temp_free(temp_4);
-  tcg_temp_free(temp_7);
-  tcg_temp_free(temp_6);
 
   return ret;
 }
@@ -14154,13 +13728,28 @@ arc_gen_BBIT1L (DisasCtxt *ctx, TCGv b, TCGv c, TCGv rd)
   return ret;
 }
 
+/*
+ * Gather the halfwords of @src selected by @shift (0 for h0/h2, 16 for
+ * h1/h3) into the low word of @dest, in-register.
+ */
+static void
+arc_gen_vpack4h_half(TCGv dest, TCGv src, unsigned int shift)
+{
+  TCGv t = tcg_temp_new();
+
+  tcg_gen_shri_tl(dest, src, shift);
+  tcg_gen_andi_tl(dest, dest, 0x0000ffff0000ffffull);
+  tcg_gen_shri_tl(t, dest, 16);
+  tcg_gen_or_tl(dest, dest, t);
+
+  tcg_temp_free(t);
+}
+
 int
 arc_gen_VPACK4HL(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 {
-  TCGv b_h0 = tcg_temp_new();
-  TCGv b_h2 = tcg_temp_new();
-  TCGv c_h0 = tcg_temp_new();
-  TCGv c_h2 = tcg_temp_new();
+  TCGv b_h = tcg_temp_new();
+  TCGv c_h = tcg_temp_new();
 
   TCGv cc_temp = tcg_temp_local_new();
   TCGLabel *cc_done = gen_new_label();
@@ -14171,24 +13760,16 @@ arc_gen_VPACK4HL(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 
   /* Instruction code */
 
-  tcg_gen_sextract_tl(b_h0, b, 0, 16);
-  tcg_gen_sextract_tl(b_h2, b, 32, 16);
-  tcg_gen_sextract_tl(c_h0, c, 0, 16);
-  tcg_gen_sextract_tl(c_h2, c, 32, 16);
-
-  tcg_gen_mov_tl(a, b_h0);
-  tcg_gen_deposit_tl(a, a, b_h2, 16, 16);
-  tcg_gen_deposit_tl(a, a, c_h0, 32, 16);
-  tcg_gen_deposit_tl(a, a, c_h2, 48, 16);
+  arc_gen_vpack4h_half(b_h, b, 0);         /* b_h.w0 = {b.h2, b.h0} */
+  arc_gen_vpack4h_half(c_h, c, 0);         /* c_h.w0 = {c.h2, c.h0} */
+  tcg_gen_deposit_tl(a, b_h, c_h, 32, 32);
 
   /* Conditional execution end. */
   gen_set_label(cc_done);
   tcg_temp_free(cc_temp);
 
-  tcg_temp_free(b_h0);
-  tcg_temp_free(b_h2);
-  tcg_temp_free(c_h0);
-  tcg_temp_free(c_h2);
+  tcg_temp_free(b_h);
+  tcg_temp_free(c_h);
     
   return DISAS_NEXT;
 }
@@ -14196,10 +13777,8 @@ arc_gen_VPACK4HL(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 int
 arc_gen_VPACK4HM(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 {
-  TCGv b_h1 = tcg_temp_new();
-  TCGv b_h3 = tcg_temp_new();
-  TCGv c_h1 = tcg_temp_new();
-  TCGv c_h3 = tcg_temp_new();
+  TCGv b_h = tcg_temp_new();
+  TCGv c_h = tcg_temp_new();
 
   TCGv cc_temp = tcg_temp_local_new();
   TCGLabel *cc_done = gen_new_label();
@@ -14210,24 +13789,16 @@ arc_gen_VPACK4HM(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 
   /* Instruction code */
 
-  tcg_gen_sextract_tl(b_h1, b, 16, 16);
-  tcg_gen_sextract_tl(b_h3, b, 48, 16);
-  tcg_gen_sextract_tl(c_h1, c, 16, 16);
-  tcg_gen_sextract_tl(c_h3, c, 48, 16);
-
-  tcg_gen_mov_tl(a, b_h1);
-  tcg_gen_deposit_tl(a, a, b_h3, 16, 16);
-  tcg_gen_deposit_tl(a, a, c_h1, 32, 16);
-  tcg_gen_deposit_tl(a, a, c_h3, 48, 16);
+  arc_gen_vpack4h_half(b_h, b, 16);        /* b_h.w0 = {b.h3, b.h1} */
+  arc_gen_vpack4h_half(c_h, c, 16);        /* c_h.w0 = {c.h3, c.h1} */
+  tcg_gen_deposit_tl(a, b_h, c_h, 32, 32);
 
   /* Conditional execution end. */
   gen_set_label(cc_done);
   tcg_temp_free(cc_temp);
 
-  tcg_temp_free(b_h1);
-  tcg_temp_free(b_h3);
-  tcg_temp_free(c_h1);
-  tcg_temp_free(c_h3);
+  tcg_temp_free(b_h);
+  tcg_temp_free(c_h);
     
   return DISAS_NEXT;
 }
@@ -14235,9 +13806,6 @@ arc_gen_VPACK4HM(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 int
 arc_gen_VPACK2WL(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 {
-  TCGv b_w0 = tcg_temp_new();
-  TCGv c_w0 = tcg_temp_new();
-  
   TCGv cc_temp = tcg_temp_local_new();
   TCGLabel *cc_done = gen_new_label();
 
@@ -14247,18 +13815,11 @@ arc_gen_VPACK2WL(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 
   /* Instruction code */
 
-  tcg_gen_sextract_tl(b_w0, b, 0, 32);
-  tcg_gen_sextract_tl(c_w0, c, 0, 32);
-
-  tcg_gen_mov_tl(a, b_w0);
-  tcg_gen_deposit_tl(a, a, c_w0, 32, 32);
+  tcg_gen_deposit_tl(a, b, c, 32, 32);     /* a = {c.w0, b.w0} */
 
   /* Conditional execution end. */
   gen_set_label(cc_done);
   tcg_temp_free(cc_temp);
-
-  tcg_temp_free(b_w0);
-  tcg_temp_free(c_w0);
     
   return DISAS_NEXT;
 }
@@ -14278,11 +13839,9 @@ arc_gen_VPACK2WM(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 
   /* Instruction code */
 
-  tcg_gen_sextract_tl(b_w1, b, 32, 32);
-  tcg_gen_sextract_tl(c_w1, c, 32, 32);
-
-  tcg_gen_mov_tl(a, b_w1);
-  tcg_gen_deposit_tl(a, a, c_w1, 32, 32);
+  tcg_gen_shri_tl(b_w1, b, 32);
+  tcg_gen_andi_tl(c_w1, c, 0xffffffff00000000ull);
+  tcg_gen_or_tl(a, b_w1, c_w1);            /* a = {c.w1, b.w1} */
 
   /* Conditional execution end. */
   gen_set_label(cc_done);
@@ -14345,18 +13904,15 @@ arc_gen_vmac2_op(DisasCtxt *ctx, TCGv dest, TCGv b, TCGv c,
 
   OP(t1, b, 0, 16);                           /* t1 = b.h0 */
   OP(t2, c, 0, 16);                           /* t2 = c.h0 */
-  tcg_gen_mul_tl(t3, t1, t2);                 /* t3 = b.h0 * c.h0 */ 
-  tcg_gen_extract_tl(t2, cpu64_acc, 0, 32);   /* t2 = acclo */
-  tcg_gen_add_tl(t3, t3, t2);                 /* t3 = (b.h0 * c.h0) + acclo */
+  tcg_gen_mul_tl(t3, t1, t2);                 /* t3 = b.h0 * c.h0 */
 
   OP(t1, b, 16, 16);                          /* t1 = b.h1 */
   OP(t2, c, 16, 16);                          /* t2 = c.h1 */
   tcg_gen_mul_tl(t4, t1, t2);                 /* t4 = b.h1 * c.h1 */
-  tcg_gen_extract_tl(t2, cpu64_acc, 32, 32);  /* t2 = acchi */
-  tcg_gen_add_tl(t4, t4, t2);                 /* t4 = (b.h1 * c.h1) + acchi */
 
-  tcg_gen_deposit_tl(dest, dest, t3, 0, 32);  /* dest.w0 = (b.h0 * c.h0) + acclo */
-  tcg_gen_deposit_tl(dest, dest, t4, 32, 32); /* dest.w1 = (b.h1 * c.h1) + acchi */
+  /* Both word lanes are accumulated with a single in-register add. */
+  tcg_gen_deposit_tl(t3, t3, t4, 32, 32);     /* t3 = {b.h1 * c.h1, b.h0 * c.h0} */
+  tcg_gen_vec_add32_i64(dest, t3, cpu64_acc); /* dest.wN = t3.wN + acc.wN */
   tcg_gen_mov_tl(cpu64_acc, dest);            /* acc = dest */
 
   tcg_temp_free(t1);
@@ -14384,20 +13940,16 @@ arc_gen_##INSN(DisasCtxt *ctx, TCGv dest, TCGv b, TCGv c)   \
 ARC_GEN_VEC_MAC2H(VMAC2H, tcg_gen_sextract_tl, 16bit)
 ARC_GEN_VEC_MAC2H(VMAC2HU, tcg_gen_extract_tl, 16bit)
 
-#define ARC_GEN_VEC_ADD_SUB(INSN, FIELD, OP, FIELD_SIZE)      \
+#define ARC_GEN_VEC_ADD_SUB(INSN, LANES, OP, FIELD_SIZE)      \
 int                                                           \
 arc_gen_##INSN(DisasCtxt *ctx, TCGv dest, TCGv b, TCGv c)     \
 {                                                             \
-    TCGv t1;                                                  \
     ARC_GEN_SEMFUNC_INIT();                                   \
                                                               \
     ARC_GEN_VEC_FIRST_OPERAND(operand_##FIELD_SIZE, b);       \
     ARC_GEN_VEC_SECOND_OPERAND(operand_##FIELD_SIZE, c);      \
                                                               \
-    t1 = tcg_temp_new();                                      \
-    ARC_GEN_CMPL2_##FIELD##_I64(t1, c);                       \
-    OP(dest, b, t1);                                          \
-    tcg_temp_free(t1);                                        \
+    OP(dest, b, c, ARC_VEC_LANES_##LANES);                    \
                                                               \
     ARC_GEN_SEMFUNC_DEINIT();                                 \
                                                               \
@@ -14405,12 +13957,12 @@ arc_gen_##INSN(DisasCtxt *ctx, TCGv dest, TCGv b, TCGv c)     \
 }
 
 
-ARC_GEN_VEC_ADD_SUB(VADDSUB, W1, tcg_gen_vec_add32_i64,      32bit)
-ARC_GEN_VEC_ADD_SUB(VADDSUB2H, H1, arc_gen_vec_add16_w0_i64, 16bit)
-ARC_GEN_VEC_ADD_SUB(VADDSUB4H, H1_H3, tcg_gen_vec_add16_i64, 16bit)
-ARC_GEN_VEC_ADD_SUB(VSUBADD, W0, tcg_gen_vec_add32_i64,      32bit)
-ARC_GEN_VEC_ADD_SUB(VSUBADD2H, H0, arc_gen_vec_add16_w0_i64, 16bit)
-ARC_GEN_VEC_ADD_SUB(VSUBADD4H, H0_H2, tcg_gen_vec_add16_i64, 16bit)
+ARC_GEN_VEC_ADD_SUB(VADDSUB, W1, arc_gen_vec_addsub32_i64,      32bit)
+ARC_GEN_VEC_ADD_SUB(VADDSUB2H, H1, arc_gen_vec_addsub16_w0_i64, 16bit)
+ARC_GEN_VEC_ADD_SUB(VADDSUB4H, H1_H3, arc_gen_vec_addsub16_i64, 16bit)
+ARC_GEN_VEC_ADD_SUB(VSUBADD, W0, arc_gen_vec_addsub32_i64,      32bit)
+ARC_GEN_VEC_ADD_SUB(VSUBADD2H, H0, arc_gen_vec_addsub16_w0_i64, 16bit)
+ARC_GEN_VEC_ADD_SUB(VSUBADD4H, H0_H2, arc_gen_vec_addsub16_i64, 16bit)
 
 int
 arc_gen_QMACH(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
@@ -36,22 +36,72 @@ arc_gen_vec_add16_w0_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b)
     tcg_temp_free_i64(t1);
 }
 
-void
-arc_gen_cmpl2_i64(TCGv_i64 ret, TCGv_i64 arg1,
-                  unsigned int ofs, unsigned int len)
+/*
+ * Mixed lane-wise add/subtract without splitting the vector: both the sum
+ * and the difference are computed in-register and the lanes selected by
+ * SUB_MASK are taken from the difference.
+ */
+static void
+arc_gen_vec_addsub_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b, uint64_t sub_mask,
+                       void (*add)(TCGv_i64, TCGv_i64, TCGv_i64),
+                       void (*sub)(TCGv_i64, TCGv_i64, TCGv_i64))
 {
     TCGv_i64 t1 = tcg_temp_new_i64();
     TCGv_i64 t2 = tcg_temp_new_i64();
 
-    tcg_gen_mov_i64(t1, arg1);
-    tcg_gen_extract_i64(t2, t1, ofs, len);
-    tcg_gen_not_i64(t2, t2);
-    tcg_gen_addi_i64(t2, t2, 1);
-    tcg_gen_deposit_i64(t1, t1, t2, ofs, len);
-    tcg_gen_mov_i64(ret, t1);
+    add(t1, a, b);
+    sub(t2, a, b);
+    tcg_gen_andi_i64(t1, t1, ~sub_mask);
+    tcg_gen_andi_i64(t2, t2, sub_mask);
+    tcg_gen_or_i64(d, t1, t2);
 
     tcg_temp_free_i64(t2);
-	tcg_temp_free_i64(t1);
+    tcg_temp_free_i64(t1);
+}
+
+void
+arc_gen_vec_addsub16_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b,
+                         uint64_t sub_mask)
+{
+    arc_gen_vec_addsub_i64(d, a, b, sub_mask,
+                           tcg_gen_vec_add16_i64, tcg_gen_vec_sub16_i64);
+}
+
+void
+arc_gen_vec_addsub32_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b,
+                         uint64_t sub_mask)
+{
+    arc_gen_vec_addsub_i64(d, a, b, sub_mask,
+                           tcg_gen_vec_add32_i64, tcg_gen_vec_sub32_i64);
+}
+
+void
+arc_gen_vec_addsub16_w0_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b,
+                            uint64_t sub_mask)
+{
+    TCGv_i64 t1 = tcg_temp_new_i64();
+
+    arc_gen_vec_addsub16_i64(t1, a, b, sub_mask);
+    tcg_gen_deposit_i64(d, d, t1, 0, 32);
+
+    tcg_temp_free_i64(t1);
+}
+
+void
+arc_gen_vec_addsub16_i32(TCGv_i32 d, TCGv_i32 a, TCGv_i32 b,
+                         uint32_t sub_mask)
+{
+    TCGv_i32 t1 = tcg_temp_new_i32();
+    TCGv_i32 t2 = tcg_temp_new_i32();
+
+    tcg_gen_vec_add16_i32(t1, a, b);
+    tcg_gen_vec_sub16_i32(t2, a, b);
+    tcg_gen_andi_i32(t1, t1, ~sub_mask);
+    tcg_gen_andi_i32(t2, t2, sub_mask);
+    tcg_gen_or_i32(d, t1, t2);
+
+    tcg_temp_free_i32(t2);
+    tcg_temp_free_i32(t1);
 }
 
 void
@@ -159,6 +209,8 @@ arc_gen_mac_check_fflags(DisasCtxt *ctx, TCGv_i64 result, TCGv_i64 operand_1,
      * F flag is set, affect the flags
      */
     if (getFFlag()) {
+        arc_gen_compute_cv(ctx);
+
         #if TARGET_LONG_BITS == 32
             TCGv_i64 N_flag;
             TCGv_i64 overflow;
@@ -376,6 +428,7 @@ arc_gen_mpy_check_fflags(DisasCtxt *ctx, TCGv_i64 result, bool set_n_flag)
      * F flag is set, affect the flags
      */
     if (getFFlag()) {
+        arc_gen_compute_cv(ctx);
         tcg_gen_movi_tl(cpu_Vf, 0);
 
         #if TARGET_LONG_BITS == 32
@@ -628,7 +681,6 @@ arc_gen_mpyd_base_i64(DisasCtxt *ctx, TCGv_i64 a, TCGv_i64 b, TCGv_i64 c,
 int
 arc_gen_VPACK2HL(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 {
-  TCGv b_h0 = tcg_temp_new();
   TCGv c_h0 = tcg_temp_new();
 
   TCGv cc_temp = tcg_temp_local_new();
@@ -640,17 +692,13 @@ arc_gen_VPACK2HL(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 
   /* Instruction code */
 
-  tcg_gen_sextract_tl(b_h0, b, 0, 16);
   tcg_gen_sextract_tl(c_h0, c, 0, 16);
-
-  tcg_gen_mov_tl(a, c_h0);
-  tcg_gen_deposit_tl(a, a, b_h0, 16, 16);
+  tcg_gen_deposit_tl(a, c_h0, b, 16, 16);  /* a = {b.h0, c.h0} */
 
   /* Conditional execution end. */
   gen_set_label(cc_done);
   tcg_temp_free(cc_temp);
 
-  tcg_temp_free(b_h0);
   tcg_temp_free(c_h0);
 
   return DISAS_NEXT;
@@ -674,11 +722,9 @@ arc_gen_VPACK2HM(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c)
 
   /* Instruction code */
 
-  tcg_gen_sextract_tl(b_h1, b, 16, 16);
+  tcg_gen_shri_tl(b_h1, b, 16);
   tcg_gen_sextract_tl(c_h1, c, 16, 16);
-
-  tcg_gen_mov_tl(a, c_h1);
-  tcg_gen_deposit_tl(a, a, b_h1, 16, 16);
+  tcg_gen_deposit_tl(a, c_h1, b_h1, 16, 16);  /* a = {b.h1, c.h1} */
 
   /* Conditional execution end. */
   gen_set_label(cc_done);
@@ -69,8 +69,19 @@ int __not_implemented_semfunc_4(DisasCtxt *ctx, TCGv a, TCGv b, TCGv c, TCGv d);
 
 void arc_gen_vec_add16_w0_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b);
 
-void arc_gen_cmpl2_i64(TCGv_i64 ret, TCGv_i64 arg1,
-                       unsigned int ofs, unsigned int len);
+/**
+ * @brief Lane-wise A + B, except for the lanes in SUB_MASK which get A - B
+ * @param sub_mask Bit mask covering the lanes to subtract (ARC_VEC_LANES_*)
+ */
+void arc_gen_vec_addsub16_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b,
+                              uint64_t sub_mask);
+void arc_gen_vec_addsub32_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b,
+                              uint64_t sub_mask);
+void arc_gen_vec_addsub16_i32(TCGv_i32 d, TCGv_i32 a, TCGv_i32 b,
+                              uint32_t sub_mask);
+/* As arc_gen_vec_addsub16_i64, but only the low word of D is written. */
+void arc_gen_vec_addsub16_w0_i64(TCGv_i64 d, TCGv_i64 a, TCGv_i64 b,
+                                 uint64_t sub_mask);
 
 /**
  * @brief Verifies if a 64 bit signed add resulted in an overflow
@@ -345,17 +356,11 @@ arc_gen_mpyd_base_i64(DisasCtxt *ctx, TCGv_i64 a, TCGv_i64 b, TCGv_i64 c,
     }                                                                   \
     tcg_temp_free(cc_temp);
 
-#define ARC_GEN_CMPL2_H0_I64(RET, ARG1)     arc_gen_cmpl2_i64(RET, ARG1, 0, 16)
-#define ARC_GEN_CMPL2_H1_I64(RET, ARG1)     arc_gen_cmpl2_i64(RET, ARG1, 16, 16)
-#define ARC_GEN_CMPL2_H2_I64(RET, ARG1)     arc_gen_cmpl2_i64(RET, ARG1, 32, 16)
-#define ARC_GEN_CMPL2_H3_I64(RET, ARG1)     arc_gen_cmpl2_i64(RET, ARG1, 48, 16)
-#define ARC_GEN_CMPL2_H0_H2_I64(RET, ARG1)  \
-    ARC_GEN_CMPL2_H0_I64(RET, ARG1);        \
-    ARC_GEN_CMPL2_H2_I64(RET, RET)
-#define ARC_GEN_CMPL2_H1_H3_I64(RET, ARG1)  \
-    ARC_GEN_CMPL2_H1_I64(RET, ARG1);        \
-    ARC_GEN_CMPL2_H3_I64(RET, RET)
-#define ARC_GEN_CMPL2_W0_I64(RET, ARG1)     arc_gen_cmpl2_i64(RET, ARG1, 0, 32)
-#define ARC_GEN_CMPL2_W1_I64(RET, ARG1)     arc_gen_cmpl2_i64(RET, ARG1, 32, 32)
+#define ARC_VEC_LANES_H0        0x000000000000ffffULL
+#define ARC_VEC_LANES_H1        0x00000000ffff0000ULL
+#define ARC_VEC_LANES_H0_H2     0x0000ffff0000ffffULL
+#define ARC_VEC_LANES_H1_H3     0xffff0000ffff0000ULL
+#define ARC_VEC_LANES_W0        0x00000000ffffffffULL
+#define ARC_VEC_LANES_W1        0xffffffff00000000ULL
 
 #endif /* __ARC_SEMFUNC_H__ */
@@ -29,8 +29,6 @@
 #include "qemu/log.h"
 
 #define NANOSECONDS_PER_SECOND 1000000000LL
-#define TIMER_PERIOD(hz) (1000000000LL / (hz))
-#define TIMEOUT_LIMIT 1000000
 
 #define FREQ_HZ (env_archcpu(env)->freq_hz)
 
@@ -57,27 +55,34 @@ static uint32_t get_t_count(CPUARCState *env, uint32_t t)
 
 #define T_COUNT(T) (get_t_count(env, T))
 
-/* Update the next timeout time as difference between Count and Limit */
+/*
+ * Arm the timer for the instant COUNT reaches LIMIT.  COUNT itself is
+ * never stored: it is derived from last_clk on every read, so only LIMIT
+ * and COUNT writes, and the expiry itself, need to move the deadline.
+ */
 static void cpu_arc_timer_update(CPUARCState *env, uint32_t timer)
 {
-    uint32_t delta;
-    uint32_t t_count = T_COUNT(timer);
 #ifndef CONFIG_USER_ONLY
-    uint64_t now = get_ns(env);
-#endif
+    ARCTimer *t = &env->timer[timer];
+    uint64_t cycles = (uint32_t) t->T_Limit;
+    int64_t deadline;
 
-    delta = env->timer[timer].T_Limit - t_count;
+    /* A COUNT already past LIMIT has to wrap around first. */
+    if (T_COUNT(timer) > (uint32_t) t->T_Limit) {
+        cycles += 1ULL << 32;
+    }
+    deadline = t->last_clk + MAX(CYCLES_TO_NS(cycles), 1);
 
-#ifndef CONFIG_USER_ONLY
-    timer_mod_ns(env->cpu_timer[timer], now + CYCLES_TO_NS((uint64_t)delta));
-#endif
+    if (deadline != t->deadline) {
+        t->deadline = deadline;
+        timer_mod_ns(env->cpu_timer[timer], deadline);
+    }
 
     qemu_log_mask(LOG_UNIMP,
                   "[TMR%d] Timer update in 0x" TARGET_FMT_lx
-                  " - 0x%08x = 0x%08x (ctrl:0x" TARGET_FMT_lx
-                  " @ %d Hz)\n",
-                  timer, env->timer[timer].T_Limit,
-                  t_count, delta, env->timer[timer].T_Cntrl, FREQ_HZ);
+                  " (ctrl:0x" TARGET_FMT_lx " @ %d Hz), deadline %" PRId64
+                  "\n", timer, t->T_Limit, t->T_Cntrl, FREQ_HZ, deadline);
+#endif
 }
 
 #ifndef CONFIG_USER_ONLY
@@ -95,7 +100,18 @@ static void cpu_arc_timer_expire(CPUARCState *env, uint32_t timer)
         qemu_mutex_lock_iothread();
     }
     env->timer[timer].T_Cntrl |= TMR_IP;
-    env->timer[timer].last_clk = get_ns(env);
+    /*
+     * COUNT restarted from 0 at the deadline, not when the callback got to
+     * run.  Only if the callback is late by more than a whole period is
+     * the lost time dropped instead of replayed one expiry at a time.
+     */
+    uint64_t now = get_ns(env);
+    uint64_t period = MAX(CYCLES_TO_NS((uint32_t) env->timer[timer].T_Limit),
+                          1);
+    env->timer[timer].last_clk = env->timer[timer].deadline;
+    if (now - env->timer[timer].last_clk >= period) {
+        env->timer[timer].last_clk = now;
+    }
     if (unlocked) {
         qemu_mutex_unlock_iothread();
     }
@@ -141,55 +157,53 @@ static void arc_timer1_cb(void *opaque)
 }
 #endif
 
-/* RTC counter update. */
-static void cpu_rtc_count_update(CPUARCState *env)
+/*
+ * RTC counter value: the 64-bit count latched in aux_rtc_low/high plus,
+ * while the RTC runs, the cycles elapsed since last_clk_rtc.
+ */
+static uint64_t cpu_rtc_count(CPUARCState *env)
 {
-    uint64_t now;
-    uint64_t llreg;
-
-    assert((env_archcpu(env)->timer_build & TB_RTC) && env->cpu_rtc);
-    now = get_ns(env);
+    uint64_t count;
 
-    if (!(env->aux_rtc_ctrl & 0x01)) {
-        return;
+    count = env->aux_rtc_low + ((uint64_t)env->aux_rtc_high << 32);
+    if (env->aux_rtc_ctrl & 0x01) {
+        count += NS_TO_CYCLE(get_ns(env) - env->last_clk_rtc);
     }
+    return count;
+}
 
-    llreg = ((now - env->last_clk_rtc) / TIMER_PERIOD(FREQ_HZ));
-    llreg += env->aux_rtc_low + ((uint64_t)env->aux_rtc_high << 32);
-    env->aux_rtc_high = llreg >> 32;
-    env->aux_rtc_low = (uint32_t) llreg;
+#ifndef CONFIG_USER_ONLY
+/* Latch the current RTC count as the new base. */
+static void cpu_rtc_count_save(CPUARCState *env)
+{
+    uint64_t count = cpu_rtc_count(env);
 
-    env->last_clk_rtc = now;
-    qemu_log_mask(LOG_UNIMP, "[RTC] RTC count-regs update\n");
+    env->aux_rtc_high = count >> 32;
+    env->aux_rtc_low = (uint32_t) count;
+    env->last_clk_rtc = get_ns(env);
 }
 
-#ifndef CONFIG_USER_ONLY
-/* Update the next timeout time as difference between Count and Limit */
+/* Arm the RTC for its wrap-around, if that can happen at all. */
 static void cpu_rtc_update(CPUARCState *env)
 {
-    uint64_t wait = 0;
-    uint64_t now, period;
-    uint64_t next;
+    uint64_t now, wait;
 
     assert(env->cpu_rtc);
-    now = get_ns(env);
 
     if (!(env->aux_rtc_ctrl & 0x01)) {
+        timer_del(env->cpu_rtc);
         return;
     }
 
-    period = TIMER_PERIOD(FREQ_HZ);
-    wait = UINT64_MAX - ((((uint64_t) env->aux_rtc_high) << 32)
-                       + env->aux_rtc_low);
-    wait -= (now - env->last_clk_rtc) / period;
-
-    /* Limit timeout rate. */
-    if ((wait * period) < TIMEOUT_LIMIT) {
-        period = TIMEOUT_LIMIT / wait;
+    now = get_ns(env);
+    wait = UINT64_MAX - cpu_rtc_count(env);
+    if (wait >= NS_TO_CYCLE(INT64_MAX - now)) {
+        /* Past the end of the virtual clock. */
+        timer_del(env->cpu_rtc);
+        return;
     }
 
-    next = now + (uint64_t) wait * period;
-    timer_mod(env->cpu_rtc, next);
+    timer_mod_ns(env->cpu_rtc, now + CYCLES_TO_NS(wait + 1));
     qemu_log_mask(LOG_UNIMP, "[RTC] RTC update\n");
 }
 #endif
@@ -221,27 +235,18 @@ static void cpu_arc_count_reset(CPUARCState *env, uint32_t timer)
     env->timer[timer].T_Limit = 0x00ffffff;
 }
 
-/* Get the counter value. */
+/* Get the counter value, no side effects. */
 static uint32_t cpu_arc_count_get(CPUARCState *env, uint32_t timer)
 {
-    uint32_t count = T_COUNT(timer);
-    qemu_log_mask(LOG_UNIMP, "[TMR%d] Timer count %d.\n", timer, count);
-    return count;
+    return T_COUNT(timer);
 }
 
 /* Set the counter value. */
 static void cpu_arc_count_set(CPUARCState *env, uint32_t timer, uint32_t val)
 {
     assert(timer == 0 || timer == 1);
-    bool unlocked = !qemu_mutex_iothread_locked();
-    if (unlocked) {
-        qemu_mutex_lock_iothread();
-    }
     env->timer[timer].last_clk = get_ns(env) - CYCLES_TO_NS(val);
     cpu_arc_timer_update(env, timer);
-    if (unlocked) {
-        qemu_mutex_unlock_iothread();
-    }
 }
 
 /* Store the counter limit. */
@@ -287,8 +292,8 @@ static void cpu_arc_control_set(CPUARCState *env,
 /* Get The RTC count value. */
 static uint32_t arc_rtc_count_get(CPUARCState *env, bool lower)
 {
-    cpu_rtc_count_update(env);
-    return lower ? env->aux_rtc_low : env->aux_rtc_high;
+    uint64_t count = cpu_rtc_count(env);
+    return lower ? (uint32_t) count : count >> 32;
 }
 
 /* Set the RTC control bits. */
@@ -301,9 +306,9 @@ static void arc_rtc_ctrl_set(CPUARCState *env, uint32_t val)
         env->aux_rtc_low = 0;
         env->aux_rtc_high = 0;
         env->last_clk_rtc = get_ns(env);
-    }
-    if (!(val & 0x01)) {
-        timer_del(env->cpu_rtc);
+    } else if ((env->aux_rtc_ctrl & 0x01) && !(val & 0x01)) {
+        /* Stopping: keep the count reached so far. */
+        cpu_rtc_count_save(env);
     }
 
     /* Restart RTC, update last clock. */
@@ -342,6 +347,8 @@ cpu_arc_clock_init(ARCCPU *cpu)
 
     env->timer[0].last_clk = get_ns(env);
     env->timer[1].last_clk = get_ns(env);
+    env->timer[0].deadline = INT64_MAX;
+    env->timer[1].deadline = INT64_MAX;
 }
 
 void
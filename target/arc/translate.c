@@ -24,6 +24,7 @@
 #include "tcg/tcg-op-gvec.h"
 #include "target/arc/semfunc.h"
 #include "target/arc/arc-common.h"
+#include "exec/plugin-gen.h"
 
 
 /* Globals */
@@ -37,6 +38,11 @@ TCGv    cpu_Cf;
 TCGv    cpu_Nf;
 TCGv    cpu_Zf;
 
+TCGv    cpu_cc_op;
+TCGv    cpu_cc_dst;
+TCGv    cpu_cc_src1;
+TCGv    cpu_cc_src2;
+
 TCGv    cpu_er_pstate;
 TCGv    cpu_er_Vf;
 TCGv    cpu_er_Cf;
@@ -77,6 +83,47 @@ TCGv cpu_exclusive_val_hi;
 #define ARRANGE_ENDIAN(endianess, buf)                  \
     ((endianess) ? ror32(buf, 16) : bswap32(buf))
 
+/*
+ * Compute in RET the cs_base that cpu_get_tb_cpu_state() reports when
+ * the pc is PC, with LP_START and LP_END as they are now.
+ */
+static void arc_gen_tb_cs_base(TCGv ret, TCGv pc)
+{
+    TCGv lpe = tcg_temp_new();
+    TCGv lps = tcg_temp_new();
+    TCGv dist = tcg_temp_new();
+    TCGv t = tcg_temp_new();
+
+#if defined(TARGET_ARC32)
+    tcg_gen_mov_tl(lpe, cpu_lpe);
+    tcg_gen_mov_tl(lps, cpu_lps);
+#else
+    tcg_gen_ld_tl(lpe, cpu_env, offsetof(CPUARCState, lpe));
+    tcg_gen_ld_tl(lps, cpu_env, offsetof(CPUARCState, lps));
+#endif
+    tcg_gen_andi_tl(dist, pc, TARGET_PAGE_MASK);
+    tcg_gen_sub_tl(dist, lpe, dist);
+
+    tcg_gen_sub_tl(t, lpe, lps);
+    tcg_gen_shli_tl(lps, t, ARC_CSBASE_LPS_OFF_SHIFT);
+    tcg_gen_movcond_tl(TCG_COND_LEU, lps, t,
+                       tcg_constant_tl(ARC_CSBASE_LPS_OFF_MASK >>
+                                       ARC_CSBASE_LPS_OFF_SHIFT),
+                       lps, tcg_constant_tl(0));
+    tcg_gen_or_tl(lps, lps, dist);
+
+    /* dist != 0 && dist <= TARGET_PAGE_SIZE + ARC_MAX_INSN_SIZE */
+    tcg_gen_subi_tl(t, dist, 1);
+    tcg_gen_movcond_tl(TCG_COND_LTU, ret, t,
+                       tcg_constant_tl(TARGET_PAGE_SIZE + ARC_MAX_INSN_SIZE),
+                       lps, tcg_constant_tl(0));
+
+    tcg_temp_free(t);
+    tcg_temp_free(dist);
+    tcg_temp_free(lps);
+    tcg_temp_free(lpe);
+}
+
 void gen_goto_tb(const DisasContext *ctx, int n, TCGv dest)
 {
     tcg_gen_mov_tl(cpu_pc, dest);
@@ -84,6 +131,13 @@ void gen_goto_tb(const DisasContext *ctx, int n, TCGv dest)
     /* TODO: is this really needed !!! */
     if (ctx->base.singlestep_enabled) {
         gen_helper_debug(cpu_env);
+    } else if (ctx->ras_return) {
+        TCGv cs_base = tcg_temp_new();
+
+        arc_gen_tb_cs_base(cs_base, cpu_pc);
+        translator_ras_return(&ctx->base, cpu_pc, cs_base,
+                              ctx->base.tb->flags);
+        tcg_temp_free(cs_base);
     } else {
         tcg_gen_exit_tb(NULL, 0);
     }
@@ -124,6 +178,10 @@ void arc_translate_init(void)
         NEW_ARC_REG(cpu_Nf, stat.Nf)
         NEW_ARC_REG(cpu_Cf, stat.Cf)
         NEW_ARC_REG(cpu_Vf, stat.Vf)
+        NEW_ARC_REG(cpu_cc_op, stat.cc_op)
+        NEW_ARC_REG(cpu_cc_dst, stat.cc_dst)
+        NEW_ARC_REG(cpu_cc_src1, stat.cc_src1)
+        NEW_ARC_REG(cpu_cc_src2, stat.cc_src2)
 
         NEW_ARC_REG(cpu_er_pstate, stat_er.pstate)
         NEW_ARC_REG(cpu_er_Zf, stat_er.Zf)
@@ -177,15 +235,33 @@ static void arc_tr_init_disas_context(DisasContextBase *dcbase,
                                       CPUState *cs)
 {
     DisasContext *dc = container_of(dcbase, DisasContext, base);
+    target_ulong cs_base = dc->base.tb->cs_base;
+    target_ulong lps_off;
 
     dc->base.is_jmp = DISAS_NEXT;
     dc->mem_idx = dc->base.tb->flags & 1;
+    dc->code_win_len = 0;
+
+    dc->lpe = -1;
+    dc->lps = -1;
+    if ((cs_base & ARC_CSBASE_LPE_MASK) != 0) {
+        dc->lpe = (dc->base.pc_first & TARGET_PAGE_MASK)
+                  + (cs_base & ARC_CSBASE_LPE_MASK);
+        lps_off = (cs_base & ARC_CSBASE_LPS_OFF_MASK)
+                  >> ARC_CSBASE_LPS_OFF_SHIFT;
+        if (lps_off != 0) {
+            dc->lps = dc->lpe - lps_off;
+        }
+    }
 }
 static void arc_tr_tb_start(DisasContextBase *dcbase, CPUState *cpu)
 {
-    /* place holder for now */
+    DisasContext *dc = container_of(dcbase, DisasContext, base);
+
+    /* Whatever the previous TB left pending is only known at run time. */
+    dc->cc_op = ARC_CC_OP_DYNAMIC;
+
     /* TODO: Make sure you really need to guard it. */
-    //DisasContext *dc = container_of(dcbase, DisasContext, base);
     //dc->possible_delayslot_instruction = dc->env->stat.DEf;
 
 }
@@ -212,6 +288,96 @@ static int arc_gen_INVALID(const DisasContext *ctx)
     return DISAS_NORETURN;
 }
 
+/*
+ * Code fetch.  Rather than a TLB lookup per 16-bit half and per LIMM,
+ * the translator copies up to ARC_CODE_WINDOW_SIZE bytes at a time, never
+ * past the end of the page, straight from the host page and decodes from
+ * that copy.  Code that is not in RAM, or under an MPU region smaller than
+ * a page, is still read one halfword at a time.
+ */
+static void arc_code_window_fill(DisasContext *ctx, target_ulong pc)
+{
+    void *host = NULL;
+    target_ulong len = -(pc | TARGET_PAGE_MASK);
+
+    ctx->code_win_start = pc;
+    ctx->code_win_len = 0;
+
+    if (get_page_addr_code_hostp(ctx->env, pc, &host) == -1 || host == NULL) {
+        return;
+    }
+    ctx->code_win_len = MIN(len, ARC_CODE_WINDOW_SIZE);
+    memcpy(ctx->code_win, host, ctx->code_win_len);
+}
+
+static uint16_t arc_code_lduw(DisasContext *ctx, target_ulong pc)
+{
+    uint16_t ret;
+
+#ifndef CONFIG_USER_ONLY
+    if (pc - ctx->code_win_start + 2 > ctx->code_win_len) {
+        arc_code_window_fill(ctx, pc);
+    }
+    if (ctx->code_win_len != 0) {
+        ret = lduw_le_p(ctx->code_win + (pc - ctx->code_win_start));
+        plugin_insn_append(pc, &ret, sizeof(ret));
+        return ret;
+    }
+#endif
+    ret = translator_lduw(ctx->env, &ctx->base, pc);
+    return ret;
+}
+
+/* A LIMM is only halfword aligned and may straddle two pages. */
+static uint32_t arc_code_ldl(DisasContext *ctx, target_ulong pc)
+{
+    uint32_t lo = arc_code_lduw(ctx, pc);
+    return lo | ((uint32_t) arc_code_lduw(ctx, pc + 2) << 16);
+}
+
+/*
+ * Decoding an instruction only depends on its bits and the CPU family,
+ * so decoded formats are memoised by content.  No invalidation is ever
+ * needed: modified code simply looks up different bits, and the entries
+ * stay valid across TB flushes.  One table per translating thread.
+ */
+#define ARC_DECODE_CACHE_BITS 10
+
+typedef struct ArcDecodeCacheEntry {
+    uint64_t insn;
+    uint32_t family;
+    uint8_t  length;                    /* 0 for an empty entry */
+    const struct arc_opcode *opcode;    /* NULL for an invalid insn */
+    insn_t   decoded;
+} ArcDecodeCacheEntry;
+
+static __thread ArcDecodeCacheEntry *arc_decode_cache;
+
+static const struct arc_opcode *
+arc_find_format_cached(insn_t *insnd, uint64_t insn, uint8_t length,
+                       uint32_t family)
+{
+    ArcDecodeCacheEntry *e;
+    uint32_t h;
+
+    if (unlikely(arc_decode_cache == NULL)) {
+        arc_decode_cache = g_new0(ArcDecodeCacheEntry,
+                                  1 << ARC_DECODE_CACHE_BITS);
+    }
+
+    h = ((uint32_t) insn ^ length) * 0x9e3779b1u;
+    e = &arc_decode_cache[h >> (32 - ARC_DECODE_CACHE_BITS)];
+
+    if (e->insn != insn || e->length != length || e->family != family) {
+        e->opcode = arc_find_format(&e->decoded, insn, length, family);
+        e->insn = insn;
+        e->length = length;
+        e->family = family;
+    }
+    *insnd = e->decoded;
+    return e->opcode;
+}
+
 /*
  * Giving a CTX, decode it into an valid OPCODE_P if it
  * exists. Returns TRUE if successfully.
@@ -225,7 +391,7 @@ static bool read_and_decode_context(DisasContext *ctx,
     ARCCPU *cpu = env_archcpu(ctx->env);
 
     /* Read the first 16 bits, figure it out what kind of instruction it is. */
-    buffer[0] = cpu_lduw_code(ctx->env, ctx->cpc);
+    buffer[0] = arc_code_lduw(ctx, ctx->cpc);
     length = arc_insn_length(buffer[0], cpu->family);
 
     switch (length) {
@@ -235,7 +401,7 @@ static bool read_and_decode_context(DisasContext *ctx,
         break;
     case 4:
         /* 32-bit instructions. */
-        buffer[1] = cpu_lduw_code(ctx->env, ctx->cpc + 2);
+        buffer[1] = arc_code_lduw(ctx, ctx->cpc + 2);
         uint32_t buf = (buffer[0] << 16) | buffer[1];
         insn = buf;
         break;
@@ -255,7 +421,8 @@ static bool read_and_decode_context(DisasContext *ctx,
 
 
     //opcode_id = OPCODE_INVALID;
-    *opcode_p = arc_find_format(&ctx->insn, insn, length, cpu->family);
+    *opcode_p = arc_find_format_cached(&ctx->insn, insn, length,
+                                       cpu->family);
 
     //if(opcode_id != OPCODE_INVALID)
     //  qemu_log_mask(LOG_UNIMP, "Linear decoder format at 0x" TARGET_FMT_lx " (0x%08lx) - %d - %s\n",
@@ -274,19 +441,16 @@ static bool read_and_decode_context(DisasContext *ctx,
 #if defined(TARGET_ARC32)
     if (ctx->insn.limm_p) {
         ctx->insn.limm = ARRANGE_ENDIAN(true,
-                                        cpu_ldl_code(ctx->env,
-                                        ctx->cpc + length));
+                                        arc_code_ldl(ctx, ctx->cpc + length));
         length += 4; 
 #elif defined(TARGET_ARC64)
     if (ctx->insn.unsigned_limm_p) {
         ctx->insn.limm = ARRANGE_ENDIAN(true,
-                                        cpu_ldl_code(ctx->env,
-                                        ctx->cpc + length));
+                                        arc_code_ldl(ctx, ctx->cpc + length));
         length += 4;
     } else if (ctx->insn.signed_limm_p) {
         ctx->insn.limm = ARRANGE_ENDIAN(true,
-                                        cpu_ldl_code (ctx->env,
-                                        ctx->cpc + length));
+                                        arc_code_ldl(ctx, ctx->cpc + length));
         if (ctx->insn.limm & 0x80000000)
           ctx->insn.limm += 0xffffffff00000000;
         length += 4;
@@ -455,6 +619,31 @@ static void arc_debug_opcode(const struct arc_opcode *opcode,
                   msg, opcode->name, ctx->cpc);
 }
 
+static void arc_record_const_operand(DisasContext *ctx, TCGv op,
+                                     target_ulong value)
+{
+    if (ctx->n_const_ops < ARRAY_SIZE(ctx->const_ops)) {
+        ctx->const_ops[ctx->n_const_ops].tcgv = op;
+        ctx->const_ops[ctx->n_const_ops].value = value;
+        ctx->n_const_ops++;
+    }
+}
+
+/* See translate.h. */
+bool arc_operand_is_const(const DisasContext *ctx, TCGv op,
+                          target_ulong *value)
+{
+    unsigned i;
+
+    for (i = 0; i < ctx->n_const_ops; i++) {
+        if (ctx->const_ops[i].tcgv == op) {
+            *value = ctx->const_ops[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
 static TCGv arc_decode_operand(const struct arc_opcode *opcode,
                                DisasContext *ctx,
                                unsigned char nop,
@@ -466,6 +655,7 @@ static TCGv arc_decode_operand(const struct arc_opcode *opcode,
         struct constant_operands *co = constant_entry_for(mapping, nop);
         assert(co != NULL);
         ret = tcg_const_local_tl(co->default_value);
+        arc_record_const_operand(ctx, ret, co->default_value);
         return ret;
     } else {
         operand_t operand = ctx->insn.operands[nop];
@@ -486,6 +676,7 @@ static TCGv arc_decode_operand(const struct arc_opcode *opcode,
             } else {
                 ret = tcg_const_local_tl(limm);
             }
+            arc_record_const_operand(ctx, ret, limm);
         }
       }
 
@@ -1268,11 +1459,15 @@ arc_gen_SLEEP(DisasCtxt *ctx, TCGv a)
     }
     /* FIXME: setup debug registers as well. */
 
+    /*
+     * Halt until an interrupt: the vCPU thread blocks rather than spins,
+     * and the timers wake it up from their armed deadline.
+     */
     TCGv npc = tcg_temp_local_new();
     tcg_gen_movi_tl(npc, ctx->npc);
     gen_helper_halt(cpu_env, npc);
     tcg_temp_free(npc);
-    return DISAS_NEXT;
+    return DISAS_EXIT;
 }
 
 
@@ -1293,10 +1488,24 @@ static int arc_decode(DisasContext *ctx, const struct arc_opcode *opcode)
     if (mapping != MAP_NONE) {
         TCGv ops[10];
         int i;
+        int cc_op;
+        int nb_labels = tcg_ctx->nb_labels;
+
+        ctx->n_const_ops = 0;
         for (i = 0; i < number_of_ops_semfunc[mapping]; i++) {
             ops[i] = arc_decode_operand(opcode, ctx, i, mapping);
         }
 
+        /*
+         * The condition code is evaluated before the semantic function
+         * opens its conditional region, so C and V can be brought up to
+         * date unconditionally here.
+         */
+        if (arc_cond_uses_cv(ctx->insn.cc)) {
+            arc_gen_compute_cv(ctx);
+        }
+        cc_op = ctx->cc_op;
+
         /*
          * Store some elements statically to implement less dynamic
          * features of instructions.  Started by the need to keep a
@@ -1335,6 +1544,18 @@ static int arc_decode(DisasContext *ctx, const struct arc_opcode *opcode)
 #undef SEMANTIC_FUNCTION_CALL_2
 #undef SEMANTIC_FUNCTION_CALL_3
 
+        /*
+         * A semantic function guards its body with one label for the
+         * condition code, which is never taken for AL.  If the flag state
+         * changed under a real runtime condition, the skipped path still
+         * has the old state and only env knows which one is live.
+         */
+        if (ctx->cc_op != cc_op
+            && (ctx->insn.cc != ARC_COND_AL
+                || tcg_ctx->nb_labels - nb_labels > 1)) {
+            ctx->cc_op = ARC_CC_OP_DYNAMIC;
+        }
+
         for (i = 0; i < number_of_ops_semfunc[mapping]; i++) {
             operand_t operand = ctx->insn.operands[i];
             if (!(operand.type & ARC_OPERAND_LIMM) &&
@@ -1351,6 +1572,76 @@ static int arc_decode(DisasContext *ctx, const struct arc_opcode *opcode)
     return ret;
 }
 
+/*
+ * Branches end the TB through the dispatcher.  In a superblock, an
+ * unconditional B/BL with an immediate offset and no delay slot is
+ * folded in instead: translation simply carries on at its target.
+ * A target at LP_END would be mistaken for falling into the end of a
+ * zero-overhead loop, so those still branch.
+ */
+static bool arc_fold_branch(DisasContext *ctx, const struct arc_opcode *opcode)
+{
+    enum arc_opcode_map mapping = arc_map_opcode(opcode);
+    bool link = mapping == MAP_bl_BL || mapping == MAP_bl_s_BL;
+    operand_t op = ctx->insn.operands[0];
+    target_ulong dest;
+
+    if ((mapping != MAP_b_B && mapping != MAP_b_s_B && !link)
+        || ctx->insn.cc != ARC_COND_AL || ctx->insn.d
+        || ctx->insn.n_ops < 1
+        || (op.type & (ARC_OPERAND_IR | ARC_OPERAND_LIMM))
+        || ctx->env->in_delayslot_instruction
+        || GET_STATUS_BIT(ctx->env->stat, PREVIOUS_IS_DELAYSLOTf)) {
+        return false;
+    }
+
+    dest = ctx->pcl + op.value;
+    if (dest == ctx->lpe
+        || !translator_follow_jump(&ctx->base, ctx->npc, dest)) {
+        return false;
+    }
+
+    if (link) {
+        tcg_gen_movi_tl(cpu_blink, ctx->npc);
+    }
+    ctx->npc = dest;
+    return true;
+}
+
+/*
+ * Calls push their return address on the shadow return stack, see
+ * translator_ras_push(), and J [BLINK] pops it.  Only the plain forms
+ * are handled: with a delay slot the jump happens one instruction later.
+ */
+static void arc_gen_ras(DisasContext *ctx, const struct arc_opcode *opcode)
+{
+    enum arc_opcode_map mapping = arc_map_opcode(opcode);
+    operand_t op = ctx->insn.operands[0];
+
+    ctx->ras_return = false;
+    if (ctx->insn.d || ctx->insn.n_ops < 1
+        || ctx->env->in_delayslot_instruction) {
+        return;
+    }
+
+    switch (mapping) {
+    case MAP_bl_BL:
+    case MAP_bl_s_BL:
+    case MAP_jl_JL:
+    case MAP_jl_s_JL:
+        if (ctx->insn.cc == ARC_COND_AL) {
+            translator_ras_push(&ctx->base, ctx->npc);
+        }
+        break;
+    case MAP_j_J:
+    case MAP_j_s_J:
+        ctx->ras_return = (op.type & ARC_OPERAND_IR) && op.value == 31;
+        break;
+    default:
+        break;
+    }
+}
+
 void decode_opc(CPUARCState *env, DisasContext *ctx)
 {
     ctx->env = env;
@@ -1366,6 +1657,11 @@ void decode_opc(CPUARCState *env, DisasContext *ctx)
         env->next_insn_is_delayslot = false;
     }
 
+    arc_gen_ras(ctx, opcode);
+    if (arc_fold_branch(ctx, opcode)) {
+        ctx->base.is_jmp = DISAS_NEXT;
+        return;
+    }
 
     ctx->base.is_jmp = arc_decode(ctx, opcode);
 
@@ -1409,26 +1705,41 @@ void decode_opc(CPUARCState *env, DisasContext *ctx)
     gen_helper_zol_verify(cpu_env, npc);
     tcg_temp_free(npc);
 #else
-    if(1 && env->lpe == ctx->npc) {
-
-        DisasJumpType ret = ctx->base.is_jmp;
-
-        TCGLabel *zol_end = gen_new_label();
-        TCGLabel *zol_else = gen_new_label();
-        TCGv lps = tcg_temp_local_new();
-
-        tcg_gen_brcondi_tl(TCG_COND_GTU, cpu_lpc, 1, zol_else);
-          tcg_gen_movi_tl(cpu_lpc, 0);
-          tcg_gen_br(zol_end);
-        gen_set_label(zol_else);
-          tcg_gen_subi_tl(cpu_lpc, cpu_lpc, 1);
-          tcg_gen_movi_tl(lps, env->lps);
-          setPC(lps);
-        gen_set_label(zol_end);
-
-        ctx->base.is_jmp = DISAS_NORETURN;
+    if (ctx->npc == ctx->lpe && ctx->base.is_jmp != DISAS_EXIT) {
+        if (ctx->base.is_jmp == DISAS_UPDATE) {
+            /*
+             * The instruction went through the sr helper and may have
+             * moved the loop itself, only env knows where it ends now.
+             */
+            TCGv npc = tcg_const_tl(ctx->npc);
+            gen_helper_zol_verify(cpu_env, npc);
+            tcg_temp_free(npc);
+        } else {
+            /*
+             * Close the loop in the TB: count down LP_COUNT and chain
+             * straight back to LP_START.
+             */
+            TCGLabel *zol_end = gen_new_label();
+
+            tcg_gen_brcondi_tl(TCG_COND_LEU, cpu_lpc, 1, zol_end);
+            tcg_gen_subi_tl(cpu_lpc, cpu_lpc, 1);
+            if (ctx->lps != (target_ulong) -1) {
+                gen_gotoi_tb(ctx, 1, ctx->lps);
+            } else {
+#if defined(TARGET_ARC32)
+                gen_goto_tb(ctx, 1, cpu_lps);
+#else
+                TCGv lps = tcg_temp_new();
+                tcg_gen_ld_tl(lps, cpu_env, offsetof(CPUARCState, lps));
+                gen_goto_tb(ctx, 1, lps);
+                tcg_temp_free(lps);
+#endif
+            }
+            gen_set_label(zol_end);
+            tcg_gen_movi_tl(cpu_lpc, 0);
 
-        tcg_temp_free(lps);
+            ctx->base.is_jmp = DISAS_NORETURN;
+        }
     }
 #endif
 }
@@ -1483,6 +1794,7 @@ static void arc_tr_tb_stop(DisasContextBase *dcbase, CPUState *cpu)
         break;
     case DISAS_BRANCH_IN_DELAYSLOT:
     case DISAS_NORETURN:
+    case DISAS_EXIT:
         break;
     default:
          g_assert_not_reached();
@@ -1510,6 +1822,7 @@ static const TranslatorOps arc_translator_ops = {
     .translate_insn     = arc_tr_translate_insn,
     .tb_stop            = arc_tr_tb_stop,
     .disas_log          = arc_tr_disas_log,
+    .superblock         = true,
 };
 
 /* generate intermediate code for basic block 'tb'. */
@@ -1535,6 +1848,7 @@ void arc_cpu_dump_state(CPUState *cs, FILE *f, int flags)
     CPUARCState *env = &cpu->env;
     int i;
 
+    arc_status_compute_cv(&env->stat);
 
     qemu_fprintf(f,
                  "STATUS:  [ %c %c %c %c %c %c %s %s %s %s %s %s %c]\n",
@@ -40,6 +40,11 @@
 /* signaling the end of translation block */
 #define DISAS_UPDATE        DISAS_TARGET_0
 #define DISAS_BRANCH_IN_DELAYSLOT DISAS_TARGET_1
+/* The instruction left the TB itself: nothing is emitted after it. */
+#define DISAS_EXIT          DISAS_TARGET_2
+
+/* Bytes of guest code fetched at once by the translator. */
+#define ARC_CODE_WINDOW_SIZE 64
 
 typedef struct DisasContext {
     DisasContextBase base;
@@ -48,10 +53,9 @@ typedef struct DisasContext {
     target_ulong npc;   /*  next pc         */
     target_ulong dpc;   /*  next next pc    */
     target_ulong pcl;
-#if defined(TARGET_ARC32)
+    /* Loop end and start from cs_base, -1 when not known. */
     target_ulong lpe;
     target_ulong lps;
-#endif
 
     unsigned ds;    /*  we are within ds*/
 
@@ -66,9 +70,30 @@ typedef struct DisasContext {
     uint16_t buffer[2];
     uint8_t  mem_idx;
 
+    /* Guest code prefetched from the host page, see arc_code_lduw(). */
+    target_ulong code_win_start;
+    unsigned     code_win_len;
+    uint8_t      code_win[ARC_CODE_WINDOW_SIZE];
+
     TCGv     tmp_reg;
     TCGLabel *label;
 
+    /*
+     * Operands of the current instruction whose value is known at
+     * translate time (immediates and LIMMs).
+     */
+    struct {
+        TCGv tcgv;
+        target_ulong value;
+    } const_ops[4];
+    unsigned n_const_ops;
+
+    /* Translation time view of env->stat.cc_op (enum arc_cc_op). */
+    int cc_op;
+
+    /* The current instruction is a return, J [BLINK] without delay slot. */
+    bool ras_return;
+
 } DisasContext;
 
 
@@ -95,6 +120,11 @@ extern TCGv     cpu_Cf;
 extern TCGv     cpu_Nf;
 extern TCGv     cpu_Zf;
 
+extern TCGv     cpu_cc_op;
+extern TCGv     cpu_cc_dst;
+extern TCGv     cpu_cc_src1;
+extern TCGv     cpu_cc_src2;
+
 extern TCGv     cpu_er_pstate;
 extern TCGv     cpu_er_Vf;
 extern TCGv     cpu_er_Cf;
@@ -122,6 +152,10 @@ extern TCGv     cpu_intvec;
 
 extern TCGv     cpu_lock_lf_var;
 
+extern TCGv     cpu_exclusive_addr;
+extern TCGv     cpu_exclusive_val;
+extern TCGv     cpu_exclusive_val_hi;
+
 extern TCGv     cpu_exception_delay_slot_address;
 
 
@@ -130,6 +164,13 @@ typedef struct DisasContext DisasCtxt;
 
 void gen_goto_tb(const DisasContext *ctx, int n, TCGv dest);
 
+/*
+ * Returns true, and the value in VALUE, if operand OP of the instruction
+ * being translated is a translate time constant.
+ */
+bool arc_operand_is_const(const DisasContext *ctx, TCGv op,
+                          target_ulong *value);
+
 void decode_opc(CPUARCState *env, DisasContext *ctx);
 
 /*
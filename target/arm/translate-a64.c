@@ -1308,10 +1308,20 @@ static void disas_uncond_b_imm(DisasContext *s, uint32_t insn)
     if (insn & (1U << 31)) {
         /* BL Branch with link */
         tcg_gen_movi_i64(cpu_reg(s, 30), s->base.pc_next);
+        translator_ras_push(&s->base, s->base.pc_next);
     }
 
     /* B Branch / BL Branch with link */
     reset_btype(s);
+    if (!s->ss_active &&
+        translator_follow_jump(&s->base, s->base.pc_next, addr)) {
+        /* Superblock: carry on at the target, up to the end of its page. */
+        int bound = -(addr | TARGET_PAGE_MASK) / 4;
+
+        s->base.max_insns = MIN(s->base.max_insns, s->base.num_insns + bound);
+        s->base.pc_next = addr;
+        return;
+    }
     gen_goto_tb(s, 0, addr);
 }
 
@@ -2227,7 +2237,9 @@ static void disas_uncond_b_reg(DisasContext *s, uint32_t insn)
         /* BLR also needs to load return address */
         if (opc == 1) {
             tcg_gen_movi_i64(cpu_reg(s, 30), s->base.pc_next);
+            translator_ras_push(&s->base, s->base.pc_next);
         }
+        s->ras_return = opc == 2;
         break;
 
     case 8: /* BRAA */
@@ -2254,6 +2266,7 @@ static void disas_uncond_b_reg(DisasContext *s, uint32_t insn)
         /* BLRAA also needs to load return address */
         if (opc == 9) {
             tcg_gen_movi_i64(cpu_reg(s, 30), s->base.pc_next);
+            translator_ras_push(&s->base, s->base.pc_next);
         }
         break;
 
@@ -14723,6 +14736,7 @@ static void aarch64_tr_init_disas_context(DisasContextBase *dcbase,
      *   end the TB
      */
     dc->ss_active = EX_TBFLAG_ANY(tb_flags, SS_ACTIVE);
+    dc->ras_return = false;
     dc->pstate_ss = EX_TBFLAG_ANY(tb_flags, PSTATE__SS);
     dc->is_ldex = false;
     dc->debug_target_el = EX_TBFLAG_ANY(tb_flags, DEBUG_TARGET_EL);
@@ -14933,7 +14947,17 @@ static void aarch64_tr_tb_stop(DisasContextBase *dcbase, CPUState *cpu)
             gen_a64_set_pc_im(dc->base.pc_next);
             /* fall through */
         case DISAS_JUMP:
-            tcg_gen_lookup_and_goto_ptr();
+            if (dc->ras_return) {
+                /* RET leaves BTYPE at 0 and the other flags alone. */
+                target_ulong cs_base = dc->base.tb->cs_base &
+                                       ~R_TBFLAG_A64_BTYPE_MASK;
+
+                translator_ras_return(&dc->base, cpu_pc,
+                                      tcg_constant_tl(cs_base),
+                                      dc->base.tb->flags);
+            } else {
+                tcg_gen_lookup_and_goto_ptr();
+            }
             break;
         case DISAS_NORETURN:
         case DISAS_SWI:
@@ -14982,4 +15006,5 @@ const TranslatorOps aarch64_translator_ops = {
     .translate_insn     = aarch64_tr_translate_insn,
     .tb_stop            = aarch64_tr_tb_stop,
     .disas_log          = aarch64_tr_disas_log,
+    .superblock         = true,
 };
@@ -79,6 +79,8 @@ typedef struct DisasContext {
      */
     bool ss_active;
     bool pstate_ss;
+    /* True if the TB ends with a function return (A64 RET). */
+    bool ras_return;
     /* True if the insn just emitted was a load-exclusive instruction
      * (necessary for syndrome information for single step exceptions),
      * ie A64 LDX*, LDAX*, A32/T32 LDREX*, LDAEX*.
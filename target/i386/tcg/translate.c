@@ -2327,7 +2327,7 @@ static void gen_goto_tb(DisasContext *s, int tb_num, target_ulong eip)
     } else {
         /* jump to another page */
         gen_jmp_im(s, eip);
-        gen_jr(s, s->tmp0);
+        gen_jr(s, tcg_constant_tl(eip));
     }
 }
 
@@ -2646,7 +2646,8 @@ static void gen_bnd_jmp(DisasContext *s)
    If RECHECK_TF, emit a rechecking helper for #DB, ignoring the state of
    S->TF.  This is used by the syscall/sysret insns.  */
 static void
-do_gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf, bool jr)
+do_gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf, bool jr,
+                  TCGv jr_eip, bool ret)
 {
     gen_update_cc_op(s);
 
@@ -2665,6 +2666,19 @@ do_gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf, bool jr)
         tcg_gen_exit_tb(NULL, 0);
     } else if (s->flags & HF_TF_MASK) {
         gen_helper_single_step(cpu_env);
+    } else if (jr && jr_eip &&
+               !(s->flags & (HF_INHIBIT_IRQ_MASK | HF_RF_MASK |
+                             HF_MPX_IU_MASK))) {
+        /* Nothing above changed the TB flags; the inline cache is safe. */
+        TCGv pc = tcg_temp_new();
+
+        tcg_gen_addi_tl(pc, jr_eip, s->cs_base);
+        if (ret) {
+            translator_ras_return(&s->base, pc, NULL, s->base.tb->flags);
+        } else {
+            translator_lookup_and_goto_ptr(&s->base, pc);
+        }
+        tcg_temp_free(pc);
     } else if (jr) {
         tcg_gen_lookup_and_goto_ptr();
     } else {
@@ -2676,7 +2690,7 @@ do_gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf, bool jr)
 static inline void
 gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf)
 {
-    do_gen_eob_worker(s, inhibit, recheck_tf, false);
+    do_gen_eob_worker(s, inhibit, recheck_tf, false, NULL, false);
 }
 
 /* End of block.
@@ -2692,10 +2706,16 @@ static void gen_eob(DisasContext *s)
     gen_eob_worker(s, false, false);
 }
 
-/* Jump to register */
+/* Jump to register.  DEST holds the new EIP, or is NULL if CS changed. */
 static void gen_jr(DisasContext *s, TCGv dest)
 {
-    do_gen_eob_worker(s, false, false, true);
+    do_gen_eob_worker(s, false, false, true, dest, false);
+}
+
+/* Near return to DEST, predicted by the shadow return stack. */
+static void gen_ret(DisasContext *s, TCGv dest)
+{
+    do_gen_eob_worker(s, false, false, true, dest, true);
 }
 
 /* generate a jump to eip. No segment change must happen before as a
@@ -2717,6 +2737,21 @@ static void gen_jmp(DisasContext *s, target_ulong eip)
     gen_jmp_tb(s, eip, 0);
 }
 
+/*
+ * In a superblock, carry on translating at the target of a direct jump
+ * instead of ending the TB there.
+ */
+static bool gen_jmp_follow(DisasContext *s, target_ulong eip)
+{
+    target_ulong pc = s->cs_base + eip;
+
+    if (!s->jmp_opt || !translator_follow_jump(&s->base, s->pc, pc)) {
+        return false;
+    }
+    s->pc = pc;
+    return true;
+}
+
 static inline void gen_ldq_env_A0(DisasContext *s, int offset)
 {
     tcg_gen_qemu_ld_i64(s->tmp1_i64, s->A0, s->mem_index, MO_LEUQ);
@@ -5119,6 +5154,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
             next_eip = s->pc - s->cs_base;
             tcg_gen_movi_tl(s->T1, next_eip);
             gen_push_v(s, s->T1);
+            translator_ras_push(&s->base, s->pc);
             gen_op_jmp_v(s->T0);
             gen_bnd_jmp(s);
             gen_jr(s, s->T0);
@@ -5142,8 +5178,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
                                       tcg_const_i32(dflag - 1),
                                       tcg_const_i32(s->pc - s->cs_base));
             }
-            tcg_gen_ld_tl(s->tmp4, cpu_env, offsetof(CPUX86State, eip));
-            gen_jr(s, s->tmp4);
+            gen_jr(s, NULL);
             break;
         case 4: /* jmp Ev */
             if (dflag == MO_16) {
@@ -5169,8 +5204,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
                 gen_op_movl_seg_T0_vm(s, R_CS);
                 gen_op_jmp_v(s->T1);
             }
-            tcg_gen_ld_tl(s->tmp4, cpu_env, offsetof(CPUX86State, eip));
-            gen_jr(s, s->tmp4);
+            gen_jr(s, NULL);
             break;
         case 6: /* push Ev */
             gen_push_v(s, s->T0);
@@ -6638,7 +6672,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
         /* Note that gen_pop_T0 uses a zero-extending load.  */
         gen_op_jmp_v(s->T0);
         gen_bnd_jmp(s);
-        gen_jr(s, s->T0);
+        gen_ret(s, s->T0);
         break;
     case 0xc3: /* ret */
         ot = gen_pop_T0(s);
@@ -6646,7 +6680,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
         /* Note that gen_pop_T0 uses a zero-extending load.  */
         gen_op_jmp_v(s->T0);
         gen_bnd_jmp(s);
-        gen_jr(s, s->T0);
+        gen_ret(s, s->T0);
         break;
     case 0xca: /* lret im */
         val = x86_ldsw_code(env, s);
@@ -6706,8 +6740,11 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
             }
             tcg_gen_movi_tl(s->T0, next_eip);
             gen_push_v(s, s->T0);
+            translator_ras_push(&s->base, s->pc);
             gen_bnd_jmp(s);
-            gen_jmp(s, tval);
+            if (!gen_jmp_follow(s, tval)) {
+                gen_jmp(s, tval);
+            }
         }
         break;
     case 0x9a: /* lcall im */
@@ -6737,7 +6774,9 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
             tval &= 0xffffffff;
         }
         gen_bnd_jmp(s);
-        gen_jmp(s, tval);
+        if (!gen_jmp_follow(s, tval)) {
+            gen_jmp(s, tval);
+        }
         break;
     case 0xea: /* ljmp im */
         {
@@ -6759,7 +6798,9 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
         if (dflag == MO_16) {
             tval &= 0xffff;
         }
-        gen_jmp(s, tval);
+        if (!gen_jmp_follow(s, tval)) {
+            gen_jmp(s, tval);
+        }
         break;
     case 0x70 ... 0x7f: /* jcc Jb */
         tval = (int8_t)insn_get(env, s, MO_8);
@@ -8703,6 +8744,7 @@ static const TranslatorOps i386_tr_ops = {
     .translate_insn     = i386_tr_translate_insn,
     .tb_stop            = i386_tr_tb_stop,
     .disas_log          = i386_tr_disas_log,
+    .superblock         = true,
 };
 
 /* generate intermediate code for basic block 'tb'.  */
@@ -515,6 +515,28 @@ static void gen_set_fpr_d(DisasContext *ctx, int reg_num, TCGv_i64 t)
     }
 }
 
+/* x1 (ra) and x5 (t0) hold return addresses by convention. */
+static bool is_link_reg(int reg)
+{
+    return reg == 1 || reg == 5;
+}
+
+/*
+ * True if the TB flags still describe the cpu state, i.e. no FS or VS
+ * field has been marked dirty since the start of the TB.
+ */
+static bool tb_flags_unchanged(DisasContext *ctx)
+{
+    uint32_t tb_flags = ctx->base.tb->flags;
+
+    return ctx->mstatus_fs == (tb_flags & TB_FLAGS_MSTATUS_FS) &&
+           ctx->mstatus_vs == (tb_flags & TB_FLAGS_MSTATUS_VS) &&
+           ctx->mstatus_hs_fs ==
+               FIELD_EX32(tb_flags, TB_FLAGS, MSTATUS_HS_FS) &&
+           ctx->mstatus_hs_vs ==
+               FIELD_EX32(tb_flags, TB_FLAGS, MSTATUS_HS_VS);
+}
+
 static void gen_jal(DisasContext *ctx, int rd, target_ulong imm)
 {
     target_ulong next_pc;
@@ -529,6 +551,9 @@ static void gen_jal(DisasContext *ctx, int rd, target_ulong imm)
     }
 
     gen_set_gpri(ctx, rd, ctx->pc_succ_insn);
+    if (is_link_reg(rd)) {
+        translator_ras_push(&ctx->base, ctx->pc_succ_insn);
+    }
     gen_goto_tb(ctx, 0, ctx->base.pc_next + imm); /* must use this for safety */
     ctx->base.is_jmp = DISAS_NORETURN;
 }
@@ -46,11 +46,32 @@ typedef struct TempOptInfo {
     uint64_t s_mask;  /* a left-aligned mask of clrsb(value) bits. */
 } TempOptInfo;
 
+/*
+ * Fields of the CPU state that are not TCG globals are accessed with
+ * explicit ld/st against cpu_env.  Remember, per slot, which temp still
+ * holds the value in memory and which store to it nothing has observed
+ * yet, so that reloads can be forwarded and overwritten stores dropped.
+ */
+#define MAX_ENV_SLOTS 16
+
+typedef struct EnvSlot {
+    intptr_t ofs;
+    int size;
+    TCGOpcode ld_opc;   /* load that reproduces VAL, or NB_OPS */
+    TCGTemp *val;       /* temp holding the slot contents, or NULL */
+    TCGOp *store;       /* last store to the slot, if still unobserved */
+} EnvSlot;
+
 typedef struct OptContext {
     TCGContext *tcg;
     TCGOp *prev_mb;
     TCGTempSet temps_used;
 
+    /* Known contents of CPU state slots. */
+    TCGTemp *env;
+    EnvSlot env_slots[MAX_ENV_SLOTS];
+    int nb_env_slots;
+
     /* In flight values from optimization. */
     uint64_t a_mask;  /* mask bit is 0 iff value identical to first input */
     uint64_t z_mask;  /* mask bit is 0 iff value bit is 0 */
@@ -1229,6 +1250,9 @@ static bool fold_call(OptContext *ctx, TCGOp *op)
 
     /* Stop optimizing MB across calls. */
     ctx->prev_mb = NULL;
+
+    /* Helpers may read or write any part of the CPU state. */
+    ctx->nb_env_slots = 0;
     return true;
 }
 
@@ -2022,12 +2046,244 @@ static bool fold_xor(OptContext *ctx, TCGOp *op)
     return fold_masks(ctx, op);
 }
 
+static void env_slot_remove(OptContext *ctx, int i)
+{
+    ctx->env_slots[i] = ctx->env_slots[--ctx->nb_env_slots];
+}
+
+static void env_slots_commit(OptContext *ctx)
+{
+    for (int i = 0; i < ctx->nb_env_slots; i++) {
+        ctx->env_slots[i].store = NULL;
+    }
+}
+
+/* TS is being overwritten and no longer mirrors any slot. */
+static void env_slots_forget_val(OptContext *ctx, TCGTemp *ts)
+{
+    for (int i = ctx->nb_env_slots - 1; i >= 0; i--) {
+        EnvSlot *e = &ctx->env_slots[i];
+
+        if (e->val == ts) {
+            e->val = NULL;
+            if (!e->store) {
+                env_slot_remove(ctx, i);
+            }
+        }
+    }
+}
+
+/*
+ * At the end of a basic block the stores become visible to the branch
+ * target, and normal temps die.  Values held in other temps are still
+ * valid on the fall-through path.
+ */
+static void env_slots_end_bb(OptContext *ctx)
+{
+    env_slots_commit(ctx);
+    for (int i = ctx->nb_env_slots - 1; i >= 0; i--) {
+        EnvSlot *e = &ctx->env_slots[i];
+
+        if (!e->val || e->val->kind == TEMP_NORMAL) {
+            env_slot_remove(ctx, i);
+        }
+    }
+}
+
+static void env_slot_add(OptContext *ctx, intptr_t ofs, int size,
+                         TCGOpcode ld_opc, TCGTemp *val, TCGOp *store)
+{
+    EnvSlot *e;
+
+    if (ctx->nb_env_slots == MAX_ENV_SLOTS) {
+        /* Forgetting a slot only loses an optimization opportunity. */
+        env_slot_remove(ctx, 0);
+    }
+    e = &ctx->env_slots[ctx->nb_env_slots++];
+    e->ofs = ofs;
+    e->size = size;
+    e->ld_opc = ld_opc;
+    e->val = val;
+    e->store = store;
+}
+
+static bool env_slots_overlap(EnvSlot *e, intptr_t ofs, int size)
+{
+    return e->ofs < ofs + size && ofs < e->ofs + e->size;
+}
+
+/*
+ * Return the size of the host memory access performed by OPC, or 0 if
+ * it is not an integer load or store.  For stores, *LD_OPC is set to
+ * the load that reads back the stored temp unchanged, if any.
+ */
+static int env_access_size(TCGOpcode opc, bool *is_store, TCGOpcode *ld_opc)
+{
+    *is_store = false;
+    *ld_opc = opc;
+
+    switch (opc) {
+    CASE_OP_32_64(ld8s):
+    CASE_OP_32_64(ld8u):
+        return 1;
+    CASE_OP_32_64(ld16s):
+    CASE_OP_32_64(ld16u):
+        return 2;
+    case INDEX_op_ld32s_i64:
+    case INDEX_op_ld32u_i64:
+    case INDEX_op_ld_i32:
+        return 4;
+    case INDEX_op_ld_i64:
+        return 8;
+    default:
+        break;
+    }
+
+    *is_store = true;
+    *ld_opc = NB_OPS;
+
+    switch (opc) {
+    CASE_OP_32_64(st8):
+        return 1;
+    CASE_OP_32_64(st16):
+        return 2;
+    case INDEX_op_st32_i64:
+        return 4;
+    case INDEX_op_st_i32:
+        *ld_opc = INDEX_op_ld_i32;
+        return 4;
+    case INDEX_op_st_i64:
+        *ld_opc = INDEX_op_ld_i64;
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static bool fold_env_ld(OptContext *ctx, TCGOp *op, intptr_t ofs, int size)
+{
+    for (int i = 0; i < ctx->nb_env_slots; i++) {
+        EnvSlot *e = &ctx->env_slots[i];
+
+        if (e->ofs == ofs && e->ld_opc == op->opc && e->val) {
+            init_ts_info(ctx, e->val);
+            return tcg_opt_gen_mov(ctx, op, op->args[0], temp_arg(e->val));
+        }
+    }
+
+    /* The load observes any store it overlaps. */
+    for (int i = 0; i < ctx->nb_env_slots; i++) {
+        if (env_slots_overlap(&ctx->env_slots[i], ofs, size)) {
+            ctx->env_slots[i].store = NULL;
+        }
+    }
+    env_slot_add(ctx, ofs, size, op->opc, arg_temp(op->args[0]), NULL);
+    return false;
+}
+
+static bool fold_env_st(OptContext *ctx, TCGOp *op, intptr_t ofs, int size,
+                        TCGOpcode ld_opc)
+{
+    TCGTemp *val = arg_temp(op->args[0]);
+
+    for (int i = ctx->nb_env_slots - 1; i >= 0; i--) {
+        EnvSlot *e = &ctx->env_slots[i];
+
+        if (!env_slots_overlap(e, ofs, size)) {
+            continue;
+        }
+        if (e->ofs == ofs && e->size == size) {
+            /* Storing back what the slot already holds. */
+            if (e->val) {
+                init_ts_info(ctx, e->val);
+            }
+            if (e->val && ts_are_copies(e->val, val)) {
+                tcg_op_remove(ctx->tcg, op);
+                return true;
+            }
+            /* Overwriting a store that nothing has read. */
+            if (e->store) {
+                tcg_op_remove(ctx->tcg, e->store);
+            }
+        }
+        env_slot_remove(ctx, i);
+    }
+    env_slot_add(ctx, ofs, size, ld_opc,
+                 ld_opc == NB_OPS ? NULL : val, op);
+    return false;
+}
+
+/*
+ * Forward loads from, and remove redundant stores to, the CPU state at
+ * fixed offsets from cpu_env.  Known values survive conditional branches
+ * for as long as the temps holding them live, i.e. across the whole
+ * extended basic block for globals and local temps.
+ */
+static bool fold_env_access(OptContext *ctx, TCGOp *op, const TCGOpDef *def)
+{
+    TCGOpcode ld_opc;
+    bool is_store;
+    int i, size;
+
+    for (i = 0; i < def->nb_oargs && ctx->nb_env_slots; i++) {
+        env_slots_forget_val(ctx, arg_temp(op->args[i]));
+    }
+
+    if (def->flags & TCG_OPF_BB_END) {
+        if (op->opc == INDEX_op_set_label) {
+            ctx->nb_env_slots = 0;
+        } else {
+            env_slots_end_bb(ctx);
+        }
+        return false;
+    }
+    if (def->flags & TCG_OPF_SIDE_EFFECTS) {
+        /*
+         * Guest memory accesses may fault, or reach device models
+         * that read or modify the CPU state.
+         */
+        ctx->nb_env_slots = 0;
+        return false;
+    }
+
+    size = env_access_size(op->opc, &is_store, &ld_opc);
+    if (size == 0) {
+        switch (op->opc) {
+        case INDEX_op_ld_vec:
+        case INDEX_op_dupm_vec:
+            env_slots_commit(ctx);
+            break;
+        case INDEX_op_st_vec:
+            ctx->nb_env_slots = 0;
+            break;
+        default:
+            break;
+        }
+        return false;
+    }
+
+    /* Any other pointer may point into the CPU state. */
+    if (arg_temp(op->args[1]) != ctx->env) {
+        if (is_store) {
+            ctx->nb_env_slots = 0;
+        } else {
+            env_slots_commit(ctx);
+        }
+        return false;
+    }
+
+    if (is_store) {
+        return fold_env_st(ctx, op, op->args[2], size, ld_opc);
+    }
+    return fold_env_ld(ctx, op, op->args[2], size);
+}
+
 /* Propagate constants and copies, fold constant expressions. */
 void tcg_optimize(TCGContext *s)
 {
     int nb_temps, i;
     TCGOp *op, *op_next;
-    OptContext ctx = { .tcg = s };
+    OptContext ctx = { .tcg = s, .env = tcgv_ptr_temp(cpu_env) };
 
     /* Array VALS has an element for each temp.
        If this temp holds a constant then its value is kept in VALS' element.
@@ -2068,6 +2324,10 @@ void tcg_optimize(TCGContext *s)
         ctx.z_mask = -1;
         ctx.s_mask = 0;
 
+        if (fold_env_access(&ctx, op, def)) {
+            continue;
+        }
+
         /*
          * Process each opcode.
          * Sorted alphabetically by opcode as much as possible.
@@ -28,6 +28,7 @@
 #include "qemu/mprotect.h"
 #include "qemu/memalign.h"
 #include "qemu/cacheinfo.h"
+#include "qemu/bitmap.h"
 #include "qapi/error.h"
 #include "exec/exec-all.h"
 #include "tcg/tcg.h"
@@ -60,6 +61,13 @@ struct tcg_region_state {
     /* fields protected by the lock */
     size_t current; /* current region index */
     size_t agg_size_full; /* aggregate size of full regions */
+    uint64_t *alloc_gen; /* when each region was last handed out, 0 if never */
+    uint64_t next_gen;
+    unsigned long *free; /* evicted regions, ready to be handed out again */
+    size_t nb_free;
+    size_t nb_evicting; /* regions between evict_begin and evict_end */
+    uint64_t reset_count; /* bumped by tcg_region_reset_all */
+    bool evict_wanted; /* no region left to hand out; read locklessly */
 };
 
 static struct tcg_region_state region;
@@ -333,13 +341,30 @@ static void tcg_region_assign(TCGContext *s, size_t curr_region)
     s->code_gen_highwater = end - TCG_HIGHWATER;
 }
 
+static void tcg_region_update_evict_wanted__locked(void)
+{
+    bool wanted = region.n > 1 && region.current == region.n &&
+                  region.nb_free == 0 && region.nb_evicting == 0;
+
+    qatomic_set(&region.evict_wanted, wanted);
+}
+
 static bool tcg_region_alloc__locked(TCGContext *s)
 {
-    if (region.current == region.n) {
+    size_t i;
+
+    if (region.current < region.n) {
+        i = region.current++;
+    } else if (region.nb_free) {
+        i = find_first_bit(region.free, region.n);
+        clear_bit(i, region.free);
+        region.nb_free--;
+    } else {
         return true;
     }
-    tcg_region_assign(s, region.current);
-    region.current++;
+    tcg_region_assign(s, i);
+    region.alloc_gen[i] = ++region.next_gen;
+    tcg_region_update_evict_wanted__locked();
     return false;
 }
 
@@ -388,6 +413,12 @@ void tcg_region_reset_all(void)
     qemu_mutex_lock(&region.lock);
     region.current = 0;
     region.agg_size_full = 0;
+    region.next_gen = 0;
+    region.nb_free = 0;
+    region.nb_evicting = 0;
+    region.reset_count++;
+    memset(region.alloc_gen, 0, region.n * sizeof(region.alloc_gen[0]));
+    bitmap_zero(region.free, region.n);
 
     for (i = 0; i < n_ctxs; i++) {
         TCGContext *s = qatomic_read(&tcg_ctxs[i]);
@@ -398,6 +429,132 @@ void tcg_region_reset_all(void)
     tcg_region_tree_reset_all();
 }
 
+/*
+ * Region-granular eviction.  Once every region has been handed out, the
+ * one that was handed out longest ago and is no longer being filled by
+ * any context can be retired on its own: its TBs are invalidated while
+ * the other vCPUs keep running and, once no vCPU can still be executing
+ * them, the region is reset and handed out again by tcg_region_alloc.
+ */
+
+/* Lockless hint: true when the next region allocation would fail. */
+bool tcg_region_evict_wanted(void)
+{
+    return qatomic_read(&region.evict_wanted);
+}
+
+static bool tcg_region_in_use__locked(size_t i)
+{
+    unsigned int n_ctxs = qatomic_read(&tcg_cur_ctxs);
+    void *start, *end;
+    unsigned int j;
+
+    tcg_region_bounds(i, &start, &end);
+    for (j = 0; j < n_ctxs; j++) {
+        const TCGContext *s = qatomic_read(&tcg_ctxs[j]);
+
+        if (s->code_gen_buffer == start) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Pick the oldest full region and mark it as being evicted.  Returns
+ * its index, or -1 if no region can be evicted.  @reset_count must be
+ * handed back to tcg_region_evict_end().
+ */
+ssize_t tcg_region_evict_begin(uint64_t *reset_count)
+{
+    ssize_t victim = -1;
+    size_t i;
+
+    qemu_mutex_lock(&region.lock);
+    for (i = 0; i < region.n; i++) {
+        if (region.alloc_gen[i] == 0 || test_bit(i, region.free) ||
+            tcg_region_in_use__locked(i)) {
+            continue;
+        }
+        if (victim < 0 || region.alloc_gen[i] < region.alloc_gen[victim]) {
+            victim = i;
+        }
+    }
+    if (victim >= 0) {
+        /* zero alloc_gen keeps the region out of further victim searches */
+        region.alloc_gen[victim] = 0;
+        region.nb_evicting++;
+        *reset_count = region.reset_count;
+        tcg_region_update_evict_wanted__locked();
+    } else {
+        /* Nothing to evict until another region fills up. */
+        qatomic_set(&region.evict_wanted, false);
+    }
+    qemu_mutex_unlock(&region.lock);
+    return victim;
+}
+
+static gboolean tcg_region_collect_tb(gpointer key, gpointer value,
+                                      gpointer data)
+{
+    g_ptr_array_add(data, value);
+    return false;
+}
+
+/* Returns the TBs whose host code lies in region @i. */
+GPtrArray *tcg_region_tbs(size_t i)
+{
+    struct tcg_region_tree *rt = region_trees + i * tree_size;
+    GPtrArray *tbs = g_ptr_array_new();
+
+    qemu_mutex_lock(&rt->lock);
+    g_tree_foreach(rt->tree, tcg_region_collect_tb, tbs);
+    qemu_mutex_unlock(&rt->lock);
+    return tbs;
+}
+
+/* Returns the bounds of region @i as seen by the executing host. */
+void tcg_region_range(size_t i, const void **pstart, const void **pend)
+{
+    void *start, *end;
+
+    tcg_region_bounds(i, &start, &end);
+    *pstart = tcg_splitwx_to_rx(start);
+    *pend = tcg_splitwx_to_rx(end);
+}
+
+/*
+ * Make region @i available again.  The caller must ensure that none of
+ * its TBs can be reached or be running any more.  Returns false if the
+ * whole buffer was reset in the meantime, in which case the region has
+ * already been recycled.
+ */
+bool tcg_region_evict_end(size_t i, uint64_t reset_count)
+{
+    struct tcg_region_tree *rt = region_trees + i * tree_size;
+    void *start, *end;
+
+    qemu_mutex_lock(&region.lock);
+    if (region.reset_count != reset_count) {
+        qemu_mutex_unlock(&region.lock);
+        return false;
+    }
+
+    qemu_mutex_lock(&rt->lock);
+    g_tree_ref(rt->tree);
+    g_tree_destroy(rt->tree);
+    qemu_mutex_unlock(&rt->lock);
+
+    tcg_region_bounds(i, &start, &end);
+    region.agg_size_full -= end - start - TCG_HIGHWATER;
+    region.nb_evicting--;
+    set_bit(i, region.free);
+    region.nb_free++;
+    tcg_region_update_evict_wanted__locked();
+    qemu_mutex_unlock(&region.lock);
+    return true;
+}
+
 static size_t tcg_n_regions(size_t tb_size, unsigned max_cpus)
 {
 #ifdef CONFIG_USER_ONLY
@@ -786,6 +943,8 @@ void tcg_region_init(size_t tb_size, int splitwx, unsigned max_cpus)
 
     /* init the region struct */
     qemu_mutex_init(&region.lock);
+    region.alloc_gen = g_new0(uint64_t, region.n);
+    region.free = bitmap_new(region.n);
 
     /*
      * Set guard pages in the rw buffer, as that's the one into which
@@ -4230,7 +4230,10 @@ int tcg_gen_code(TCGContext *s, TranslationBlock *tb)
 #endif
 
 #ifdef USE_TCG_OPTIMIZATIONS
-    tcg_optimize(s);
+    /* Quick TBs are optimized if they turn out to be worth it. */
+    if (!(tb_cflags(tb) & CF_QUICK)) {
+        tcg_optimize(s);
+    }
 #endif
 
 #ifdef CONFIG_PROFILER
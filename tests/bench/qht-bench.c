@@ -43,6 +43,10 @@ static QemuThread *rw_threads;
 #define DEFAULT_RANGE (4096)
 #define DEFAULT_QHT_N_ELEMS DEFAULT_RANGE
 
+/* -G: many threads inserting into an initially empty, growing table */
+#define GROW_N_THREADS 128
+#define GROW_RANGE (1 << 20)
+
 static unsigned int duration = 1;
 static unsigned int n_rw_threads = 1;
 static unsigned long lookup_range = DEFAULT_RANGE;
@@ -91,9 +95,13 @@ static const char commands_string[] =
     " -u = update rate (0.0 to 100.0), 50/50 split of insertions/removals\n"
     "\n"
     " -R = enable auto-resize\n"
+    " -I = enable incremental auto-resize (implies -R)\n"
     " -S = resize rate (0.0 to 100.0)\n"
     " -D = delay (in us) between potential resizes\n"
-    " -N = number of resize threads";
+    " -N = number of resize threads\n"
+    "\n"
+    " -G = grow from empty: 128 threads, 50% updates over 1M keys, -R set;\n"
+    "      options given after -G override it. Compare with -G -I";
 
 static void usage_complete(int argc, char *argv[])
 {
@@ -275,7 +283,9 @@ static void pr_params(void)
     printf(" initial # of keys: %zu\n", init_size);
     printf(" initial size hint: %zu\n", qht_n_elems);
     printf(" auto-resize:       %s\n",
-           qht_mode & QHT_MODE_AUTO_RESIZE ? "on" : "off");
+           qht_mode & QHT_MODE_AUTO_RESIZE ?
+           (qht_mode & QHT_MODE_INCREMENTAL_RESIZE ? "incremental" : "on") :
+           "off");
     if (resize_rate) {
         printf(" resize_rate:       %f%%\n", resize_rate * 100.0);
         printf(" resize range:      %zu-%zu\n", resize_min, resize_max);
@@ -445,7 +455,7 @@ static void parse_args(int argc, char *argv[])
     int c;
 
     for (;;) {
-        c = getopt(argc, argv, "d:D:g:k:K:l:hn:N:o:pr:Rs:S:u:");
+        c = getopt(argc, argv, "d:D:g:GIk:K:l:hn:N:o:pr:Rs:S:u:");
         if (c < 0) {
             break;
         }
@@ -463,6 +473,16 @@ static void parse_args(int argc, char *argv[])
             qht_n_elems = atol(optarg);
             init_size = atol(optarg);
             break;
+        case 'G':
+            n_rw_threads = GROW_N_THREADS;
+            init_range = GROW_RANGE;
+            lookup_range = GROW_RANGE;
+            update_range = GROW_RANGE;
+            qht_n_elems = 0;
+            init_size = 0;
+            update_rate = 0.5;
+            qht_mode |= QHT_MODE_AUTO_RESIZE;
+            break;
         case 'h':
             usage_complete(argc, argv);
             exit(0);
@@ -488,6 +508,9 @@ static void parse_args(int argc, char *argv[])
             precompute_hash = true;
             hfunc = hval;
             break;
+        case 'I':
+            qht_mode |= QHT_MODE_AUTO_RESIZE | QHT_MODE_INCREMENTAL_RESIZE;
+            break;
         case 'r':
             update_range = pow2ceil(atol(optarg));
             break;
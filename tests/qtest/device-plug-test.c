@@ -14,6 +14,7 @@
 #include "libqos/libqtest.h"
 #include "qapi/qmp/qdict.h"
 #include "qapi/qmp/qstring.h"
+#include "hw/pci/pci_regs.h"
 
 static void device_del(QTestState *qtest, const char *id)
 {
@@ -165,6 +166,79 @@ static void test_spapr_phb_unplug_request(void)
     qtest_quit(qtest);
 }
 
+#define HOTPLUG_BENCH_DEVICES   500
+#define HOTPLUG_BENCH_BRIDGES   16
+#define HOTPLUG_BENCH_MMIO_BASE 0xc0000000u
+
+static void pci_config_writew(QTestState *qtest, int bus, int devfn,
+                              uint8_t offset, uint16_t val)
+{
+    qtest_outl(qtest, 0xcf8,
+               (1U << 31) | (bus << 16) | (devfn << 8) | (offset & ~3));
+    qtest_outw(qtest, 0xcfc + (offset & 3), val);
+}
+
+static void pci_config_writel(QTestState *qtest, int bus, int devfn,
+                              uint8_t offset, uint32_t val)
+{
+    qtest_outl(qtest, 0xcf8, (1U << 31) | (bus << 16) | (devfn << 8) | offset);
+    qtest_outl(qtest, 0xcfc, val);
+}
+
+/*
+ * Hot-plug HOTPLUG_BENCH_DEVICES PCI devices behind a set of bridges and
+ * map the memory BAR of each one, the way firmware would.  Every BAR
+ * mapping is a memory transaction, so this measures how the cost of
+ * updating the memory topology grows with the number of devices.
+ */
+static void test_pci_hotplug_bench(void)
+{
+    GString *cmd = g_string_new("-machine pc -nodefaults");
+    QTestState *qtest;
+    double elapsed;
+    int i;
+
+    for (i = 0; i < HOTPLUG_BENCH_BRIDGES; i++) {
+        g_string_append_printf(cmd, " -device pci-bridge,id=br%d,bus=pci.0,"
+                               "addr=0x%x,chassis_nr=%d,shpc=off",
+                               i, 0x10 + i, i + 1);
+    }
+    qtest = qtest_init(cmd->str);
+    g_string_free(cmd, true);
+
+    /* Bus numbers and a 1 MiB memory window for each bridge. */
+    for (i = 0; i < HOTPLUG_BENCH_BRIDGES; i++) {
+        int devfn = (0x10 + i) << 3;
+        uint16_t window = (HOTPLUG_BENCH_MMIO_BASE >> 16) + (i << 4);
+
+        pci_config_writel(qtest, 0, devfn, PCI_PRIMARY_BUS,
+                          (i + 1) << 16 | (i + 1) << 8);
+        pci_config_writew(qtest, 0, devfn, PCI_MEMORY_BASE, window);
+        pci_config_writew(qtest, 0, devfn, PCI_MEMORY_LIMIT, window);
+        pci_config_writew(qtest, 0, devfn, PCI_COMMAND, PCI_COMMAND_MEMORY);
+    }
+
+    g_test_timer_start();
+    for (i = 0; i < HOTPLUG_BENCH_DEVICES; i++) {
+        int bridge = i / 32, slot = i % 32;
+        g_autofree char *id = g_strdup_printf("dev%d", i);
+
+        qtest_qmp_device_add(qtest, "pci-testdev", id,
+                             "{'bus': 'br%d', 'addr': '0x%x'}", bridge, slot);
+        pci_config_writel(qtest, bridge + 1, slot << 3, PCI_BASE_ADDRESS_0,
+                          HOTPLUG_BENCH_MMIO_BASE + (bridge << 20) +
+                          slot * 0x1000);
+        pci_config_writew(qtest, bridge + 1, slot << 3, PCI_COMMAND,
+                          PCI_COMMAND_MEMORY);
+    }
+    elapsed = g_test_timer_elapsed();
+
+    g_test_minimized_result(elapsed, "%d devices plugged and mapped in %.3f s",
+                            HOTPLUG_BENCH_DEVICES, elapsed);
+
+    qtest_quit(qtest);
+}
+
 int main(int argc, char **argv)
 {
     const char *arch = qtest_get_arch();
@@ -181,6 +255,12 @@ int main(int argc, char **argv)
     qtest_add_func("/device-plug/pci-unplug-json-request",
                    test_pci_unplug_json_request);
 
+    if (g_test_perf() &&
+        (!strcmp(arch, "i386") || !strcmp(arch, "x86_64"))) {
+        qtest_add_func("/device-plug/pci-hotplug-bench",
+                       test_pci_hotplug_bench);
+    }
+
     if (!strcmp(arch, "s390x")) {
         qtest_add_func("/device-plug/ccw-unplug",
                        test_ccw_unplug);
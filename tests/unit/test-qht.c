@@ -251,10 +251,16 @@ static void test_resize(void)
     qht_test(QHT_MODE_AUTO_RESIZE);
 }
 
+static void test_resize_incremental(void)
+{
+    qht_test(QHT_MODE_AUTO_RESIZE | QHT_MODE_INCREMENTAL_RESIZE);
+}
+
 int main(int argc, char *argv[])
 {
     g_test_init(&argc, &argv, NULL);
     g_test_add_func("/qht/mode/default", test_default);
     g_test_add_func("/qht/mode/resize", test_resize);
+    g_test_add_func("/qht/mode/resize-incremental", test_resize_incremental);
     return g_test_run();
 }